@@ -2,17 +2,18 @@
 
 // graphic data
 attribute lowp vec4 colorAttr;
-attribute lowp vec2 textureAttr;
-attribute highp vec4 vertexAttr;
-attribute lowp float countAttr;
-attribute lowp float selectedAttr;
-attribute lowp float visibleAttr;
+attribute highp vec2 vertexAttr;
+attribute highp float countAttr;
+// the flags of the spot (1 visible + 2 selected)
+attribute lowp float flagsAttr;
 
 // model_view * projection matrix
 uniform mediump mat4 in_ModelViewProjectionMatrix;
 
+// size of the spots in pixels
+uniform highp float in_pointSize;
+
 // passed along to fragment shader
-varying highp vec2 outTextCoord;
 varying lowp vec4 outColor;
 varying lowp float outSelected;
 varying lowp float outShape;
@@ -26,6 +27,28 @@ uniform lowp int in_pooledLower;
 uniform lowp int in_shape;
 uniform lowp float in_intensity;
 
+// GPU filtering mode, the value, color and visibility of the spot are
+// computed from the features in the textures instead of the attributes
+uniform bool in_gpuFiltering;
+// the first feature, the number of features, the total reads and the total
+// genes of the spot
+attribute highp vec4 filterAttr;
+// the count and gene of the features (sorted by spot) and two texels per gene
+// (the color and the cut-off with the alpha set if the gene is selected)
+uniform sampler2D in_countsTexture;
+uniform sampler2D in_genesTexture;
+uniform sampler2D in_statesTexture;
+uniform highp float in_textureWidth;
+uniform highp float in_featuresRows;
+uniform highp float in_statesRows;
+// the thresholds (lower, upper)
+uniform highp vec2 in_readsThreshold;
+uniform highp vec2 in_genesThreshold;
+uniform highp vec2 in_totalReadsThreshold;
+uniform bool in_genesCutoff;
+// the color of a spot before it is blended with the colors of its genes
+uniform lowp vec4 in_defaultColor;
+
 //Some in-house functions
 float norm(inout float v, in float t0, in float t1)
 {
@@ -95,16 +118,72 @@ vec4 createHeatMapColor(inout float value)
     return vec4(red, green, blue, 1.0);
 }
 
+// returns the texel at index of a texture with in_textureWidth columns
+vec4 fetchTexel(in sampler2D samplerTexture, in float rows, in float index)
+{
+    float row = floor(index / in_textureWidth);
+    float column = index - row * in_textureWidth;
+    vec2 coordinates = vec2((column + 0.5) / in_textureWidth, (row + 0.5) / rows);
+    return texture2DLod(samplerTexture, coordinates, 0.0);
+}
+
+// returns the integer stored in the RGB components of the texel (24 bits)
+float texelValue(in vec4 texel)
+{
+    return dot(floor(texel.rgb * 255.0 + 0.5), vec3(1.0, 256.0, 65536.0));
+}
+
+bool outsideThreshold(in float value, in vec2 threshold)
+{
+    return value < threshold.x || value > threshold.y;
+}
+
+// computes the value and color of the spot from its features applying the
+// thresholds (the same as DataRenderer does in the CPU), the spot is visible
+// if any of its features is inside the thresholds
+// (only used in the normal visual mode, the pooled modes are computed in the CPU)
+bool filterSpot(inout vec4 color, inout float value)
+{
+    if (outsideThreshold(filterAttr.w, in_genesThreshold)
+        || outsideThreshold(filterAttr.z, in_totalReadsThreshold)) {
+        return false;
+    }
+    color = in_defaultColor;
+    float reads = 0.0;
+    float genes = 0.0;
+    float last = filterAttr.x + filterAttr.y;
+    for (float feature = filterAttr.x; feature < last; feature += 1.0) {
+        float count = texelValue(fetchTexel(in_countsTexture, in_featuresRows, feature));
+        float gene = texelValue(fetchTexel(in_genesTexture, in_featuresRows, feature));
+        vec4 state = fetchTexel(in_statesTexture, in_statesRows, gene * 2.0 + 1.0);
+        if (outsideThreshold(count, in_readsThreshold)
+            || (in_genesCutoff && count < texelValue(state)) || state.a < 0.5) {
+            continue;
+        }
+        reads += count;
+        genes += 1.0;
+        // linear interpolation adjusted by the number of genes
+        color = mix(color, fetchTexel(in_statesTexture, in_statesRows, gene * 2.0), 1.0 / genes);
+    }
+    value = reads;
+    return genes > 0.0;
+}
+
 void main(void)
 {
     outColor = colorAttr;
-    outTextCoord = textureAttr;
     // This is ugly but the fragment shader does not accept other than float
-    outSelected = selectedAttr;
+    outSelected = step(2.0, flagsAttr);
+    bool visible = mod(flagsAttr, 2.0) >= 1.0;
     outShape = float(in_shape);
     
     // Get the value attribute and limits (Reads, genes or TPM)
     float value = countAttr;
+    if (in_gpuFiltering) {
+        visible = filterSpot(outColor, value);
+        // the selection flag of the spots is computed in the CPU
+        outSelected = visible ? outSelected : 0.0;
+    }
     float upper_limit = float(in_pooledUpper);
     float lower_limit = float(in_pooledLower);
     
@@ -119,7 +198,7 @@ void main(void)
         lower_limit = sqrt(lower_limit);
     }
     
-    if (bool(visibleAttr)) {
+    if (visible) {
         // Visual modes (1 normal - 2 dynamic range - 3 heatmap)
         outColor.a = in_intensity;
         if (in_visualMode == 2) { //dynamic range mode
@@ -134,5 +213,7 @@ void main(void)
         outColor = vec4(0.0, 0.0, 0.0, 0.0);
     }
     
-    gl_Position = in_ModelViewProjectionMatrix * vertexAttr;
+    // each spot is a point sprite of the size of the spot
+    gl_PointSize = in_pointSize;
+    gl_Position = in_ModelViewProjectionMatrix * vec4(vertexAttr, 0.0, 1.0);
 }
@@ -149,43 +149,57 @@ void AnalysisDEA::computeGeneToReads(const UserSelection &selObjectA,
     m_lowerThreshold = std::numeric_limits<int>::max();
     m_upperThreshold = std::numeric_limits<int>::min();
 
-    // get the list of aggregated genes from both selections
-    const auto &selA = selObjectA.getGeneCounts();
-    const auto &selB = selObjectB.getGeneCounts();
-
     // take into account that some genes might be present in only one selection
-    // therefore, we create a hash table (key gene name - value a pair with counts in selection A
+    // therefore, we create a table (key gene - value a pair with counts in selection A
     // and counts in selection B) to later know what genes are present in which set
-    // depending of the value of the hash (0.0 no present)
-    auto it1 = selA.begin();
-    auto it2 = selB.begin();
-    QHash<QString, deaReads> tempMap;
-    while (it1 != selA.end() || it2 != selB.end()) {
-
-        if (it1 != selA.end()) {
-            const auto gene_name = it1->first;
-            const auto gene_counts = it1->second;
-            tempMap[gene_name].gene = gene_name;
-            tempMap[gene_name].readsA = gene_counts;
-            m_upperThreshold = std::max(gene_counts, m_upperThreshold);
-            m_lowerThreshold = std::min(gene_counts, m_lowerThreshold);
-            ++it1;
+    // depending of the value of the table (0.0 no present)
+    // when both selections share the same gene ids (selections of the same
+    // dataset) the table is a plain array indexed by gene id
+    auto updateThresholds = [this](const int gene_counts) {
+        m_upperThreshold = std::max(gene_counts, m_upperThreshold);
+        m_lowerThreshold = std::min(gene_counts, m_lowerThreshold);
+    };
+    m_combinedSelections.clear();
+    const FeatureStore featuresA = selObjectA.selectedFeatures();
+    const FeatureStore featuresB = selObjectB.selectedFeatures();
+    if (featuresA.sameGenes(featuresB)) {
+        // the aggregated gene counts from both selections (-1 not present)
+        const QVector<int> countsA = selObjectA.getGeneCountsById();
+        const QVector<int> countsB = selObjectB.getGeneCountsById();
+        for (int i = 0; i < countsA.size(); ++i) {
+            if (countsA.at(i) == -1 && countsB.at(i) == -1) {
+                continue;
+            }
+            deaReads reads;
+            reads.gene = featuresA.geneName(static_cast<quint32>(i));
+            if (countsA.at(i) != -1) {
+                reads.readsA = countsA.at(i);
+                updateThresholds(reads.readsA);
+            }
+            if (countsB.at(i) != -1) {
+                reads.readsB = countsB.at(i);
+                updateThresholds(reads.readsB);
+            }
+            m_combinedSelections.push_back(reads);
         }
-
-        if (it2 != selB.end()) {
-            const auto gene_name = it2->first;
-            const auto gene_counts = it2->second;
-            tempMap[gene_name].gene = gene_name;
-            tempMap[gene_name].readsB = gene_counts;
-            m_upperThreshold = std::max(gene_counts, m_upperThreshold);
-            m_lowerThreshold = std::min(gene_counts, m_lowerThreshold);
-            ++it2;
+    } else {
+        // the gene ids are not comparable, the genes are matched by name
+        const auto &selA = selObjectA.getGeneCounts();
+        const auto &selB = selObjectB.getGeneCounts();
+        QHash<QString, deaReads> tempMap;
+        for (const auto &gene_count : selA) {
+            tempMap[gene_count.first].gene = gene_count.first;
+            tempMap[gene_count.first].readsA = gene_count.second;
+            updateThresholds(gene_count.second);
         }
+        for (const auto &gene_count : selB) {
+            tempMap[gene_count.first].gene = gene_count.first;
+            tempMap[gene_count.first].readsB = gene_count.second;
+            updateThresholds(gene_count.second);
+        }
+        m_combinedSelections = tempMap.values();
     }
 
-    // clear the container and fill it with the deaReads objects
-    m_combinedSelections = tempMap.values();
-
     // update table model for genes
     selectionsModel()->loadCombinedSelectedGenes(m_combinedSelections);
 }
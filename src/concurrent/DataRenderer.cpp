@@ -1,40 +1,168 @@
 #include "DataRenderer.h"
 
-/*DataRenderer::DataRenderer()
+#include <QtConcurrent>
+#include <QThread>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "dataModel/Gene.h"
+#include "math/Common.h"
+
+// updates with fewer spots than this are computed in the calling thread
+static const int MIN_BLOCK_SPOTS = 2048;
+// number of blocks per core (smaller blocks balance the load better as the
+// spots have different number of features)
+static const int BLOCKS_PER_CORE = 4;
+// the color of a spot before it is blended with the colors of its genes
+static const float DEFAULT_COLOR[4] = {static_cast<float>(Visual::DEFAULT_COLOR_GENE.redF()),
+                                       static_cast<float>(Visual::DEFAULT_COLOR_GENE.greenF()),
+                                       static_cast<float>(Visual::DEFAULT_COLOR_GENE.blueF()),
+                                       static_cast<float>(Visual::DEFAULT_COLOR_GENE.alphaF())};
+
+namespace
 {
 
+void renderBlock(DataRenderer &block)
+{
+    block.run();
 }
 
-DataRenderer::run()
+// linear interpolation of the colors (c0 = c0 + (c1 - c0) * t), the
+// components are independent so the loop is vectorized
+inline void blendColor(float *c0, const float *c1, const float t)
 {
+    for (int i = 0; i < 4; ++i) {
+        c0[i] += (c1[i] - c0[i]) * t;
+    }
+}
 
-    // temp local variables to store the genes/reads/tpm/color of each feature
-    QColor indexColor = Globals::DEFAULT_COLOR_GENE;
-    int indexValue = 0;
-    int indexValueGenes = 0;
+inline int toColorComponent(const float value)
+{
+    return static_cast<int>(value * 255.0f + 0.5f);
+}
+}
 
-    // iterate the features to compute rendering data for an specific index (position)
-    GeneRendererGL::GeneInfoByIndexMap::const_iterator it = m_geneInfoByIndex.constFind(index);
-    GeneRendererGL::GeneInfoByIndexMap::const_iterator end = m_geneInfoByIndex.constEnd();
-    for (; it != end && it.key() == index; ++it) {
-        DataProxy::FeaturePtr feature = it.value();
-        Q_ASSERT(feature);
+DataRenderer::DataRenderer(const Input &input,
+                           const QVector<int> &indexes,
+                           QVector<SpotData> &spotsData,
+                           const int begin,
+                           const int end)
+    : m_input(&input)
+    , m_indexes(&indexes)
+    , m_spotsData(spotsData.data())
+    , m_begin(begin)
+    , m_end(end)
+    , m_pooledMin(std::numeric_limits<int>::max())
+    , m_pooledMax(std::numeric_limits<int>::min())
+{
+}
 
-        const int currentHits = feature->count();
-        // check if the reads are outside the threshold
-        if (featureReadsOutsideRange(currentHits)) {
-            continue;
-        }
+void DataRenderer::render(const Input &input,
+                          const QVector<int> &indexes,
+                          QVector<SpotData> &spotsData,
+                          int &pooledMin,
+                          int &pooledMax)
+{
+    // the data is written in place by the blocks (resize() keeps the capacity)
+    spotsData.resize(indexes.size());
 
-        // if we want to enforce the selection we add the feature to the container
-        if (m_forceSelection) {
-            m_geneInfoSelectedFeatures.append(feature);
-        }
+    const int maxBlocks = QThread::idealThreadCount() * BLOCKS_PER_CORE;
+    const int numBlocks = std::max(1, std::min(maxBlocks, indexes.size() / MIN_BLOCK_SPOTS));
+    std::vector<DataRenderer> blocks;
+    blocks.reserve(numBlocks);
+    for (int i = 0; i < numBlocks; ++i) {
+        const int begin = static_cast<int>((static_cast<qint64>(indexes.size()) * i) / numBlocks);
+        const int end
+            = static_cast<int>((static_cast<qint64>(indexes.size()) * (i + 1)) / numBlocks);
+        blocks.emplace_back(input, indexes, spotsData, begin, end);
+    }
+
+    if (numBlocks == 1) {
+        blocks.front().run();
+    } else {
+        QtConcurrent::blockingMap(blocks, renderBlock);
+    }
+
+    // reduce the min-max of the blocks
+    pooledMin = std::numeric_limits<int>::max();
+    pooledMax = std::numeric_limits<int>::min();
+    for (const DataRenderer &block : blocks) {
+        pooledMin = std::min(block.pooledMin(), pooledMin);
+        pooledMax = std::max(block.pooledMax(), pooledMax);
+    }
+}
 
-        // we check if gene is selected here because we want to select all the genes
-        // in the feature when we are forcing selection
-        const auto gene = feature->geneObject();
-        if (!gene->selected()) {
+DataRenderer::GeneState DataRenderer::geneState(const Gene &gene)
+{
+    const QColor color = gene.color();
+    GeneState state;
+    state.color[0] = static_cast<float>(color.redF());
+    state.color[1] = static_cast<float>(color.greenF());
+    state.color[2] = static_cast<float>(color.blueF());
+    state.color[3] = static_cast<float>(color.alphaF());
+    state.cutoff = gene.cut_off();
+    state.selected = gene.selected();
+    return state;
+}
+
+void DataRenderer::run()
+{
+    for (int i = m_begin; i < m_end; ++i) {
+        renderSpot(m_indexes->at(i), m_spotsData[i]);
+    }
+}
+
+int DataRenderer::pooledMin() const
+{
+    return m_pooledMin;
+}
+
+int DataRenderer::pooledMax() const
+{
+    return m_pooledMax;
+}
+
+void DataRenderer::renderSpot(const int index, SpotData &spotData)
+{
+    const Settings &settings = m_input->settings;
+
+    // check if spot's total reads/genes are inside the total reads/genes thresholds
+    const int total_reads_feature = m_input->totalReads->at(index);
+    const int total_genes_feature = m_input->totalGenes->at(index);
+    if (total_genes_feature < settings.genesLower || total_genes_feature > settings.genesUpper
+        || total_reads_feature < settings.totalReadsLower
+        || total_reads_feature > settings.totalReadsUpper) {
+        spotData.outside = true;
+        spotData.visible = false;
+        return;
+    }
+
+    // the features columns and the features of each spot
+    const FeatureStore &features = *m_input->features;
+    const QVector<int> &spotOffsets = features.spotOffsets();
+    const QVector<int> &spotFeatures = features.spotFeatures();
+    const QVector<quint32> &geneIds = features.geneIds();
+    const QVector<int> &counts = features.counts();
+
+    // temp local variables to store the color of the spot
+    float indexColor[4] = {DEFAULT_COLOR[0], DEFAULT_COLOR[1], DEFAULT_COLOR[2], DEFAULT_COLOR[3]};
+    int indexValue = 0;
+    int indexValueGenes = 0;
+
+    // iterate the genes in the spot to compute rendering data for an specific index (spot)
+    const GeneState *geneStates = m_input->geneStates->constData();
+    for (int i = spotOffsets.at(index); i < spotOffsets.at(index + 1); ++i) {
+        const int feature = spotFeatures.at(i);
+        // get the feature's gene
+        const GeneState &gene = geneStates[geneIds.at(feature)];
+
+        // check if the reads count of the gene in this spot are outside the threshold
+        // or the gene is not selected
+        const int currentHits = counts.at(feature);
+        if (currentHits < settings.readsLower || currentHits > settings.readsUpper
+            || (settings.genesCutoff && currentHits < gene.cutoff) || !gene.selected) {
             continue;
         }
 
@@ -42,35 +170,31 @@ DataRenderer::run()
         indexValue += currentHits;
         ++indexValueGenes;
 
-        // when the color of the new feature is different than the color
-        // in the feature's index we do linear interpolation adjusted
-        // by the number of genes in the feature to obtain the new color
-        const QColor &featureColor = gene->color();
-        if (indexColor != featureColor) {
-            const qreal adjustment = 1.0 / indexValueGenes;
-            indexColor = Math::lerp(adjustment, indexColor, featureColor);
-        }
+        // we do linear interpolation adjusted by the number of genes
+        // in the feature to obtain the new color
+        blendColor(indexColor, gene.color, 1.0f / indexValueGenes);
     }
 
-    // we only show features where there is at least one gene activated
-    const bool visible = indexValueGenes != 0;
+    // we only show indexes where there is at least one gene-feature activated
+    const bool visible = indexValueGenes > 0;
 
     // update pooled min-max to compute colors if applies
-    if (isPooled && visible) {
-        if (pooling_genes) {
+    if (settings.pooled && visible) {
+        if (settings.poolingMode == Visual::PoolNumberGenes) {
             indexValue = indexValueGenes;
-        } else if (pooling_tpm) {
+        } else if (settings.poolingMode == Visual::PoolTPMs) {
             indexValue = Math::tpmNormalization<int>(indexValue, total_reads_feature);
         }
         // only update the boundaries for color computation in pooled mode
-        m_localPooledMin = std::min(indexValue, m_localPooledMin);
-        m_localPooledMax = std::max(indexValue, m_localPooledMax);
+        m_pooledMin = std::min(indexValue, m_pooledMin);
+        m_pooledMax = std::max(indexValue, m_pooledMax);
     }
 
-    // update rendering data arrays
-    m_geneData.updateQuadReads(index, indexValue);
-    m_geneData.updateQuadSelected(index, visible && forceSelection);
-    m_geneData.updateQuadVisible(index, visible);
-    m_geneData.updateQuadColor(index, indexColor);
+    spotData.outside = false;
+    spotData.visible = visible;
+    spotData.value = indexValue;
+    spotData.color = qRgba(toColorComponent(indexColor[0]),
+                           toColorComponent(indexColor[1]),
+                           toColorComponent(indexColor[2]),
+                           toColorComponent(indexColor[3]));
 }
-*/
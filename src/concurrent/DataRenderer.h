@@ -1,40 +1,104 @@
-/*
 #ifndef DATARENDERER_H
 #define DATARENDERER_H
 
+#include <QColor>
+#include <QVector>
 
-#include <QRunnable>
-#include "viewOpenGL/GeneRendererGL.h"
+#include "dataModel/FeatureStore.h"
+#include "SettingsVisual.h"
 
-class GeneData;
+class Gene;
 
-class DataRenderer : public QRunnable
+// DataRenderer computes the rendering data (value, color and visibility) of
+// the spots of the GeneRendererGL. The spots are partitioned in blocks which
+// are computed concurrently (see render()), the blocks only read the features
+// and the genes states and each one writes the data of its spots and its
+// pooled min-max in its own slots so no locking is needed. The caller reduces
+// the min-max and writes the data to the rendering arrays.
+// The state of the genes is read from a flat table indexed by gene id (a copy
+// of the attributes of the Gene objects) and the colors are blended as floats
+class DataRenderer
 {
 
-    DataRenderer(const int total_genes_feature,
-                 const int total_reads_feature,
-                 const bool forceSelection,
-                 GeneRendererGL::GeneInfoByIndexMap &geneInfoByIndex,
-                 GeneRendererGL::GeneInfoSelectedFeatures
-&geneInfoSelectedFeatures,
-                 int &localPooledMin,
-                 int &localPooledMax,
-                 GeneData &geneData,
-                 void (*featureReadsOusideRange)(int,int)
-                 );
+public:
+    // the thresholds and visual options of an update
+    struct Settings {
+        int readsLower;
+        int readsUpper;
+        int genesLower;
+        int genesUpper;
+        int totalReadsLower;
+        int totalReadsUpper;
+        // hide the features below the cut-off of their gene
+        bool genesCutoff;
+        // compute the pooled min-max (dynamic range and heat map modes)
+        bool pooled;
+        Visual::GenePooledMode poolingMode;
+    };
 
-private:
+    // the attributes of a gene used to render the spots
+    struct GeneState {
+        // RGBA color (components in [0, 1])
+        float color[4];
+        int cutoff;
+        bool selected;
+    };
+
+    // the rendering data of a spot
+    struct SpotData {
+        // the spot is outside the total reads/genes thresholds (the value
+        // and color are not computed)
+        bool outside;
+        bool visible;
+        int value;
+        QRgb color;
+    };
+
+    // the input data of an update (total reads/genes are indexed by spot and
+    // the genes states by gene id)
+    struct Input {
+        const FeatureStore *features;
+        const QVector<GeneState> *geneStates;
+        const QVector<int> *totalReads;
+        const QVector<int> *totalGenes;
+        Settings settings;
+    };
+
+    // computes the rendering data of the spots, spotsData[i] is the data of
+    // indexes[i]. Big updates are computed in blocks in the global thread pool
+    // the pooled min-max of the visible spots are returned (if pooled)
+    static void render(const Input &input,
+                       const QVector<int> &indexes,
+                       QVector<SpotData> &spotsData,
+                       int &pooledMin,
+                       int &pooledMax);
+
+    // the state of the gene
+    static GeneState geneState(const Gene &gene);
+
+    // computes the spots [begin, end) of indexes
+    DataRenderer(const Input &input,
+                 const QVector<int> &indexes,
+                 QVector<SpotData> &spotsData,
+                 const int begin,
+                 const int end);
 
     void run();
 
-    const int m_total_genes_feature;
-    const int m_total_reads_feature;
-    const bool m_forceSelection;
-    GeneRendererGL::GeneInfoByIndexMap &m_geneInfoByIndex;
-    GeneRendererGL::GeneInfoSelectedFeatures &m_geneInfoSelectedFeatures;
-    int &m_localPooledMin;
-    int &m_localPooledMax;
-    GeneData &m_geneData;
-    void (*featureReadsOusideRange)(int,int);
+    int pooledMin() const;
+    int pooledMax() const;
+
+private:
+    // computes the rendering data of the spot
+    void renderSpot(const int index, SpotData &spotData);
+
+    const Input *m_input;
+    const QVector<int> *m_indexes;
+    SpotData *m_spotsData;
+    int m_begin;
+    int m_end;
+    int m_pooledMin;
+    int m_pooledMax;
 };
-*/
+
+#endif // DATARENDERER_H
@@ -0,0 +1,384 @@
+#include "data/BinaryDataset.h"
+
+#include <QDebug>
+#include <QVector>
+
+#include "data/FeaturesParser.h"
+
+#include <cstring>
+#include <limits>
+
+namespace
+{
+
+// format identifiers
+static const char MAGIC[4] = {'S', 'T', 'B', 'D'};
+static const quint32 BYTE_ORDER_MARK = 0x01020304;
+static const quint32 VERSION = 1;
+
+// sections of the file in the order they are stored
+enum Section {
+    NamesOffsetsSection = 0,
+    NamesSection,
+    SpotsXSection,
+    SpotsYSection,
+    SpotsOffsetsSection,
+    GenesIndexesSection,
+    CountsSection,
+    SectionsCount
+};
+
+// fixed size header at the beginning of the file
+struct FileHeader {
+    char magic[4];
+    quint32 byteOrder;
+    quint32 version;
+    quint32 genes;
+    quint32 spots;
+    quint32 counts;
+    // x1, y1, x2, y2
+    qint32 chip[4];
+    // m11 m12 m13 m21 m22 m23 m31 m32 m33
+    double alignment[9];
+    // offsets of the sections from the beginning of the file
+    quint64 sections[SectionsCount];
+    // size in bytes of the gene names section
+    quint64 namesSize;
+};
+
+static_assert(sizeof(FileHeader) == 176, "The binary dataset header must not have padding");
+
+// sections start at 8 bytes boundaries
+inline quint64 alignSection(const quint64 offset)
+{
+    return (offset + 7) & ~static_cast<quint64>(7);
+}
+
+// sizes in bytes of the sections for the given header
+void sectionSizes(const FileHeader &header, quint64 sizes[SectionsCount])
+{
+    sizes[NamesOffsetsSection] = (static_cast<quint64>(header.genes) + 1) * sizeof(quint32);
+    sizes[NamesSection] = header.namesSize;
+    sizes[SpotsXSection] = static_cast<quint64>(header.spots) * sizeof(float);
+    sizes[SpotsYSection] = static_cast<quint64>(header.spots) * sizeof(float);
+    sizes[SpotsOffsetsSection] = (static_cast<quint64>(header.spots) + 1) * sizeof(quint32);
+    sizes[GenesIndexesSection] = static_cast<quint64>(header.counts) * sizeof(quint32);
+    sizes[CountsSection] = static_cast<quint64>(header.counts) * sizeof(quint32);
+}
+
+// true if the offsets start at 0, do not decrease and end at last
+bool validOffsets(const quint32 *offsets, const int size, const quint32 last)
+{
+    if (offsets[0] != 0 || offsets[size] != last) {
+        return false;
+    }
+    for (int i = 0; i < size; ++i) {
+        if (offsets[i] > offsets[i + 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+}
+
+BinaryDataset::BinaryDataset()
+    : m_file()
+    , m_data(nullptr)
+    , m_size(0)
+    , m_genes(0)
+    , m_spots(0)
+    , m_counts(0)
+    , m_namesOffsets(nullptr)
+    , m_names(nullptr)
+    , m_spotsX(nullptr)
+    , m_spotsY(nullptr)
+    , m_spotsOffsets(nullptr)
+    , m_genesIndexes(nullptr)
+    , m_countsValues(nullptr)
+    , m_chip()
+    , m_alignment()
+{
+}
+
+BinaryDataset::~BinaryDataset()
+{
+    close();
+}
+
+bool BinaryDataset::open(const QString &filename)
+{
+    close();
+    m_file.setFileName(filename);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Error opening binary dataset" << filename;
+        return false;
+    }
+    m_size = m_file.size();
+    m_data = m_file.map(0, m_size);
+    if (m_data == nullptr || !load()) {
+        qDebug() << "Error mapping binary dataset" << filename;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void BinaryDataset::close()
+{
+    if (m_data != nullptr) {
+        m_file.unmap(m_data);
+    }
+    m_file.close();
+    m_data = nullptr;
+    m_size = 0;
+    m_genes = 0;
+    m_spots = 0;
+    m_counts = 0;
+    m_namesOffsets = nullptr;
+    m_names = nullptr;
+    m_spotsX = nullptr;
+    m_spotsY = nullptr;
+    m_spotsOffsets = nullptr;
+    m_genesIndexes = nullptr;
+    m_countsValues = nullptr;
+    m_chip = QRect();
+    m_alignment = QTransform();
+}
+
+bool BinaryDataset::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+bool BinaryDataset::load()
+{
+    FileHeader header;
+    if (m_size < static_cast<qint64>(sizeof(FileHeader))) {
+        return false;
+    }
+    std::memcpy(&header, m_data, sizeof(FileHeader));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+        || header.byteOrder != BYTE_ORDER_MARK || header.version != VERSION) {
+        return false;
+    }
+    const quint32 max_int = static_cast<quint32>(std::numeric_limits<int>::max());
+    if (header.genes >= max_int || header.spots >= max_int || header.counts >= max_int
+        || header.namesSize >= max_int) {
+        return false;
+    }
+
+    // every section must be aligned and inside the file
+    quint64 sizes[SectionsCount];
+    sectionSizes(header, sizes);
+    const quint64 file_size = static_cast<quint64>(m_size);
+    for (int i = 0; i < SectionsCount; ++i) {
+        const quint64 offset = header.sections[i];
+        if (offset % 8 != 0 || offset > file_size || sizes[i] > file_size - offset) {
+            return false;
+        }
+    }
+
+    m_genes = static_cast<int>(header.genes);
+    m_spots = static_cast<int>(header.spots);
+    m_counts = static_cast<int>(header.counts);
+    m_namesOffsets
+        = reinterpret_cast<const quint32 *>(m_data + header.sections[NamesOffsetsSection]);
+    m_names = reinterpret_cast<const char *>(m_data + header.sections[NamesSection]);
+    m_spotsX = reinterpret_cast<const float *>(m_data + header.sections[SpotsXSection]);
+    m_spotsY = reinterpret_cast<const float *>(m_data + header.sections[SpotsYSection]);
+    m_spotsOffsets
+        = reinterpret_cast<const quint32 *>(m_data + header.sections[SpotsOffsetsSection]);
+    m_genesIndexes
+        = reinterpret_cast<const quint32 *>(m_data + header.sections[GenesIndexesSection]);
+    m_countsValues = reinterpret_cast<const quint32 *>(m_data + header.sections[CountsSection]);
+
+    // the offsets and indexes are used to access the columns so they are
+    // validated once here
+    if (!validOffsets(m_namesOffsets, m_genes, static_cast<quint32>(header.namesSize))
+        || !validOffsets(m_spotsOffsets, m_spots, header.counts)) {
+        return false;
+    }
+    for (int i = 0; i < m_counts; ++i) {
+        if (m_genesIndexes[i] >= header.genes) {
+            return false;
+        }
+    }
+
+    m_chip = QRect(QPoint(header.chip[0], header.chip[1]), QPoint(header.chip[2], header.chip[3]));
+    const double *a = header.alignment;
+    m_alignment = QTransform(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8]);
+    return true;
+}
+
+int BinaryDataset::genesCount() const
+{
+    return m_genes;
+}
+
+int BinaryDataset::spotsCount() const
+{
+    return m_spots;
+}
+
+int BinaryDataset::countsCount() const
+{
+    return m_counts;
+}
+
+const QString BinaryDataset::geneName(const int index) const
+{
+    Q_ASSERT(index >= 0 && index < m_genes);
+    const quint32 begin = m_namesOffsets[index];
+    const quint32 end = m_namesOffsets[index + 1];
+    return QString::fromUtf8(m_names + begin, static_cast<int>(end - begin));
+}
+
+const float *BinaryDataset::spotsX() const
+{
+    return m_spotsX;
+}
+
+const float *BinaryDataset::spotsY() const
+{
+    return m_spotsY;
+}
+
+const quint32 *BinaryDataset::spotsOffsets() const
+{
+    return m_spotsOffsets;
+}
+
+const quint32 *BinaryDataset::genesIndexes() const
+{
+    return m_genesIndexes;
+}
+
+const quint32 *BinaryDataset::counts() const
+{
+    return m_countsValues;
+}
+
+const QRect BinaryDataset::chipDimensions() const
+{
+    return m_chip;
+}
+
+const QTransform BinaryDataset::alignmentMatrix() const
+{
+    return m_alignment;
+}
+
+bool BinaryDataset::isBinaryFile(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray magic = file.read(sizeof(MAGIC));
+    return magic == QByteArray(MAGIC, sizeof(MAGIC));
+}
+
+bool BinaryDataset::write(const QString &filename,
+                          const FeatureStore &features,
+                          const QRect &chip,
+                          const QTransform &alignment)
+{
+    // the genes and spots of the store are already indexed in order of appearance
+    QByteArray names;
+    QVector<quint32> namesOffsets(1, 0);
+    for (const QString &name : features.geneNames()) {
+        names.append(name.toUtf8());
+        namesOffsets.push_back(static_cast<quint32>(names.size()));
+    }
+    const QVector<float> &spotsX = features.spotsX();
+    const QVector<float> &spotsY = features.spotsY();
+
+    // CSR matrix of spots x genes
+    QVector<quint32> spotsOffsets(spotsX.size() + 1, 0);
+    for (const quint32 spot : features.spotIds()) {
+        ++spotsOffsets[static_cast<int>(spot) + 1];
+    }
+    for (int i = 0; i < spotsX.size(); ++i) {
+        spotsOffsets[i + 1] += spotsOffsets[i];
+    }
+    QVector<quint32> next(spotsOffsets);
+    QVector<quint32> genesIndexes(features.size());
+    QVector<quint32> counts(features.size());
+    for (int i = 0; i < features.size(); ++i) {
+        const quint32 pos = next[static_cast<int>(features.spotIds().at(i))]++;
+        genesIndexes[static_cast<int>(pos)] = features.geneIds().at(i);
+        counts[static_cast<int>(pos)] = static_cast<quint32>(qMax(0, features.counts().at(i)));
+    }
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(FileHeader));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.version = VERSION;
+    header.genes = static_cast<quint32>(namesOffsets.size() - 1);
+    header.spots = static_cast<quint32>(spotsX.size());
+    header.counts = static_cast<quint32>(features.size());
+    header.chip[0] = chip.topLeft().x();
+    header.chip[1] = chip.topLeft().y();
+    header.chip[2] = chip.bottomRight().x();
+    header.chip[3] = chip.bottomRight().y();
+    const double matrix[9] = {alignment.m11(),
+                              alignment.m12(),
+                              alignment.m13(),
+                              alignment.m21(),
+                              alignment.m22(),
+                              alignment.m23(),
+                              alignment.m31(),
+                              alignment.m32(),
+                              alignment.m33()};
+    std::memcpy(header.alignment, matrix, sizeof(matrix));
+    header.namesSize = static_cast<quint64>(names.size());
+
+    const char *sections[SectionsCount]
+        = {reinterpret_cast<const char *>(namesOffsets.constData()),
+           names.constData(),
+           reinterpret_cast<const char *>(spotsX.constData()),
+           reinterpret_cast<const char *>(spotsY.constData()),
+           reinterpret_cast<const char *>(spotsOffsets.constData()),
+           reinterpret_cast<const char *>(genesIndexes.constData()),
+           reinterpret_cast<const char *>(counts.constData())};
+    quint64 sizes[SectionsCount];
+    sectionSizes(header, sizes);
+    quint64 offset = sizeof(FileHeader);
+    for (int i = 0; i < SectionsCount; ++i) {
+        offset = alignSection(offset);
+        header.sections[i] = offset;
+        offset += sizes[i];
+    }
+
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Error creating binary dataset" << filename;
+        return false;
+    }
+    bool writtenOk
+        = file.write(reinterpret_cast<const char *>(&header), sizeof(FileHeader))
+          == static_cast<qint64>(sizeof(FileHeader));
+    const QByteArray padding(8, '\0');
+    for (int i = 0; i < SectionsCount && writtenOk; ++i) {
+        const qint64 padding_size = static_cast<qint64>(header.sections[i]) - file.pos();
+        writtenOk = file.write(padding.constData(), padding_size) == padding_size
+                    && file.write(sections[i], static_cast<qint64>(sizes[i]))
+                           == static_cast<qint64>(sizes[i]);
+    }
+    file.close();
+    return writtenOk;
+}
+
+bool BinaryDataset::convert(const QByteArray &rawData,
+                            const QString &filename,
+                            const QRect &chip,
+                            const QTransform &alignment)
+{
+    FeatureStore features;
+    if (!data::parseFeaturesParallel(rawData, features)) {
+        qDebug() << "Error parsing the features to convert";
+        return false;
+    }
+    return write(filename, features, chip, alignment);
+}
@@ -0,0 +1,98 @@
+#ifndef BINARYDATASET_H
+#define BINARYDATASET_H
+
+#include <QFile>
+#include <QRect>
+#include <QString>
+#include <QTransform>
+
+#include "dataModel/FeatureStore.h"
+
+// BinaryDataset gives access to a dataset stored in the ST binary format
+// (.stb files). The file is memory mapped and the columns are accessed
+// directly from the mapped memory (no parsing and no copies) which makes
+// opening a local dataset much faster than parsing the JSON features.
+//
+// The format (version 1, native byte order) contains a fixed size header
+// followed by 8 bytes aligned sections:
+// - header: magic, byte order mark, version, number of genes, spots and
+//   counts, chip bounds and the alignment matrix (row major)
+// - gene dictionary: offsets (genes + 1) into a blob of UTF-8 gene names
+// - spots: x and y coordinates (one column each)
+// - counts: CSR matrix spots x genes (row offsets (spots + 1), gene indexes
+//   and counts)
+class BinaryDataset
+{
+
+public:
+    BinaryDataset();
+    ~BinaryDataset();
+
+    // maps the file and validates its content
+    // returns false if the file could not be mapped or it is not valid
+    bool open(const QString &filename);
+    // unmaps the file (the columns are not valid anymore)
+    void close();
+    bool isOpen() const;
+
+    int genesCount() const;
+    int spotsCount() const;
+    int countsCount() const;
+
+    // name of the gene at index (a copy is made from the UTF-8 dictionary)
+    const QString geneName(const int index) const;
+
+    // columns (valid while the file is open)
+    const float *spotsX() const;
+    const float *spotsY() const;
+    // CSR matrix, the counts of spot i are in [spotsOffsets()[i], spotsOffsets()[i + 1])
+    const quint32 *spotsOffsets() const;
+    const quint32 *genesIndexes() const;
+    const quint32 *counts() const;
+
+    const QRect chipDimensions() const;
+    const QTransform alignmentMatrix() const;
+
+    // true if the file starts with the ST binary format magic
+    static bool isBinaryFile(const QString &filename);
+
+    // writes the features in binary format (the genes and spots are stored
+    // in the order of their ids)
+    // returns true if the file was written correctly
+    static bool write(const QString &filename,
+                      const FeatureStore &features,
+                      const QRect &chip,
+                      const QTransform &alignment);
+
+    // converts a JSON features file (the same format accepted by the
+    // DatasetImporter) to binary format
+    // returns true if the features were parsed and written correctly
+    static bool convert(const QByteArray &rawData,
+                        const QString &filename,
+                        const QRect &chip,
+                        const QTransform &alignment);
+
+private:
+    // validates the mapped content and sets the columns
+    bool load();
+
+    QFile m_file;
+    uchar *m_data;
+    qint64 m_size;
+    int m_genes;
+    int m_spots;
+    int m_counts;
+    const quint32 *m_namesOffsets;
+    const char *m_names;
+    const float *m_spotsX;
+    const float *m_spotsY;
+    const quint32 *m_spotsOffsets;
+    const quint32 *m_genesIndexes;
+    const quint32 *m_countsValues;
+    QRect m_chip;
+    QTransform m_alignment;
+
+    Q_DISABLE_COPY(BinaryDataset)
+};
+
+#endif // BINARYDATASET_H
@@ -11,6 +11,12 @@
 #include <QApplication>
 #include <QDesktopWidget>
 #include <QUuid>
+#include <QtConcurrent>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFileInfo>
+
+#include <algorithm>
 
 #include "config/Configuration.h"
 #include "network/NetworkManager.h"
@@ -21,9 +27,11 @@
 
 // parse objects
 #include "data/ObjectParser.h"
+#include "data/FeaturesParser.h"
+#include "data/BinaryDataset.h"
+#include "data/DatasetSnapshot.h"
 #include "dataModel/ChipDTO.h"
 #include "dataModel/DatasetDTO.h"
-#include "dataModel/FeatureDTO.h"
 #include "dataModel/ImageAlignmentDTO.h"
 #include "dataModel/UserDTO.h"
 #include "dataModel/UserSelectionDTO.h"
@@ -37,126 +45,27 @@
 #include "dataModel/ImageAlignment.h"
 #include "dataModel/User.h"
 #include "dataModel/Gene.h"
-#include "rapidjson/reader.h"
-#include "rapidjson/filereadstream.h"
-#include "rapidjson/error/en.h"
-
-#include <iostream>
-#include <sstream>
-
-using namespace rapidjson;
-
-// Handler with call backs for rapidjson
-// explicitly made to parse the Features JSON type object
-// references to the containers are passed and will be filled up
-// with the parsed objects
-// TODO move to a separate file
-struct FeaturesHandler {
-
-public:
-    FeaturesHandler(DataProxy::FeatureList &featureList,
-                    DataProxy::GeneNameToObject &geneNameToGene)
-        : featuresList(featureList)
-        , geneNameToGene(geneNameToGene)
-    {
-    }
-
-    bool Null() { return false; }
-    bool Bool(bool) { return false; }
-
-    bool Int(int i)
-    {
-        varMap.insert(currentKey, i);
-        return true;
-    }
-
-    bool Uint(int u)
-    {
-        varMap.insert(currentKey, u);
-        return true;
-    }
-
-    bool Int64(int64_t i)
-    {
-        varMap.insert(currentKey, static_cast<qlonglong>(i));
-        return true;
-    }
-
-    bool Uint64(uint64_t u)
-    {
-        varMap.insert(currentKey, static_cast<qulonglong>(u));
-        return true;
-    }
-
-    bool Double(double d)
-    {
-        varMap.insert(currentKey, d);
-        return true;
-    }
-
-    bool RawNumber(const char *, SizeType, bool) { return true; }
-
-    bool String(const char *str, SizeType length, bool)
-    {
-        Q_UNUSED(length);
-        varMap.insert(currentKey, QString(str));
-        return true;
-    }
-
-    bool StartObject()
-    {
-        varMap.clear();
-        currentKey.clear();
-        return true;
-    }
-
-    bool Key(const char *str, SizeType length, bool)
-    {
-        Q_UNUSED(length);
-        currentKey = QString(str);
-        return true;
-    }
-
-    bool EndObject(SizeType)
-    {
-        // create feature object from variant map
-        FeatureDTO dto;
-        data::parseObject(varMap, &dto);
-        auto feature = std::make_shared<Feature>(dto.feature());
-        Q_ASSERT(feature);
-
-        // get the gene name
-        const QString gene_name = feature->gene();
-        Q_ASSERT(!gene_name.isNull() && !gene_name.isEmpty());
-
-        // create unique gene object
-        if (!geneNameToGene.contains(gene_name)) {
-            geneNameToGene.insert(gene_name, std::make_shared<Gene>(Gene(gene_name)));
-        }
 
-        // update containers
-        featuresList.push_back(feature);
-
-        return true;
-    }
-
-    bool StartArray() { return true; }
-    bool EndArray(SizeType) { return true; }
-
-private:
-    DataProxy::FeatureList &featuresList;
-    DataProxy::GeneNameToObject &geneNameToGene;
-    QString currentKey;
-    QVariantMap varMap;
-};
+// interval (ms) to report the progress of the features parsing
+static const int FEATURES_PROGRESS_INTERVAL = 100;
+// default maximum memory (bytes) used by the datasets cache
+static const qint64 DATASET_CACHE_BUDGET = Q_INT64_C(1024) * 1024 * 1024;
 
 DataProxy::DataProxy(QObject *parent)
     : QObject(parent)
     , m_user(nullptr)
     , m_networkManager(nullptr)
+    , m_datasetCache(DATASET_CACHE_BUDGET)
+    , m_datasetSnapshot(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                        + QDir::separator() + "snapshots")
 {
     m_networkManager.reset(new NetworkManager(this));
     Q_ASSERT(!m_networkManager.isNull());
+
+    // the progress of the features parsing is polled periodically
+    m_featuresProgressTimer.setInterval(FEATURES_PROGRESS_INTERVAL);
+    connect(&m_featuresProgressTimer, SIGNAL(timeout()), this, SLOT(slotFeaturesProgress()));
+    connect(&m_featuresWatcher, SIGNAL(finished()), this, SLOT(slotFeaturesParsed()));
 }
 
 DataProxy::~DataProxy()
@@ -167,17 +76,20 @@ DataProxy::~DataProxy()
 void DataProxy::clean()
 {
     qDebug() << "Cleaning memory cache in Dataproxy";
+    cancelFeaturesLoading();
     // every data member is a smart pointer
     m_datasetList.clear();
     m_userSelectionList.clear();
     m_imageAlignment.reset();
     m_chip.reset();
-    m_featuresList.clear();
+    m_features.clear();
     m_cellTissueImages.clear();
     m_minVersion = MinVersionArray();
     m_accessToken = OAuth2TokenDTO();
     m_user.reset();
     m_geneNameToObject.clear();
+    m_genesById.clear();
+    m_datasetCache.clear();
 }
 
 void DataProxy::cleanAll()
@@ -185,6 +97,7 @@ void DataProxy::cleanAll()
     qDebug() << "Cleaning memory cache and disk cache in Dataproxy";
     clean();
     m_networkManager->cleanCache();
+    m_datasetSnapshot.clear();
 }
 
 const DataProxy::DatasetList &DataProxy::getDatasetList() const
@@ -206,7 +119,7 @@ const DataProxy::DatasetPtr DataProxy::getDatasetById(const QString &datasetId)
 
 const DataProxy::GeneList DataProxy::getGeneList() const
 {
-    return m_geneNameToObject.values();
+    return m_genesById;
 }
 
 DataProxy::GenePtr DataProxy::geneGeneObject(const QString &gene_name) const
@@ -214,9 +127,16 @@ DataProxy::GenePtr DataProxy::geneGeneObject(const QString &gene_name) const
     return m_geneNameToObject.value(gene_name);
 }
 
-const DataProxy::FeatureList &DataProxy::getFeatureList() const
+DataProxy::GenePtr DataProxy::getGene(const quint32 geneId) const
 {
-    return m_featuresList;
+    return geneId < static_cast<quint32>(m_genesById.size())
+               ? m_genesById.at(static_cast<int>(geneId))
+               : nullptr;
+}
+
+const FeatureStore &DataProxy::getFeatureStore() const
+{
+    return m_features;
 }
 
 const DataProxy::UserPtr DataProxy::getUser() const
@@ -340,40 +260,101 @@ bool DataProxy::loadDatasetContent(const DatasetPtr dataset)
         return false;
     }
 
-    // load image alignment
+    // the content of a recently opened dataset is taken from the cache
+    DatasetContent content;
+    if (m_datasetCache.find(dataset->id(), dataset->lastModified(), content)) {
+        qDebug() << "Dataset content found in the cache " << dataset->id();
+        setDatasetContent(content);
+        return true;
+    }
+
+    // only the images of the current dataset are kept
+    m_cellTissueImages.clear();
+
+    // the image alignment gives the chip and the images of the dataset so it
+    // must be loaded first
     const bool image_alignment = loadImageAlignment(dataset->imageAlignmentId());
     if (!image_alignment || !m_imageAlignment) {
         qDebug() << "Error downloading image alignment...";
         return false;
     }
 
-    // load cell tissue figure one and two
-    const bool image_one = loadCellTissueByName(m_imageAlignment->figureBlue());
-    bool image_two = true;
-    if (image_one && m_user->hasSpecialRole()) {
-        // load cell tissue two (no need to download it for role USER)
-        image_two = loadCellTissueByName(m_imageAlignment->figureRed());
+    // the parsed features are read in the background from the snapshot of the
+    // dataset if it was opened before and it has not been modified since
+    bool has_snapshot = m_datasetSnapshot.contains(dataset->id(), dataset->lastModified());
+    if (has_snapshot) {
+        loadSnapshotAsync(dataset->id(), dataset->lastModified());
+    } else {
+        // the features, the cell tissue figures and the chip are downloaded
+        // concurrently (the features are parsed while they are downloaded)
+        loadFeaturesAsync(dataset->id());
+    }
+    // the features load can finish while the other requests are downloaded
+    const FeaturesLoadStatePtr featuresLoad = m_featuresState;
+    QList<QPair<QSharedPointer<NetworkReply>, DownloadType>> requests;
+    m_chip.reset();
+    const auto chipCmd
+        = RESTCommandFactory::getChipByChipId(m_configurationManager, m_imageAlignment->chipId());
+    requests.append(qMakePair(m_networkManager->httpRequest(chipCmd), ChipDownloaded));
+    QStringList figures(m_imageAlignment->figureBlue());
+    if (m_user->hasSpecialRole()) {
+        // cell tissue two (no need to download it for role USER)
+        figures.append(m_imageAlignment->figureRed());
+    }
+    for (const QString &figure : figures) {
+        const auto cmd
+            = RESTCommandFactory::getCellTissueFigureByName(m_configurationManager, figure);
+        auto reply = m_networkManager->httpRequest(cmd);
+        if (!reply.isNull()) {
+            // add figure name to reply metaproperty
+            reply->setProperty("figure_name", QVariant::fromValue<QString>(figure));
+        }
+        requests.append(qMakePair(reply, TissueImageDownloaded));
     }
 
-    if (!image_one || !image_two) {
-        qDebug() << "Error downloading images...";
+    QList<QSharedPointer<NetworkReply>> replies;
+    for (const auto &request : requests) {
+        replies.append(request.first);
+    }
+    bool content_ok = waitForReplies(replies);
+    for (int i = 0; i < requests.size() && content_ok; ++i) {
+        content_ok = parseRequest(requests.at(i).first, requests.at(i).second);
+    }
+    if (!content_ok) {
+        qDebug() << "Error downloading images or chip...";
+        cancelFeaturesLoading();
         return false;
     }
 
-    // load features
-    const bool features = loadFeatures(dataset->id());
+    bool features = waitForFeatures(featuresLoad);
+    if (!features && has_snapshot) {
+        // the snapshot could not be read so the features are downloaded
+        has_snapshot = false;
+        loadFeaturesAsync(dataset->id());
+        features = waitForFeatures(m_featuresState);
+    }
     if (!features) {
         qDebug() << "Error downloading st data features...";
         return false;
     }
-
-    // load chip
-    const bool chip = loadChip(m_imageAlignment->chipId());
-    if (!chip) {
-        qDebug() << "Error downloading chip...";
-        return false;
+    if (!has_snapshot) {
+        // the snapshot is written in the background (the features are shared)
+        QtConcurrent::run(&DatasetSnapshot::write,
+                          m_datasetSnapshot.fileName(dataset->id()),
+                          dataset->id(),
+                          dataset->lastModified(),
+                          m_features);
     }
 
+    content.features = m_features;
+    content.genes = m_genesById;
+    content.chip = m_chip;
+    content.imageAlignment = m_imageAlignment;
+    content.figureBlue = getFigureBlue();
+    content.figureRed = getFigureRed();
+    content.lastModified = dataset->lastModified();
+    m_datasetCache.insert(dataset->id(), content);
+
     return true;
 }
 
@@ -402,30 +383,115 @@ bool DataProxy::loadChip(const Chip &chip)
 }
 
 bool DataProxy::loadFeatures(const QString &datasetId)
+{
+    loadFeaturesAsync(datasetId);
+    return waitForFeatures(m_featuresState);
+}
+
+bool DataProxy::loadFeatures(const QByteArray &rawData)
+{
+    loadFeaturesAsync(rawData);
+    return waitForFeatures(m_featuresState);
+}
+
+bool DataProxy::loadFeatures(const BinaryDataset &dataset)
+{
+    if (!dataset.isOpen()) {
+        return false;
+    }
+    cancelFeaturesLoading();
+    // the index of a gene in the dictionary is its id (unless the
+    // dictionary has duplicated names)
+    FeatureStore features;
+    QVector<quint32> geneIds(dataset.genesCount());
+    for (int i = 0; i < dataset.genesCount(); ++i) {
+        geneIds[i] = features.addGene(dataset.geneName(i));
+    }
+    // the features are added spot by spot from the CSR columns
+    const float *x = dataset.spotsX();
+    const float *y = dataset.spotsY();
+    const quint32 *offsets = dataset.spotsOffsets();
+    const quint32 *indexes = dataset.genesIndexes();
+    const quint32 *counts = dataset.counts();
+    features.reserve(dataset.countsCount());
+    for (int spot = 0; spot < dataset.spotsCount(); ++spot) {
+        const quint32 spotId = features.addSpot(x[spot], y[spot]);
+        for (quint32 i = offsets[spot]; i < offsets[spot + 1]; ++i) {
+            features.addFeature(geneIds.at(static_cast<int>(indexes[i])),
+                                spotId,
+                                static_cast<int>(counts[i]));
+        }
+    }
+    features.buildIndexes();
+    features.computeGeneCutoffs();
+    setFeatures(features);
+    return true;
+}
+
+void DataProxy::loadFeaturesAsync(const QString &datasetId)
 {
     Q_ASSERT(!datasetId.isNull() && !datasetId.isEmpty());
-    // clear the containers
-    m_geneNameToObject.clear();
-    m_featuresList.clear();
+    // only one features load at the time
+    cancelFeaturesLoading();
+    m_featuresState.reset(new FeaturesLoadState());
+    m_featuresState->downloaded = true;
     // creates the request
     const auto cmd = RESTCommandFactory::getFeatureByDatasetId(m_configurationManager, datasetId);
-    auto reply = m_networkManager->httpRequest(cmd);
-    // create the download request (sync)
-    const bool status_download = createRequest(reply);
-    bool status_parsing = false;
-    if (status_download) {
-        status_parsing = parseRequest(reply, DataProxy::FeaturesDownloaded);
+    m_featuresReply = m_networkManager->httpRequest(cmd);
+    if (m_featuresReply.isNull()) {
+        checkReply(m_featuresReply);
+        finishFeaturesLoading(false);
+        return;
     }
-    // returns status
-    return status_download && status_parsing;
+    // the features are parsed while they are downloaded, the data received
+    // is passed to the parsing job through the stream
+    m_featuresState->stream.reset(new data::FeaturesStream());
+    m_featuresReply->setStreaming(true);
+    connect(m_featuresReply.data(),
+            SIGNAL(signalDataReceived(QByteArray)),
+            this,
+            SLOT(slotFeaturesDataReceived(QByteArray)));
+    connect(m_featuresReply.data(),
+            SIGNAL(signalFinished(QVariant)),
+            this,
+            SLOT(slotFeaturesDownloaded()));
+    startFeaturesParsing(QByteArray());
 }
 
-bool DataProxy::loadFeatures(const QByteArray &rawData)
+void DataProxy::loadFeaturesAsync(const QByteArray &rawData)
 {
-    // clear the containers
-    m_geneNameToObject.clear();
-    m_featuresList.clear();
-    return parseFeatures(rawData);
+    // only one features load at the time
+    cancelFeaturesLoading();
+    m_featuresState.reset(new FeaturesLoadState());
+    m_featuresState->bytesTotal = rawData.size();
+    startFeaturesParsing(rawData);
+}
+
+void DataProxy::cancelFeaturesLoading()
+{
+    if (!isLoadingFeatures()) {
+        return;
+    }
+    qDebug() << "Cancelling the loading of the features";
+    // the parsing job will stop at its next check point
+    m_featuresState->cancelled.store(1);
+    if (!m_featuresState->stream.isNull()) {
+        m_featuresState->stream->cancel();
+    }
+    if (!m_featuresReply.isNull()) {
+        m_featuresReply->disconnect(this);
+        m_featuresReply->slotAbort();
+        m_featuresReply.clear();
+    }
+    // stop listening to the cancelled job
+    m_featuresWatcher.setFuture(QFuture<FeaturesData>());
+    m_featuresProgressTimer.stop();
+    finishFeaturesLoading(false);
+}
+
+bool DataProxy::isLoadingFeatures() const
+{
+    return !m_featuresState.isNull();
 }
 
 bool DataProxy::loadImageAlignment(const QString &imageAlignmentId)
@@ -634,6 +700,64 @@ bool DataProxy::createRequest(QSharedPointer<NetworkReply> reply)
     connect(reply.data(), SIGNAL(signalFinished(QVariant)), &loop, SLOT(quit()));
     loop.exec();
 
+    return checkReply(reply);
+}
+
+bool DataProxy::waitForReplies(const QList<QSharedPointer<NetworkReply>> &replies)
+{
+    const auto pending = [&replies]() {
+        return std::any_of(replies.begin(),
+                           replies.end(),
+                           [](const QSharedPointer<NetworkReply> &reply) {
+                               return !reply.isNull() && !reply->isFinished();
+                           });
+    };
+    // one event loop waits for all the requests
+    QEventLoop loop;
+    for (const auto &reply : replies) {
+        if (!reply.isNull()) {
+            connect(reply.data(), SIGNAL(signalFinished(QVariant)), &loop, SLOT(quit()));
+        }
+    }
+    while (pending()) {
+        loop.exec();
+    }
+
+    // the errors of all the requests are shown together
+    QStringList errors;
+    for (const auto &reply : replies) {
+        const QString error = replyError(reply);
+        if (!error.isEmpty()) {
+            errors.append(error);
+        }
+    }
+    if (!errors.isEmpty()) {
+        QWidget *mainWidget = QApplication::desktop()->screen();
+        QMessageBox::critical(mainWidget, tr("Error downloading data"), errors.join("\n"));
+        return false;
+    }
+    return true;
+}
+
+QString DataProxy::replyError(QSharedPointer<NetworkReply> reply) const
+{
+    if (reply == nullptr) {
+        return tr("There was probably a network problem.");
+    }
+    if (reply->hasErrors()) {
+        const auto error = reply->parseErrors();
+        return QString("%1 : %2").arg(error->name()).arg(error->description());
+    }
+    const NetworkReply::ReturnCode returnCode
+        = static_cast<NetworkReply::ReturnCode>(reply->return_code());
+    if (returnCode == NetworkReply::CodeError) {
+        return tr("There was probably a network problem.");
+    }
+    return QString();
+}
+
+bool DataProxy::checkReply(QSharedPointer<NetworkReply> reply)
+{
     if (reply == nullptr) {
         QWidget *mainWidget = QApplication::desktop()->screen();
         QMessageBox::critical(mainWidget,
@@ -671,6 +795,16 @@ bool DataProxy::userLogIn() const
     return m_user && m_user->enabled();
 }
 
+const DatasetCache &DataProxy::getDatasetCache() const
+{
+    return m_datasetCache;
+}
+
+void DataProxy::setDatasetCacheBudget(const qint64 budget)
+{
+    m_datasetCache.budget(budget);
+}
+
 bool DataProxy::parseRequest(QSharedPointer<NetworkReply> reply, const DownloadType &type)
 {
     Q_ASSERT(reply);
@@ -700,9 +834,6 @@ bool DataProxy::parseRequest(QSharedPointer<NetworkReply> reply, const DownloadT
     case TissueImageDownloaded:
         parsedOk = parseCellTissueImage(reply->getRaw(), reply->property("figure_name").toString());
         break;
-    case FeaturesDownloaded:
-        parsedOk = parseFeatures(reply->getRaw());
-        break;
     case UserSelectionsDownloaded:
         parsedOk = parseUserSelections(reply->getJSON());
         break;
@@ -734,17 +865,188 @@ bool DataProxy::parseRequest(QSharedPointer<NetworkReply> reply, const DownloadT
     }
 }
 
-// TODO this function is causing the CPU to freeze with big datasets
-// solution is to run it concurrently
-bool DataProxy::parseFeatures(const QByteArray &rawData)
+void DataProxy::loadSnapshotAsync(const QString &datasetId, const QString &lastModified)
 {
-    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
-    FeaturesHandler handler(m_featuresList, m_geneNameToObject);
-    Reader reader;
-    StringStream is(rawData.data());
-    const bool parsedOk = reader.Parse(is, handler);
-    QGuiApplication::restoreOverrideCursor();
-    return parsedOk;
+    // only one features load at the time
+    cancelFeaturesLoading();
+    m_featuresState.reset(new FeaturesLoadState());
+    m_featuresState->bytesTotal = QFileInfo(m_datasetSnapshot.fileName(datasetId)).size();
+    m_featuresWatcher.setFuture(QtConcurrent::run(&DataProxy::readSnapshotJob,
+                                                  m_datasetSnapshot,
+                                                  datasetId,
+                                                  lastModified,
+                                                  m_featuresState));
+    m_featuresProgressTimer.start();
+}
+
+void DataProxy::startFeaturesParsing(const QByteArray &rawData)
+{
+    Q_ASSERT(isLoadingFeatures());
+    m_featuresWatcher.setFuture(
+        QtConcurrent::run(&DataProxy::parseFeaturesJob, rawData, m_featuresState));
+    m_featuresProgressTimer.start();
+}
+
+data::ParseProgressCallback DataProxy::featuresProgress(FeaturesLoadStatePtr state)
+{
+    return [state](qint64 bytes) {
+        state->bytesParsed.store(bytes);
+        return state->cancelled.load() == 0;
+    };
+}
+
+DataProxy::FeaturesData DataProxy::readSnapshotJob(const DatasetSnapshot snapshot,
+                                                   const QString datasetId,
+                                                   const QString lastModified,
+                                                   FeaturesLoadStatePtr state)
+{
+    // runs in a worker thread, only the shared state can be accessed here
+    FeaturesData result;
+    result.parsedOk
+        = snapshot.read(datasetId, lastModified, result.features, featuresProgress(state));
+    return result;
+}
+
+DataProxy::FeaturesData DataProxy::parseFeaturesJob(const QByteArray rawData,
+                                                    FeaturesLoadStatePtr state)
+{
+    // runs in a worker thread, only the shared state can be accessed here
+    const data::ParseProgressCallback progress = featuresProgress(state);
+    FeaturesData result;
+    if (!state->stream.isNull()) {
+        result.parsedOk = state->stream->parse(result.features, progress);
+    } else {
+        result.parsedOk = data::parseFeaturesParallel(rawData, result.features, progress);
+    }
+    if (result.parsedOk) {
+        result.features.buildIndexes();
+        result.features.computeGeneCutoffs();
+    }
+    return result;
+}
+
+bool DataProxy::waitForFeatures(const FeaturesLoadStatePtr state)
+{
+    if (state.isNull()) {
+        return false;
+    }
+    // the event loop keeps the UI responsive while the features are loaded
+    QEventLoop loop;
+    connect(this, SIGNAL(signalFeaturesLoaded(bool)), &loop, SLOT(quit()));
+    // the load could be over already (or a new load could be started while waiting)
+    while (m_featuresState == state) {
+        loop.exec();
+    }
+    return state->parsedOk;
+}
+
+void DataProxy::setFeatures(const FeatureStore &features)
+{
+    m_features = features;
+    m_geneNameToObject.clear();
+    m_genesById.clear();
+    m_genesById.reserve(features.genesCount());
+    for (int i = 0; i < features.genesCount(); ++i) {
+        auto gene = std::make_shared<Gene>(features.geneName(static_cast<quint32>(i)));
+        gene->id(static_cast<quint32>(i));
+        gene->cut_off(features.geneCutoffs().at(i));
+        m_geneNameToObject.insert(gene->name(), gene);
+        m_genesById.append(gene);
+    }
+}
+
+void DataProxy::setDatasetContent(const DatasetContent &content)
+{
+    m_features = content.features;
+    m_genesById = content.genes;
+    m_geneNameToObject.clear();
+    for (const auto &gene : m_genesById) {
+        m_geneNameToObject.insert(gene->name(), gene);
+    }
+    m_chip = content.chip;
+    m_imageAlignment = content.imageAlignment;
+    m_cellTissueImages.clear();
+    m_cellTissueImages.insert(m_imageAlignment->figureBlue(), content.figureBlue);
+    if (!content.figureRed.isEmpty()) {
+        m_cellTissueImages.insert(m_imageAlignment->figureRed(), content.figureRed);
+    }
+}
+
+void DataProxy::finishFeaturesLoading(const bool parsedOk)
+{
+    Q_ASSERT(isLoadingFeatures());
+    m_featuresState->parsedOk = parsedOk;
+    m_featuresState.clear();
+    emit signalFeaturesLoaded(parsedOk);
+}
+
+void DataProxy::slotFeaturesDataReceived(QByteArray rawData)
+{
+    if (m_featuresReply.isNull() || sender() != m_featuresReply.data()) {
+        return;
+    }
+    if (m_featuresState->bytesTotal == 0) {
+        m_featuresState->bytesTotal = qMax(m_featuresReply->contentLength(), qint64(0));
+    }
+    m_featuresState->stream->addData(rawData);
+}
+
+void DataProxy::slotFeaturesDownloaded()
+{
+    const QSharedPointer<NetworkReply> reply = m_featuresReply;
+    if (reply.isNull() || sender() != reply.data()) {
+        return;
+    }
+    m_featuresReply.clear();
+    if (!checkReply(reply)) {
+        // stop the parsing job without reporting a parsing error
+        m_featuresState->stream->cancel();
+        m_featuresWatcher.setFuture(QFuture<FeaturesData>());
+        m_featuresProgressTimer.stop();
+        finishFeaturesLoading(false);
+        return;
+    }
+    // the data that was not streamed (if any) is parsed as well
+    m_featuresState->stream->addData(reply->getRaw());
+    m_featuresState->stream->finish();
+}
+
+void DataProxy::slotFeaturesParsed()
+{
+    // the future is empty (canceled) if the job was cancelled
+    if (!isLoadingFeatures() || m_featuresWatcher.isCanceled()) {
+        return;
+    }
+    m_featuresProgressTimer.stop();
+    // the parsing of a stream can fail before the download is over
+    if (!m_featuresReply.isNull()) {
+        m_featuresReply->disconnect(this);
+        m_featuresReply->slotAbort();
+        m_featuresReply.clear();
+    }
+    FeaturesData result = m_featuresWatcher.result();
+    m_featuresWatcher.setFuture(QFuture<FeaturesData>());
+    if (result.parsedOk) {
+        // publish the new features all at once
+        setFeatures(result.features);
+        const qint64 bytesParsed = m_featuresState->bytesParsed.load();
+        emit signalFeaturesProgress(bytesParsed, qMax(bytesParsed, m_featuresState->bytesTotal));
+    } else if (m_featuresState->downloaded) {
+        QWidget *mainWidget = QApplication::desktop()->screen();
+        QMessageBox::critical(mainWidget,
+                              tr("Error parsing data"),
+                              tr("There was an error parsing the data object from the "
+                                 "remote server"));
+    }
+    finishFeaturesLoading(result.parsedOk);
+}
+
+void DataProxy::slotFeaturesProgress()
+{
+    if (isLoadingFeatures()) {
+        emit signalFeaturesProgress(m_featuresState->bytesParsed.load(),
+                                    m_featuresState->bytesTotal);
+    }
 }
 
 bool DataProxy::parseCellTissueImage(const QByteArray &rawData, const QString &imageName)
@@ -789,6 +1091,9 @@ bool DataProxy::parseDatasets(const QJsonDocument &doc)
 
 bool DataProxy::parseRemoveDataset(const QString &datasetId)
 {
+    m_datasetCache.remove(datasetId);
+    m_datasetSnapshot.remove(datasetId);
+
     // remove dataset from list
     m_datasetList.erase(std::remove_if(m_datasetList.begin(),
                                        m_datasetList.end(),
@@ -5,8 +5,13 @@
 #include <QVector>
 #include <QMap>
 #include <QSharedPointer>
+#include <QFutureWatcher>
+#include <QTimer>
 #include "config/Configuration.h"
 #include "dataModel/OAuth2TokenDTO.h"
+#include "dataModel/FeatureStore.h"
+#include "data/DatasetCache.h"
+#include "data/DatasetSnapshot.h"
 #include <array>
 #include <memory>
 
@@ -18,10 +23,14 @@ class UserSelection;
 class User;
 class ImageAlignment;
 class Gene;
-class Feature;
 class Dataset;
 class Chip;
 class MinVersionDTO;
+class BinaryDataset;
+namespace data
+{
+class FeaturesStream;
+}
 
 // DataProxy is a globally accessible all-in-all data store. It provides an
 // interface to access remotely stored data and means of storing and managing
@@ -56,7 +65,6 @@ public:
     // MAIN CONTAINERS (MVC)
     typedef std::shared_ptr<Chip> ChipPtr;
     typedef std::shared_ptr<Dataset> DatasetPtr;
-    typedef std::shared_ptr<Feature> FeaturePtr;
     typedef std::shared_ptr<Gene> GenePtr;
     typedef std::shared_ptr<ImageAlignment> ImageAlignmentPtr;
     typedef std::shared_ptr<UserSelection> UserSelectionPtr;
@@ -67,19 +75,13 @@ public:
 
     // TODO separate data API and data adquisition
 
-    // TODO replace JSON for binary format for the features (data frame or tab
-    // delimited)
-
-    // TODO make the parsing of the features data asynchronous
-
-    // TODO Currently dataProxy does not support caching. The dataset content
-    // variables are unique for the dataset currently opened. We should cache
-    // the dataset content variable by dataset ID
+    // NOTE the dataset content variables are unique for the dataset currently
+    // opened. The content of the recently opened datasets is kept in a memory
+    // cache (by dataset ID) so they can be opened again without downloading
+    // and parsing their data
 
     // list of unique genes
     typedef QList<GenePtr> GeneList;
-    // list of features
-    typedef QList<FeaturePtr> FeatureList;
     // list of unique datasets
     typedef QList<DatasetPtr> DatasetList;
     // list of user selections
@@ -94,9 +96,10 @@ public:
     explicit DataProxy(QObject *parent = 0);
     ~DataProxy();
 
-    // clean up memory cache
+    // clean up memory cache (including the datasets cache)
     void clean();
-    // clean up memory cache and local cache (hard drive)
+    // clean up memory cache and local cache (hard drive) including the
+    // datasets snapshots
     void cleanAll();
 
     // DATA LOADERS
@@ -110,6 +113,11 @@ public:
     bool loadDatasets();
     // Downloads and parses the dataset content (chip, cell images and features)
     // from the database
+    // The content is taken from the datasets cache if the dataset was opened
+    // recently and has not been modified since. Otherwise the parsed features
+    // are read in the background from the dataset snapshot on disk if any (it
+    // is written the first time the dataset is opened) while the chip and the
+    // images are downloaded, the progress is reported as for loadFeaturesAsync()
     // Returns true if the download and parsing went fine
     bool loadDatasetContent(const DatasetPtr dataset);
     // Downloads and parses the current logged user from the database
@@ -130,6 +138,7 @@ public:
     // Returns true if the download and parsing went fine
     bool loadChip(const QString &chipId);
     // Download and parses the ST Data of a dataset from the database
+    // The call waits for loadFeaturesAsync() to finish
     // Returns true if the download and parsing went fine
     bool loadFeatures(const QString &datasetId);
     // Download and parses an alignment from the database
@@ -150,12 +159,34 @@ public:
     // returns true if the parsing was correct
     bool loadImageAlignment(const ImageAlignment &alignment);
     // st data features imported locally from file
+    // The call waits for loadFeaturesAsync() to finish
     // returns true if the parsing was correct
     bool loadFeatures(const QByteArray &rawData);
+    // st data features imported locally from a binary dataset file
+    // (the dataset must be open)
+    // returns true if the features were loaded correctly
+    bool loadFeatures(const BinaryDataset &dataset);
     // cell tissue image imported from file
     // returns true if the parsing was correct
     bool loadCellTissueImage(const QByteArray &rawData, const QString &imageName);
 
+    // ASYNC DATA LOADERS
+    // The features are downloaded and parsed in the background (the parsing
+    // is done in a worker thread). The progress of the parsing is reported with
+    // signalFeaturesProgress() and signalFeaturesLoaded() is emitted when done.
+    // The features and genes containers are only replaced once the parsing has
+    // finished correctly. Starting a new load cancels the current one.
+
+    // Download and parses the ST Data of a dataset from the database
+    void loadFeaturesAsync(const QString &datasetId);
+    // st data features imported locally from file
+    void loadFeaturesAsync(const QByteArray &rawData);
+    // cancels the current features load if any (signalFeaturesLoaded(false)
+    // is emitted and the containers are left untouched)
+    void cancelFeaturesLoading();
+    // true if features are being downloaded or parsed
+    bool isLoadingFeatures() const;
+
     // DATA UPDATERS
     // Data updaters are meant to be used to update an object in the database
     // The object must be passed as argument and it has to have a method to
@@ -215,16 +246,16 @@ public:
     // returns the gene object of the given gene name
     GenePtr geneGeneObject(const QString &gene_name) const;
 
-    // returns the list of currently loaded features
-    // a current dataset object must be selected otherwise it returns an empty
-    // list
-    const FeatureList &getFeatureList() const;
+    // returns the gene object of the given gene id (the genes of the current
+    // dataset have dense ids, 0 to number of genes - 1, assigned when parsing)
+    // returns null if the id is not valid
+    GenePtr getGene(const quint32 geneId) const;
 
-    // returns the list of currently loaded features whose gene name matches
-    // geneName
+    // returns the currently loaded features (with the look up indexes and the
+    // genes cut-offs computed, the gene ids are the ones of the gene objects)
     // a current dataset object must be selected otherwise it returns an empty
-    // list
-    const FeatureList &getGeneFeatureList(const QString &geneName) const;
+    // store
+    const FeatureStore &getFeatureStore() const;
 
     // returns the currently loaded image alignment object
     // a current dataset object must be selected otherwise it returns a null
@@ -258,13 +289,76 @@ public:
     // true if the user is currently logged in
     bool userLogIn() const;
 
+    // DATASETS CACHE
+    // returns the cache of the contents of the recently opened datasets
+    // (to query the memory used and the hits/misses counters)
+    const DatasetCache &getDatasetCache() const;
+    // sets the maximum memory (bytes) used by the datasets cache
+    void setDatasetCacheBudget(const qint64 budget);
+
 public slots:
 
 private slots:
 
+    // a chunk of the features data has been downloaded
+    void slotFeaturesDataReceived(QByteArray rawData);
+    // the features data has been downloaded
+    void slotFeaturesDownloaded();
+    // the features parsing job has finished
+    void slotFeaturesParsed();
+    // reports the progress of the features parsing job
+    void slotFeaturesProgress();
+
 signals:
 
+    // progress of the features parsing (bytes parsed from the raw data)
+    void signalFeaturesProgress(qint64 bytesParsed, qint64 bytesTotal);
+    // the features load has finished (parsedOk is false on errors or if cancelled)
+    void signalFeaturesLoaded(bool parsedOk);
+
 private:
+    // result of a features parsing job
+    struct FeaturesData {
+        FeaturesData()
+            : parsedOk(false)
+        {
+        }
+        bool parsedOk;
+        FeatureStore features;
+    };
+
+    // state of a features load, shared with the parsing job
+    // (only the atomic members are accessed from the worker thread)
+    struct FeaturesLoadState {
+        FeaturesLoadState()
+            : cancelled(0)
+            , bytesParsed(0)
+            , bytesTotal(0)
+            , downloaded(false)
+            , parsedOk(false)
+        {
+        }
+        QAtomicInt cancelled;
+        QAtomicInteger<qint64> bytesParsed;
+        qint64 bytesTotal;
+        bool downloaded;
+        bool parsedOk;
+        // the downloaded data to parse (null if the data is not downloaded)
+        QSharedPointer<data::FeaturesStream> stream;
+    };
+    typedef QSharedPointer<FeaturesLoadState> FeaturesLoadStatePtr;
+
+    // Internal function to check the status of a finished network request
+    // errors are shown to the user
+    // returns true if the network call was successful (no errors)
+    bool checkReply(QSharedPointer<NetworkReply> reply);
+    // Internal function to wait for several network requests made concurrently
+    // The errors of all the requests are shown together to the user
+    // returns true if all the network calls were successful (no errors)
+    bool waitForReplies(const QList<QSharedPointer<NetworkReply>> &replies);
+    // returns the description of the errors of a finished network request
+    // (empty if the request was successful)
+    QString replyError(QSharedPointer<NetworkReply> reply) const;
     // Internal function to create network requests for data objects
     // The network call will be synchronous and the function will
     // return true of the the network call was successful (no errors)
@@ -278,9 +372,31 @@ private:
     // PARSING FUNCTIONS
     // Functions to parse the data downloaded from the network
 
-    // function to parse all the features and genes and add them to the containers
-    // returns true if the parsing was correct
-    bool parseFeatures(const QByteArray &rawData);
+    // starts a features load that reads the features of the dataset from its
+    // snapshot in the background (the load fails if the snapshot is not valid)
+    void loadSnapshotAsync(const QString &datasetId, const QString &lastModified);
+    // starts the features parsing job for the current features load
+    void startFeaturesParsing(const QByteArray &rawData);
+    // the progress call back of the jobs (it updates the state)
+    static data::ParseProgressCallback featuresProgress(FeaturesLoadStatePtr state);
+    // reads the features from the snapshot of the dataset (run in a worker thread)
+    static FeaturesData readSnapshotJob(const DatasetSnapshot snapshot,
+                                        const QString datasetId,
+                                        const QString lastModified,
+                                        FeaturesLoadStatePtr state);
+    // parses all the features of rawData or of the state stream if any
+    // and builds their look up indexes and genes cut-offs (run in a worker thread)
+    static FeaturesData parseFeaturesJob(const QByteArray rawData, FeaturesLoadStatePtr state);
+    // waits (with an event loop) for the given features load to finish (the
+    // state is kept by the caller so a load that is already over can be checked)
+    // returns true if the features were loaded correctly
+    bool waitForFeatures(const FeaturesLoadStatePtr state);
+    // ends the current features load
+    void finishFeaturesLoading(const bool parsedOk);
+    // replaces the current features and creates the gene objects of its genes
+    void setFeatures(const FeatureStore &features);
+    // replaces the current dataset content with a cached one
+    void setDatasetContent(const DatasetContent &content);
 
     // function to parse a cell tissue image and add it to the container
     // returns true if the parsing was correct
@@ -333,9 +449,11 @@ private:
     // the current chip object for the selected dataset
     ChipPtr m_chip;
     // the current features for the selected dataset
-    FeatureList m_featuresList;
+    FeatureStore m_features;
     // the map of gene names to gene objects
     GeneNameToObject m_geneNameToObject;
+    // the gene objects indexed by gene id
+    GeneList m_genesById;
     // the current images (blue and red) for the selected dataset
     CellFigureMap m_cellTissueImages;
     // the application min supported version
@@ -346,6 +464,18 @@ private:
     Configuration m_configurationManager;
     // network manager to make network requests (dataproxy owns it)
     QScopedPointer<NetworkManager> m_networkManager;
+    // the contents of the recently opened datasets
+    DatasetCache m_datasetCache;
+    // the snapshots of the parsed features of the opened datasets (on disk)
+    DatasetSnapshot m_datasetSnapshot;
+    // the current features load (null if none)
+    FeaturesLoadStatePtr m_featuresState;
+    // the network request of the current features load
+    QSharedPointer<NetworkReply> m_featuresReply;
+    // watcher of the features parsing job
+    QFutureWatcher<FeaturesData> m_featuresWatcher;
+    // timer to report the progress of the features parsing
+    QTimer m_featuresProgressTimer;
 
     Q_DISABLE_COPY(DataProxy)
 };
@@ -0,0 +1,133 @@
+#include "DatasetCache.h"
+
+#include "dataModel/Gene.h"
+#include "dataModel/Chip.h"
+#include "dataModel/ImageAlignment.h"
+
+qint64 DatasetContent::memorySize() const
+{
+    qint64 bytes = sizeof(DatasetContent) + features.memorySize();
+    bytes += figureBlue.capacity() + figureRed.capacity();
+    // the gene object, the shared pointer control block and the list node
+    for (const auto &gene : genes) {
+        bytes += sizeof(Gene) + 2 * sizeof(int) + sizeof(void *)
+                 + gene->name().size() * sizeof(QChar);
+    }
+    if (chip) {
+        bytes += sizeof(Chip);
+    }
+    if (imageAlignment) {
+        bytes += sizeof(ImageAlignment);
+    }
+    return bytes;
+}
+
+DatasetCache::DatasetCache(const qint64 budget)
+    : m_budget(budget)
+    , m_size(0)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+DatasetCache::~DatasetCache()
+{
+}
+
+qint64 DatasetCache::budget() const
+{
+    return m_budget;
+}
+
+void DatasetCache::budget(const qint64 budget)
+{
+    m_budget = budget;
+    evict();
+}
+
+qint64 DatasetCache::size() const
+{
+    return m_size;
+}
+
+int DatasetCache::count() const
+{
+    return m_entries.size();
+}
+
+bool DatasetCache::contains(const QString &datasetId) const
+{
+    return m_entries.contains(datasetId);
+}
+
+int DatasetCache::hits() const
+{
+    return m_hits;
+}
+
+int DatasetCache::misses() const
+{
+    return m_misses;
+}
+
+bool DatasetCache::find(const QString &datasetId,
+                        const QString &lastModified,
+                        DatasetContent &content)
+{
+    const auto it = m_entries.constFind(datasetId);
+    if (it == m_entries.constEnd()) {
+        ++m_misses;
+        return false;
+    }
+    if (it.value().content.lastModified != lastModified) {
+        // the dataset has changed, the content is outdated
+        remove(datasetId);
+        ++m_misses;
+        return false;
+    }
+    m_order.removeOne(datasetId);
+    m_order.prepend(datasetId);
+    content = it.value().content;
+    ++m_hits;
+    return true;
+}
+
+void DatasetCache::insert(const QString &datasetId, const DatasetContent &content)
+{
+    remove(datasetId);
+    Entry entry;
+    entry.content = content;
+    entry.size = content.memorySize();
+    if (entry.size > m_budget) {
+        return;
+    }
+    m_entries.insert(datasetId, entry);
+    m_order.prepend(datasetId);
+    m_size += entry.size;
+    evict();
+}
+
+void DatasetCache::remove(const QString &datasetId)
+{
+    const auto it = m_entries.find(datasetId);
+    if (it == m_entries.end()) {
+        return;
+    }
+    m_size -= it.value().size;
+    m_entries.erase(it);
+    m_order.removeOne(datasetId);
+}
+
+void DatasetCache::clear()
+{
+    m_entries.clear();
+    m_order.clear();
+    m_size = 0;
+}
+
+void DatasetCache::evict()
+{
+    while (m_size > m_budget && !m_order.isEmpty()) {
+        remove(m_order.last());
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef DATASETCACHE_H
+#define DATASETCACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+
+#include <memory>
+
+#include "dataModel/FeatureStore.h"
+
+class Gene;
+class Chip;
+class ImageAlignment;
+
+// the content of a dataset (what DataProxy loads when a dataset is opened)
+struct DatasetContent {
+    // the parsed features (with their look up indexes)
+    FeatureStore features;
+    // the gene objects indexed by gene id
+    QList<std::shared_ptr<Gene>> genes;
+    std::shared_ptr<Chip> chip;
+    std::shared_ptr<ImageAlignment> imageAlignment;
+    // the raw data of the tissue images (red is empty if it was not loaded)
+    QByteArray figureBlue;
+    QByteArray figureRed;
+    // the last modification time of the dataset when the content was loaded
+    QString lastModified;
+
+    // approximate size in bytes of the memory used by the content
+    qint64 memorySize() const;
+};
+
+// DatasetCache keeps the content of the recently opened datasets in memory
+// (by dataset id) so opening them again does not need to download and parse
+// the data. The least recently used datasets are evicted when the memory used
+// by the cached contents goes over the budget.
+// The contents share their data with the ones given/returned (the containers
+// are implicitly shared or shared pointers) so a cached dataset that is also
+// open does not use memory twice.
+class DatasetCache
+{
+
+public:
+    explicit DatasetCache(const qint64 budget);
+    ~DatasetCache();
+
+    // the maximum memory (bytes) used by the cached contents
+    // (lowering the budget evicts datasets)
+    qint64 budget() const;
+    void budget(const qint64 budget);
+
+    // the memory (bytes) used by the cached contents
+    qint64 size() const;
+    // number of cached datasets
+    int count() const;
+    bool contains(const QString &datasetId) const;
+
+    // number of look ups that found (or not) the dataset
+    int hits() const;
+    int misses() const;
+
+    // looks up the content of the dataset, the cached content is only valid
+    // if the dataset has not been modified since it was cached
+    // returns true and sets content if found (the dataset becomes the most
+    // recently used one)
+    bool find(const QString &datasetId, const QString &lastModified, DatasetContent &content);
+    // adds (or replaces) the content of the dataset as the most recently used
+    // one, contents bigger than the budget are not cached
+    void insert(const QString &datasetId, const DatasetContent &content);
+    // removes the dataset from the cache
+    void remove(const QString &datasetId);
+    // removes all the datasets (the counters are kept)
+    void clear();
+
+private:
+    struct Entry {
+        DatasetContent content;
+        qint64 size;
+    };
+
+    // evicts the least recently used datasets until the cache fits the budget
+    void evict();
+
+    QHash<QString, Entry> m_entries;
+    // the cached dataset ids, most recently used first
+    QList<QString> m_order;
+    qint64 m_budget;
+    qint64 m_size;
+    int m_hits;
+    int m_misses;
+
+    Q_DISABLE_COPY(DatasetCache)
+};
+
+#endif // DATASETCACHE_H
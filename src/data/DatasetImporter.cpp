@@ -55,6 +55,16 @@ const QByteArray DatasetImporter::featuresFile() const
     return file.readAll();
 }
 
+const QString DatasetImporter::featuresFileName() const
+{
+    return m_ui->featuresFile->text();
+}
+
+void DatasetImporter::featuresFileName(const QString &filename)
+{
+    m_ui->featuresFile->setText(filename);
+}
+
 const QByteArray DatasetImporter::mainImageFile() const
 {
     QFile file(m_ui->mainImageFile->text());
@@ -121,7 +131,9 @@ void DatasetImporter::slotLoadFeaturesFile()
         = QFileDialog::getOpenFileName(this,
                                        tr("Open Features File"),
                                        QDir::homePath(),
-                                       QString("%1").arg(tr("JSON Files (*.json)")));
+                                       QString("%1;;%2")
+                                           .arg(tr("JSON Files (*.json)"))
+                                           .arg(tr("ST Binary Files (*.stb)")));
     // early out
     if (filename.isEmpty()) {
         return;
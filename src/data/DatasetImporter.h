@@ -11,7 +11,7 @@ class DatasetImporter;
 // This widget allows the user to import a dataset.
 // The widget asks the user to introduce the chip
 // size, the alignment matrix, the features in JSON data
-// and the images
+// (or in ST binary format) and the images
 class DatasetImporter : public QDialog
 {
     Q_OBJECT
@@ -22,6 +22,9 @@ public:
 
     const QString datasetName() const;
     const QByteArray featuresFile() const;
+    // path of the features file (JSON or ST binary format)
+    const QString featuresFileName() const;
+    void featuresFileName(const QString &filename);
     const QRect chipDimensions() const;
     const QTransform alignmentMatrix() const;
     const QByteArray mainImageFile() const;
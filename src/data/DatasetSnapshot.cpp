@@ -0,0 +1,382 @@
+#include "data/DatasetSnapshot.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QVector>
+
+#include <cstring>
+#include <limits>
+
+namespace
+{
+
+// format identifiers
+static const char MAGIC[4] = {'S', 'T', 'S', 'N'};
+static const quint32 BYTE_ORDER_MARK = 0x01020304;
+static const quint32 VERSION = 1;
+// extension of the snapshot files
+static const QString EXTENSION = QStringLiteral(".snapshot");
+
+// sections of the file in the order they are stored
+enum Section {
+    KeySection = 0,
+    NamesOffsetsSection,
+    NamesSection,
+    SpotsXSection,
+    SpotsYSection,
+    GeneIdsSection,
+    SpotIdsSection,
+    CountsSection,
+    SpotOffsetsSection,
+    SpotFeaturesSection,
+    GeneOffsetsSection,
+    GeneFeaturesSection,
+    GeneCutoffsSection,
+    SectionsCount
+};
+
+// fixed size header at the beginning of the file
+struct FileHeader {
+    char magic[4];
+    quint32 byteOrder;
+    quint32 version;
+    quint32 genes;
+    quint32 spots;
+    quint32 features;
+    // size in bytes of the key and the gene names sections
+    quint64 keySize;
+    quint64 namesSize;
+    // offsets of the sections from the beginning of the file
+    quint64 sections[SectionsCount];
+};
+
+static_assert(sizeof(FileHeader) == 144, "The snapshot header must not have padding");
+
+// reads and checks the format of the header of a snapshot
+bool readHeader(const uchar *data, const qint64 size, FileHeader &header)
+{
+    if (size < static_cast<qint64>(sizeof(FileHeader))) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(FileHeader));
+    return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+           && header.byteOrder == BYTE_ORDER_MARK && header.version == VERSION;
+}
+
+// sections start at 8 bytes boundaries
+inline quint64 alignSection(const quint64 offset)
+{
+    return (offset + 7) & ~static_cast<quint64>(7);
+}
+
+// sizes in bytes of the sections for the given header
+void sectionSizes(const FileHeader &header, quint64 sizes[SectionsCount])
+{
+    const quint64 genes = header.genes;
+    const quint64 spots = header.spots;
+    const quint64 features = header.features;
+    sizes[KeySection] = header.keySize;
+    sizes[NamesOffsetsSection] = (genes + 1) * sizeof(quint32);
+    sizes[NamesSection] = header.namesSize;
+    sizes[SpotsXSection] = spots * sizeof(float);
+    sizes[SpotsYSection] = spots * sizeof(float);
+    sizes[GeneIdsSection] = features * sizeof(quint32);
+    sizes[SpotIdsSection] = features * sizeof(quint32);
+    sizes[CountsSection] = features * sizeof(int);
+    sizes[SpotOffsetsSection] = (spots + 1) * sizeof(int);
+    sizes[SpotFeaturesSection] = features * sizeof(int);
+    sizes[GeneOffsetsSection] = (genes + 1) * sizeof(int);
+    sizes[GeneFeaturesSection] = features * sizeof(int);
+    sizes[GeneCutoffsSection] = genes * sizeof(int);
+}
+
+// copies a section of the mapped file into a column
+template <typename T>
+void copySection(const uchar *section, const int size, QVector<T> &column)
+{
+    column.resize(size);
+    if (size > 0) {
+        std::memcpy(column.data(), section, static_cast<size_t>(size) * sizeof(T));
+    }
+}
+
+// true if the offsets start at 0, do not decrease and end at last
+template <typename T>
+bool validOffsets(const T *offsets, const int size, const T last)
+{
+    if (offsets[0] != 0 || offsets[size] != last) {
+        return false;
+    }
+    for (int i = 0; i < size; ++i) {
+        if (offsets[i] > offsets[i + 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// true if all the values are in [0, size)
+template <typename T>
+bool validIndexes(const QVector<T> &values, const int size)
+{
+    for (const T value : values) {
+        if (static_cast<qint64>(value) < 0 || static_cast<qint64>(value) >= size) {
+            return false;
+        }
+    }
+    return true;
+}
+}
+
+DatasetSnapshot::DatasetSnapshot(const QString &directory)
+    : m_directory(directory)
+{
+}
+
+DatasetSnapshot::~DatasetSnapshot()
+{
+}
+
+const QString DatasetSnapshot::fileName(const QString &datasetId) const
+{
+    // the id is hashed to get a valid file name
+    const QByteArray hash = QCryptographicHash::hash(datasetId.toUtf8(), QCryptographicHash::Md5);
+    return m_directory + QDir::separator() + QString::fromLatin1(hash.toHex()) + EXTENSION;
+}
+
+bool DatasetSnapshot::contains(const QString &datasetId, const QString &lastModified) const
+{
+    QFile file(fileName(datasetId));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray header_data = file.read(sizeof(FileHeader));
+    FileHeader header;
+    if (!readHeader(reinterpret_cast<const uchar *>(header_data.constData()),
+                    header_data.size(),
+                    header)) {
+        return false;
+    }
+    const QByteArray snapshot_key = key(datasetId, lastModified);
+    return header.keySize == static_cast<quint64>(snapshot_key.size())
+           && file.seek(static_cast<qint64>(header.sections[KeySection]))
+           && file.read(snapshot_key.size()) == snapshot_key;
+}
+
+bool DatasetSnapshot::read(const QString &datasetId,
+                           const QString &lastModified,
+                           FeatureStore &features,
+                           const data::ParseProgressCallback &progress) const
+{
+    QFile file(fileName(datasetId));
+    if (!file.exists()) {
+        return false;
+    }
+    // a cancelled read does not remove the snapshot
+    bool cancelled = false;
+    const data::ParseProgressCallback sectionsRead = [&progress, &cancelled](qint64 bytes) {
+        cancelled = progress && !progress(bytes);
+        return !cancelled;
+    };
+    bool readOk = false;
+    if (file.open(QIODevice::ReadOnly)) {
+        const qint64 size = file.size();
+        uchar *data = file.map(0, size);
+        if (data != nullptr) {
+            readOk = load(data, size, key(datasetId, lastModified), features, sectionsRead);
+            file.unmap(data);
+        }
+        file.close();
+    }
+    if (!readOk && !cancelled) {
+        qDebug() << "Removing outdated or invalid dataset snapshot" << file.fileName();
+        file.remove();
+    }
+    return readOk;
+}
+
+void DatasetSnapshot::remove(const QString &datasetId) const
+{
+    QFile::remove(fileName(datasetId));
+}
+
+void DatasetSnapshot::clear() const
+{
+    QDir dir(m_directory);
+    for (const QString &name : dir.entryList(QStringList("*" + EXTENSION), QDir::Files)) {
+        dir.remove(name);
+    }
+}
+
+QByteArray DatasetSnapshot::key(const QString &datasetId, const QString &lastModified)
+{
+    return datasetId.toUtf8() + '\n' + lastModified.toUtf8();
+}
+
+bool DatasetSnapshot::load(const uchar *data,
+                           const qint64 size,
+                           const QByteArray &key,
+                           FeatureStore &features,
+                           const data::ParseProgressCallback &progress)
+{
+    FileHeader header;
+    if (!readHeader(data, size, header)) {
+        return false;
+    }
+    const quint32 max_int = static_cast<quint32>(std::numeric_limits<int>::max());
+    if (header.genes >= max_int || header.spots >= max_int || header.features >= max_int
+        || header.namesSize >= max_int || header.keySize >= max_int) {
+        return false;
+    }
+
+    // every section must be aligned and inside the file
+    quint64 sizes[SectionsCount];
+    sectionSizes(header, sizes);
+    const quint64 file_size = static_cast<quint64>(size);
+    for (int i = 0; i < SectionsCount; ++i) {
+        const quint64 offset = header.sections[i];
+        if (offset % 8 != 0 || offset > file_size || sizes[i] > file_size - offset) {
+            return false;
+        }
+    }
+    const uchar *sections[SectionsCount];
+    for (int i = 0; i < SectionsCount; ++i) {
+        sections[i] = data + header.sections[i];
+    }
+
+    // the snapshot must be the one of the dataset and its last modification
+    const QByteArray snapshot_key(reinterpret_cast<const char *>(sections[KeySection]),
+                                  static_cast<int>(header.keySize));
+    if (snapshot_key != key) {
+        return false;
+    }
+
+    const int genes = static_cast<int>(header.genes);
+    const int spots = static_cast<int>(header.spots);
+    const int num_features = static_cast<int>(header.features);
+
+    // the genes and spots tables and their look ups are built adding them in
+    // order of id (the names and the coordinates must be unique)
+    FeatureStore store;
+    const quint32 *names_offsets = reinterpret_cast<const quint32 *>(sections[NamesOffsetsSection]);
+    const char *names = reinterpret_cast<const char *>(sections[NamesSection]);
+    if (!validOffsets(names_offsets, genes, static_cast<quint32>(header.namesSize))) {
+        return false;
+    }
+    for (int i = 0; i < genes; ++i) {
+        const quint32 begin = names_offsets[i];
+        const quint32 end = names_offsets[i + 1];
+        store.addGene(QString::fromUtf8(names + begin, static_cast<int>(end - begin)));
+    }
+    const float *spots_x = reinterpret_cast<const float *>(sections[SpotsXSection]);
+    const float *spots_y = reinterpret_cast<const float *>(sections[SpotsYSection]);
+    for (int i = 0; i < spots; ++i) {
+        store.addSpot(spots_x[i], spots_y[i]);
+    }
+    if (store.genesCount() != genes || store.spotsCount() != spots
+        || !progress(static_cast<qint64>(header.sections[GeneIdsSection]))) {
+        return false;
+    }
+
+    // the columns, the indexes and the cut-offs are copied as they are
+    copySection(sections[GeneIdsSection], num_features, store.m_geneIds);
+    copySection(sections[SpotIdsSection], num_features, store.m_spotIds);
+    copySection(sections[CountsSection], num_features, store.m_counts);
+    copySection(sections[SpotOffsetsSection], spots + 1, store.m_spotOffsets);
+    copySection(sections[SpotFeaturesSection], num_features, store.m_spotFeatures);
+    copySection(sections[GeneOffsetsSection], genes + 1, store.m_geneOffsets);
+    copySection(sections[GeneFeaturesSection], num_features, store.m_geneFeatures);
+    copySection(sections[GeneCutoffsSection], genes, store.m_geneCutoffs);
+    if (!progress(static_cast<qint64>(header.sections[GeneCutoffsSection]))) {
+        return false;
+    }
+
+    // the ids and indexes are used to access the columns so they are
+    // validated once here
+    if (!validIndexes(store.m_geneIds, genes) || !validIndexes(store.m_spotIds, spots)
+        || !validOffsets(store.m_spotOffsets.constData(), spots, num_features)
+        || !validOffsets(store.m_geneOffsets.constData(), genes, num_features)
+        || !validIndexes(store.m_spotFeatures, num_features)
+        || !validIndexes(store.m_geneFeatures, num_features) || !progress(size)) {
+        return false;
+    }
+
+    features = store;
+    return true;
+}
+
+bool DatasetSnapshot::write(const QString &filename,
+                            const QString &datasetId,
+                            const QString &lastModified,
+                            const FeatureStore &features)
+{
+    Q_ASSERT(features.hasIndexes() && features.hasGeneCutoffs());
+    const QByteArray snapshot_key = key(datasetId, lastModified);
+    QByteArray names;
+    QVector<quint32> namesOffsets(1, 0);
+    for (const QString &name : features.geneNames()) {
+        names.append(name.toUtf8());
+        namesOffsets.push_back(static_cast<quint32>(names.size()));
+    }
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(FileHeader));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.version = VERSION;
+    header.genes = static_cast<quint32>(features.genesCount());
+    header.spots = static_cast<quint32>(features.spotsCount());
+    header.features = static_cast<quint32>(features.size());
+    header.keySize = static_cast<quint64>(snapshot_key.size());
+    header.namesSize = static_cast<quint64>(names.size());
+
+    const char *sections[SectionsCount]
+        = {snapshot_key.constData(),
+           reinterpret_cast<const char *>(namesOffsets.constData()),
+           names.constData(),
+           reinterpret_cast<const char *>(features.spotsX().constData()),
+           reinterpret_cast<const char *>(features.spotsY().constData()),
+           reinterpret_cast<const char *>(features.geneIds().constData()),
+           reinterpret_cast<const char *>(features.spotIds().constData()),
+           reinterpret_cast<const char *>(features.counts().constData()),
+           reinterpret_cast<const char *>(features.spotOffsets().constData()),
+           reinterpret_cast<const char *>(features.spotFeatures().constData()),
+           reinterpret_cast<const char *>(features.geneOffsets().constData()),
+           reinterpret_cast<const char *>(features.geneFeatures().constData()),
+           reinterpret_cast<const char *>(features.geneCutoffs().constData())};
+    quint64 sizes[SectionsCount];
+    sectionSizes(header, sizes);
+    quint64 offset = sizeof(FileHeader);
+    for (int i = 0; i < SectionsCount; ++i) {
+        offset = alignSection(offset);
+        header.sections[i] = offset;
+        offset += sizes[i];
+    }
+
+    // the file is written to a temporary file which replaces the snapshot
+    // once it is complete
+    QDir().mkpath(QFileInfo(filename).absolutePath());
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Error creating dataset snapshot" << filename;
+        return false;
+    }
+    bool writtenOk
+        = file.write(reinterpret_cast<const char *>(&header), sizeof(FileHeader))
+          == static_cast<qint64>(sizeof(FileHeader));
+    const QByteArray padding(8, '\0');
+    for (int i = 0; i < SectionsCount && writtenOk; ++i) {
+        const qint64 padding_size = static_cast<qint64>(header.sections[i]) - file.pos();
+        writtenOk = file.write(padding.constData(), padding_size) == padding_size
+                    && file.write(sections[i], static_cast<qint64>(sizes[i]))
+                           == static_cast<qint64>(sizes[i]);
+    }
+    if (!writtenOk) {
+        file.cancelWriting();
+    }
+    return file.commit() && writtenOk;
+}
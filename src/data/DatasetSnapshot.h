@@ -0,0 +1,80 @@
+#ifndef DATASETSNAPSHOT_H
+#define DATASETSNAPSHOT_H
+
+#include <QString>
+#include <QByteArray>
+
+#include "dataModel/FeatureStore.h"
+#include "data/FeaturesParser.h"
+
+// DatasetSnapshot stores on disk the parsed features of the datasets that
+// have been opened (one file per dataset) so opening them again does not need
+// to parse the features, build their look up indexes and compute the genes
+// cut-offs. The snapshot is memory mapped and its columns are copied straight
+// into the feature store.
+// A snapshot is keyed by the dataset id and its last modification time so it
+// is discarded (and removed) when the dataset is modified in the server.
+//
+// The format (version 1, native byte order) contains a fixed size header
+// followed by 8 bytes aligned sections:
+// - header: magic, byte order mark, version, number of genes, spots and
+//   features and the sizes of the key and the gene names
+// - key: UTF-8 dataset id and last modification time
+// - gene dictionary: offsets (genes + 1) into a blob of UTF-8 gene names
+// - spots: x and y coordinates (one column each)
+// - features: gene id, spot id and count columns
+// - look up indexes: CSR features by spot and by gene (offsets and features)
+// - genes cut-offs
+class DatasetSnapshot
+{
+
+public:
+    // the snapshots are stored in the given directory
+    explicit DatasetSnapshot(const QString &directory);
+    ~DatasetSnapshot();
+
+    // the name of the snapshot file of the dataset
+    const QString fileName(const QString &datasetId) const;
+
+    // returns true if there is a snapshot of the dataset for the given last
+    // modification time (only the header and the key of the file are read)
+    bool contains(const QString &datasetId, const QString &lastModified) const;
+    // reads the snapshot of the dataset, the features get the look up indexes
+    // and the genes cut-offs of the snapshot
+    // an optional call back can be given to track (bytes of the file read
+    // so far) and cancel the reading
+    // snapshots that are outdated (lastModified is different) or not valid
+    // are removed
+    // returns true if a valid snapshot was read (false if it was cancelled)
+    bool read(const QString &datasetId,
+              const QString &lastModified,
+              FeatureStore &features,
+              const data::ParseProgressCallback &progress = data::ParseProgressCallback()) const;
+    // removes the snapshot of the dataset (if any)
+    void remove(const QString &datasetId) const;
+    // removes all the snapshots
+    void clear() const;
+
+    // writes the snapshot of the features (the look up indexes and the genes
+    // cut-offs must be computed), the file is replaced atomically so it can
+    // be called from a worker thread while the snapshot is read
+    // returns true if the file was written correctly
+    static bool write(const QString &filename,
+                      const QString &datasetId,
+                      const QString &lastModified,
+                      const FeatureStore &features);
+
+private:
+    // the key identifying the content of the snapshot
+    static QByteArray key(const QString &datasetId, const QString &lastModified);
+    // validates the mapped snapshot and copies its content into features
+    static bool load(const uchar *data,
+                     const qint64 size,
+                     const QByteArray &key,
+                     FeatureStore &features,
+                     const data::ParseProgressCallback &progress);
+
+    QString m_directory;
+};
+
+#endif // DATASETSNAPSHOT_H
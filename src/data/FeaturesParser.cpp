@@ -0,0 +1,576 @@
+#include "data/FeaturesParser.h"
+
+#include <QDebug>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <QAtomicInt>
+#include <QMutexLocker>
+#include <QtConcurrent>
+
+#include "dataModel/FeatureStore.h"
+#include "rapidjson/reader.h"
+
+#include <cstring>
+
+using namespace rapidjson;
+
+namespace
+{
+
+// number of features parsed between two calls to the progress call back
+static const int PROGRESS_INTERVAL = 16384;
+// minimum size (bytes) of a chunk when the number of chunks is automatic
+static const int MIN_CHUNK_SIZE = 1 << 20;
+
+// true if the key given by rapidjson (not null terminated) is equal to key
+template <std::size_t N>
+inline bool keyEquals(const char *str, const SizeType length, const char (&key)[N])
+{
+    return length == N - 1 && std::memcmp(str, key, N - 1) == 0;
+}
+
+// Handler with call backs for rapidjson
+// explicitly made to parse the Features JSON type object.
+// References to the containers are passed and will be filled up
+// with the parsed objects.
+// The keys of the feature object are matched directly on the raw
+// characters and the values are stored in typed members so no QVariant
+// or DTO is created for each feature.
+class FeaturesHandler
+{
+
+public:
+    explicit FeaturesHandler(FeatureStore &features)
+        : m_features(features)
+        , m_checkpoint()
+        , m_parsed(0)
+        , m_currentKey(UnknownKey)
+        , m_geneId(Feature::INVALID_GENE_ID)
+        , m_count(0)
+        , m_x(0)
+        , m_y(0)
+    {
+    }
+
+    // the check point is invoked every PROGRESS_INTERVAL features
+    // the parsing is aborted if it returns false
+    void setCheckpoint(const std::function<bool()> &checkpoint) { m_checkpoint = checkpoint; }
+
+    bool Null() { return false; }
+    bool Bool(bool) { return false; }
+
+    bool Int(int i)
+    {
+        setNumber(i, static_cast<double>(i));
+        return true;
+    }
+
+    bool Uint(unsigned u)
+    {
+        setNumber(static_cast<int>(u), static_cast<double>(u));
+        return true;
+    }
+
+    bool Int64(int64_t i)
+    {
+        setNumber(static_cast<int>(i), static_cast<double>(i));
+        return true;
+    }
+
+    bool Uint64(uint64_t u)
+    {
+        setNumber(static_cast<int>(u), static_cast<double>(u));
+        return true;
+    }
+
+    bool Double(double d)
+    {
+        // decimal counts are rounded (same behaviour as QVariant conversions)
+        setNumber(qRound(d), d);
+        return true;
+    }
+
+    bool RawNumber(const char *, SizeType, bool) { return true; }
+
+    bool String(const char *str, SizeType length, bool)
+    {
+        switch (m_currentKey) {
+        case GeneKey:
+            internGene(str, length);
+            break;
+        case HitsKey:
+            m_count = QString::fromUtf8(str, static_cast<int>(length)).toInt();
+            break;
+        case XKey:
+            m_x = QString::fromUtf8(str, static_cast<int>(length)).toFloat();
+            break;
+        case YKey:
+            m_y = QString::fromUtf8(str, static_cast<int>(length)).toFloat();
+            break;
+        case UnknownKey:
+        default:
+            break;
+        }
+        return true;
+    }
+
+    bool StartObject()
+    {
+        m_currentKey = UnknownKey;
+        m_geneId = Feature::INVALID_GENE_ID;
+        m_count = 0;
+        m_x = 0;
+        m_y = 0;
+        return true;
+    }
+
+    bool Key(const char *str, SizeType length, bool)
+    {
+        if (keyEquals(str, length, "gene")) {
+            m_currentKey = GeneKey;
+        } else if (keyEquals(str, length, "hits")) {
+            m_currentKey = HitsKey;
+        } else if (keyEquals(str, length, "x")) {
+            m_currentKey = XKey;
+        } else if (keyEquals(str, length, "y")) {
+            m_currentKey = YKey;
+        } else {
+            m_currentKey = UnknownKey;
+        }
+        return true;
+    }
+
+    bool EndObject(SizeType)
+    {
+        // a feature without gene is not valid
+        if (m_geneId == Feature::INVALID_GENE_ID) {
+            return false;
+        }
+        m_features.addFeature(m_geneId, m_features.addSpot(m_x, m_y), m_count);
+        if (m_checkpoint && ++m_parsed % PROGRESS_INTERVAL == 0) {
+            return m_checkpoint();
+        }
+        return true;
+    }
+
+    bool StartArray() { return true; }
+    bool EndArray(SizeType) { return true; }
+
+private:
+    enum FeatureKey { UnknownKey, GeneKey, HitsKey, XKey, YKey };
+
+    // assigns a numeric value to the current key
+    void setNumber(const int i, const double d)
+    {
+        switch (m_currentKey) {
+        case GeneKey:
+            internGene(QString::number(d));
+            break;
+        case HitsKey:
+            m_count = i;
+            break;
+        case XKey:
+            m_x = static_cast<float>(d);
+            break;
+        case YKey:
+            m_y = static_cast<float>(d);
+            break;
+        case UnknownKey:
+        default:
+            break;
+        }
+    }
+
+    void internGene(const char *str, const SizeType length)
+    {
+        internGene(QString::fromUtf8(str, static_cast<int>(length)));
+    }
+
+    // sets the current gene id (the gene is added to the store the first
+    // time the name is seen, ids are given in order of appearance)
+    void internGene(const QString &gene_name) { m_geneId = m_features.addGene(gene_name); }
+
+    FeatureStore &m_features;
+    std::function<bool()> m_checkpoint;
+    int m_parsed;
+    // state of the feature being parsed
+    FeatureKey m_currentKey;
+    quint32 m_geneId;
+    int m_count;
+    float m_x;
+    float m_y;
+};
+
+// state shared by the chunks of a parallel parsing
+struct ChunksState {
+    explicit ChunksState(const data::ParseProgressCallback &progress)
+        : progress(progress)
+        , bytesParsed(0)
+        , cancelled(0)
+    {
+    }
+
+    // adds the bytes parsed by a chunk, returns false if the parsing was cancelled
+    bool report(const int bytes)
+    {
+        const int total = bytesParsed.fetchAndAddOrdered(bytes) + bytes;
+        if (progress && !progress(total)) {
+            cancelled.store(1);
+        }
+        return cancelled.load() == 0;
+    }
+
+    const data::ParseProgressCallback &progress;
+    QAtomicInt bytesParsed;
+    QAtomicInt cancelled;
+};
+
+// a chunk of the raw data [begin, end) with its own output containers
+// the first chunk starts after the opening bracket and the last one
+// contains the closing bracket, the rest start at the beginning of an object
+struct FeaturesChunk {
+    FeaturesChunk()
+        : data(nullptr)
+        , begin(0)
+        , end(0)
+        , last(false)
+        , state(nullptr)
+        , parsedOk(false)
+    {
+    }
+
+    const char *data;
+    int begin;
+    int end;
+    bool last;
+    ChunksState *state;
+    FeatureStore features;
+    bool parsedOk;
+};
+
+inline bool isWhitespace(const char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// returns the position of the first object starting at or after pos
+// objects are separated by "}," (with optional whitespaces) and the position
+// returned is the one of the opening brace. Returns -1 if none was found
+// NOTE braces inside strings could give a wrong boundary, in that case the
+// parsing of the chunks fails and the data is parsed in one piece
+int nextObjectBoundary(const QByteArray &rawData, int pos)
+{
+    const char *data = rawData.constData();
+    const int size = rawData.size();
+    while (pos < size) {
+        const char *close = static_cast<const char *>(
+            std::memchr(data + pos, '}', static_cast<std::size_t>(size - pos)));
+        if (close == nullptr) {
+            return -1;
+        }
+        int i = static_cast<int>(close - data) + 1;
+        while (i < size && isWhitespace(data[i])) {
+            ++i;
+        }
+        if (i < size && data[i] == ',') {
+            ++i;
+            while (i < size && isWhitespace(data[i])) {
+                ++i;
+            }
+            if (i < size && data[i] == '{') {
+                return i;
+            }
+        }
+        pos = static_cast<int>(close - data) + 1;
+    }
+    return -1;
+}
+
+// parses the objects of a chunk (run in a worker thread)
+// the chunk must be a sequence of objects separated by commas ending with
+// a comma (or the closing bracket for the last chunk)
+void parseChunk(FeaturesChunk &chunk)
+{
+    FeaturesHandler handler(chunk.features);
+    StringStream is(chunk.data + chunk.begin);
+    const std::size_t length = static_cast<std::size_t>(chunk.end - chunk.begin);
+    std::size_t reported = 0;
+    handler.setCheckpoint([&]() {
+        const std::size_t parsed = is.Tell();
+        const bool keepParsing = chunk.state->report(static_cast<int>(parsed - reported));
+        reported = parsed;
+        return keepParsing;
+    });
+
+    Reader reader;
+    bool parsedOk = false;
+    bool expectObject = true;
+    bool empty = true;
+    while (true) {
+        SkipWhitespace(is);
+        if (is.Tell() >= length) {
+            // the chunks end after a comma except the last one
+            parsedOk = !chunk.last && expectObject && !empty;
+            break;
+        }
+        const char c = is.Peek();
+        if (c == ']') {
+            if (expectObject && !empty) {
+                break;
+            }
+            is.Take();
+            SkipWhitespace(is);
+            parsedOk = chunk.last && is.Peek() == '\0';
+            break;
+        }
+        if (expectObject) {
+            if (c != '{' || !reader.Parse<kParseStopWhenDoneFlag>(is, handler)
+                || is.Tell() > length) {
+                break;
+            }
+            expectObject = false;
+            empty = false;
+        } else {
+            if (c != ',') {
+                break;
+            }
+            is.Take();
+            expectObject = true;
+        }
+    }
+    chunk.state->report(static_cast<int>(is.Tell() - reported));
+    chunk.parsedOk = parsedOk;
+}
+
+}
+
+namespace data
+{
+
+bool parseFeatures(const QByteArray &rawData,
+                   FeatureStore &features,
+                   const ParseProgressCallback &progress)
+{
+    FeaturesHandler handler(features);
+    StringStream is(rawData.constData());
+    if (progress) {
+        handler.setCheckpoint([&]() { return progress(static_cast<qint64>(is.Tell())); });
+    }
+    Reader reader;
+    const bool parsedOk = reader.Parse(is, handler);
+    if (parsedOk && progress) {
+        progress(rawData.size());
+    }
+    return parsedOk;
+}
+
+bool parseFeaturesParallel(const QByteArray &rawData,
+                           FeatureStore &features,
+                           const ParseProgressCallback &progress,
+                           const int chunks)
+{
+    int numChunks = chunks;
+    if (numChunks <= 0) {
+        numChunks = qMin(QThread::idealThreadCount(), rawData.size() / MIN_CHUNK_SIZE);
+    }
+
+    // the features are a flat array of objects
+    int begin = 0;
+    while (begin < rawData.size() && isWhitespace(rawData.at(begin))) {
+        ++begin;
+    }
+    if (numChunks <= 1 || begin == rawData.size() || rawData.at(begin) != '[') {
+        return parseFeatures(rawData, features, progress);
+    }
+    ++begin;
+
+    // split the array in chunks of similar size at object boundaries
+    ChunksState state(progress);
+    QVector<FeaturesChunk> featuresChunks;
+    const int chunkSize = (rawData.size() - begin) / numChunks;
+    while (begin < rawData.size()) {
+        int end = nextObjectBoundary(rawData, begin + chunkSize);
+        if (featuresChunks.size() == numChunks - 1 || end == -1) {
+            end = rawData.size();
+        }
+        FeaturesChunk chunk;
+        chunk.data = rawData.constData();
+        chunk.begin = begin;
+        chunk.end = end;
+        chunk.last = end == rawData.size();
+        chunk.state = &state;
+        featuresChunks.push_back(chunk);
+        begin = end;
+    }
+
+    QtConcurrent::blockingMap(featuresChunks, parseChunk);
+
+    if (state.cancelled.load() != 0) {
+        return false;
+    }
+    for (const FeaturesChunk &chunk : featuresChunks) {
+        if (!chunk.parsedOk) {
+            // a wrong boundary or a malformed input, the single threaded
+            // parsing gives the right result (or error)
+            qDebug() << "Error parsing the features in chunks, parsing them in one piece";
+            return parseFeatures(rawData, features, progress);
+        }
+    }
+
+    // merge the chunks in order, the genes and spots of each chunk are
+    // added in order of appearance so the ids are the same ones the single
+    // threaded parsing would give
+    int numFeatures = features.size();
+    for (const FeaturesChunk &chunk : featuresChunks) {
+        numFeatures += chunk.features.size();
+    }
+    features.reserve(numFeatures);
+    for (FeaturesChunk &chunk : featuresChunks) {
+        features.append(chunk.features);
+        chunk.features.clear();
+    }
+    if (progress) {
+        progress(rawData.size());
+    }
+    return true;
+}
+
+// rapidjson (read only) input stream that reads the chunks of the features
+// stream one after the other, the current chunk is released once it is read
+class FeaturesStream::InputStream
+{
+
+public:
+    typedef char Ch;
+
+    explicit InputStream(FeaturesStream &stream)
+        : m_stream(stream)
+        , m_chunk()
+        , m_data(nullptr)
+        , m_size(0)
+        , m_pos(0)
+        , m_consumed(0)
+    {
+        nextChunk();
+    }
+
+    Ch Peek() const { return m_pos < m_size ? m_data[m_pos] : '\0'; }
+
+    Ch Take()
+    {
+        if (m_pos >= m_size) {
+            return '\0';
+        }
+        const Ch c = m_data[m_pos++];
+        if (m_pos == m_size) {
+            nextChunk();
+        }
+        return c;
+    }
+
+    std::size_t Tell() const { return m_consumed + static_cast<std::size_t>(m_pos); }
+
+    Ch *PutBegin()
+    {
+        RAPIDJSON_ASSERT(false);
+        return 0;
+    }
+    void Put(Ch) { RAPIDJSON_ASSERT(false); }
+    void Flush() { RAPIDJSON_ASSERT(false); }
+    std::size_t PutEnd(Ch *)
+    {
+        RAPIDJSON_ASSERT(false);
+        return 0;
+    }
+
+private:
+    void nextChunk()
+    {
+        m_consumed += static_cast<std::size_t>(m_size);
+        m_chunk = m_stream.takeChunk();
+        m_data = m_chunk.constData();
+        m_size = m_chunk.size();
+        m_pos = 0;
+    }
+
+    FeaturesStream &m_stream;
+    QByteArray m_chunk;
+    const Ch *m_data;
+    int m_size;
+    int m_pos;
+    std::size_t m_consumed;
+};
+
+FeaturesStream::FeaturesStream()
+    : m_mutex()
+    , m_dataAdded()
+    , m_chunks()
+    , m_finished(false)
+    , m_cancelled(false)
+    , m_parsed(false)
+{
+}
+
+FeaturesStream::~FeaturesStream()
+{
+}
+
+void FeaturesStream::addData(const QByteArray &rawData)
+{
+    QMutexLocker locker(&m_mutex);
+    // the data is dropped if the parsing is over (error or cancelled)
+    if (rawData.isEmpty() || m_finished || m_parsed) {
+        return;
+    }
+    m_chunks.enqueue(rawData);
+    m_dataAdded.wakeAll();
+}
+
+void FeaturesStream::finish()
+{
+    QMutexLocker locker(&m_mutex);
+    m_finished = true;
+    m_dataAdded.wakeAll();
+}
+
+void FeaturesStream::cancel()
+{
+    QMutexLocker locker(&m_mutex);
+    m_cancelled = true;
+    m_chunks.clear();
+    m_dataAdded.wakeAll();
+}
+
+QByteArray FeaturesStream::takeChunk()
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_chunks.isEmpty() && !m_finished && !m_cancelled) {
+        m_dataAdded.wait(&m_mutex);
+    }
+    return m_chunks.isEmpty() ? QByteArray() : m_chunks.dequeue();
+}
+
+bool FeaturesStream::parse(FeatureStore &features, const ParseProgressCallback &progress)
+{
+    FeaturesHandler handler(features);
+    InputStream is(*this);
+    if (progress) {
+        handler.setCheckpoint([&]() { return progress(static_cast<qint64>(is.Tell())); });
+    }
+    Reader reader;
+    bool parsedOk = reader.Parse(is, handler);
+
+    QMutexLocker locker(&m_mutex);
+    // the stream could have been cancelled once all the data was consumed
+    parsedOk &= !m_cancelled;
+    m_parsed = true;
+    m_chunks.clear();
+    locker.unlock();
+
+    if (parsedOk && progress) {
+        progress(static_cast<qint64>(is.Tell()));
+    }
+    return parsedOk;
+}
+}
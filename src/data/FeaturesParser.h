@@ -0,0 +1,91 @@
+#ifndef FEATURESPARSER_H
+#define FEATURESPARSER_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
+
+#include <functional>
+
+#include "dataModel/FeatureStore.h"
+
+// The features parser converts the raw JSON features data (a flat array of
+// gene-spot objects) into a FeatureStore.
+// The parsing is done with a SAX based handler (rapidjson) that recognises
+// the keys of a feature object (gene, hits, x, y) and writes the values
+// straight into the feature store columns, avoiding intermediary QVariant/DTO
+// objects which are too expensive for datasets with millions of features.
+
+namespace data
+{
+
+// call back invoked periodically during the parsing with the number of bytes
+// parsed so far. The parsing is cancelled if the call back returns false
+typedef std::function<bool(qint64)> ParseProgressCallback;
+
+// parses the features in rawData and appends them to features
+// (new genes and spots get the next free ids in order of appearance)
+// an optional call back can be given to track and cancel the parsing
+// returns true if the parsing was correct (false if it failed or was cancelled)
+bool parseFeatures(const QByteArray &rawData,
+                   FeatureStore &features,
+                   const ParseProgressCallback &progress = ParseProgressCallback());
+
+// parses the features like parseFeatures() but the raw data is split in
+// chunks at object boundaries which are parsed concurrently. The chunks are
+// merged in order so the output is identical to parseFeatures()
+// chunks is the number of chunks to use (0 = one per core for big inputs)
+// NOTE the progress call back can be invoked from several threads
+bool parseFeaturesParallel(const QByteArray &rawData,
+                           FeatureStore &features,
+                           const ParseProgressCallback &progress = ParseProgressCallback(),
+                           const int chunks = 0);
+
+// FeaturesStream parses the features while the raw data is being received
+// (for instance from a network reply) so the parsing overlaps the transfer.
+// The chunks of raw data are added with addData() from one thread and parse()
+// consumes them from a worker thread, blocking when it runs out of data.
+// The chunks are released as soon as they are parsed so the whole raw data
+// is never held in memory together with the parsed features.
+class FeaturesStream
+{
+
+public:
+    FeaturesStream();
+    ~FeaturesStream();
+
+    // appends a chunk of raw data to the stream (thread safe)
+    void addData(const QByteArray &rawData);
+    // no more data will be added, parse() will end once the data is consumed
+    void finish();
+    // stops the parsing (parse() will return false)
+    void cancel();
+
+    // parses the features of the stream as they are added (see parseFeatures())
+    // blocks until finish() or cancel() are called so it must not be called
+    // from the thread that adds the data
+    // returns true if the parsing was correct (false if it failed or was cancelled)
+    bool parse(FeatureStore &features,
+               const ParseProgressCallback &progress = ParseProgressCallback());
+
+private:
+    // rapidjson input stream over the chunks
+    class InputStream;
+
+    // returns the next chunk of data, blocking until there is one
+    // returns an empty chunk at the end of the stream or if it was cancelled
+    QByteArray takeChunk();
+
+    QMutex m_mutex;
+    QWaitCondition m_dataAdded;
+    QQueue<QByteArray> m_chunks;
+    bool m_finished;
+    bool m_cancelled;
+    bool m_parsed;
+
+    Q_DISABLE_COPY(FeaturesStream)
+};
+}
+
+#endif // FEATURESPARSER_H
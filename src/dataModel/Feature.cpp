@@ -2,14 +2,16 @@
 
 Feature::Feature()
     : m_gene()
+    , m_geneId(INVALID_GENE_ID)
     , m_count(0)
     , m_x(0)
     , m_y(0)
 {
 }
 
-Feature::Feature(const QString &gene, float x, float y, int count)
+Feature::Feature(const QString &gene, float x, float y, int count, quint32 geneId)
     : m_gene(gene)
+    , m_geneId(geneId)
     , m_count(count)
     , m_x(x)
     , m_y(y)
@@ -19,6 +21,7 @@ Feature::Feature(const QString &gene, float x, float y, int count)
 Feature::Feature(const Feature &other)
 {
     m_gene = other.m_gene;
+    m_geneId = other.m_geneId;
     m_count = other.m_count;
     m_x = other.m_x;
     m_y = other.m_y;
@@ -31,6 +34,7 @@ Feature::~Feature()
 Feature &Feature::operator=(const Feature &other)
 {
     m_gene = other.m_gene;
+    m_geneId = other.m_geneId;
     m_count = other.m_count;
     m_x = other.m_x;
     m_y = other.m_y;
@@ -48,6 +52,11 @@ const QString Feature::gene() const
     return m_gene;
 }
 
+quint32 Feature::geneId() const
+{
+    return m_geneId;
+}
+
 int Feature::count() const
 {
     return m_count;
@@ -73,6 +82,11 @@ void Feature::gene(const QString &gene)
     m_gene = gene;
 }
 
+void Feature::geneId(quint32 geneId)
+{
+    m_geneId = geneId;
+}
+
 void Feature::count(int count)
 {
     m_count = count;
@@ -23,15 +23,24 @@ public:
     typedef QHash<Feature::SpotType, int> spotTotalCounts;
     typedef QHash<QString, int> geneTotalCounts;
 
+    // id of a feature whose gene is not in a dataset gene dictionary
+    static const quint32 INVALID_GENE_ID = 0xFFFFFFFF;
+
     Feature();
     explicit Feature(const Feature &other);
-    Feature(const QString &gene, float x, float y, int count);
+    Feature(const QString &gene,
+            float x,
+            float y,
+            int count,
+            quint32 geneId = INVALID_GENE_ID);
     ~Feature();
 
     Feature &operator=(const Feature &other);
     bool operator==(const Feature &other) const;
 
     const QString gene() const;
+    // the index of the gene in the dataset gene dictionary (see DataProxy::getGene())
+    quint32 geneId() const;
     // count represents the expression level
     int count() const;
     float x() const;
@@ -40,6 +49,7 @@ public:
     SpotType spot() const;
 
     void gene(const QString &gene);
+    void geneId(quint32 geneId);
     void count(int count);
     void x(float x);
     void y(float y);
@@ -47,6 +57,7 @@ public:
 protected:
     // basic attributes
     QString m_gene;
+    quint32 m_geneId;
     int m_count;
     float m_x;
     float m_y;
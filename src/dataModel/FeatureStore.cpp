@@ -0,0 +1,363 @@
+#include "dataModel/FeatureStore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+
+// key of a spot in the spots look up (the bits of both coordinates)
+quint64 spotKey(const float x, const float y)
+{
+    // adding zero turns -0 into 0 so both give the same spot
+    const float coordinates[2] = {x + 0.0f, y + 0.0f};
+    quint64 key;
+    static_assert(sizeof(key) == sizeof(coordinates), "unexpected float size");
+    std::memcpy(&key, coordinates, sizeof(key));
+    return key;
+}
+}
+
+FeatureStore::FeatureStore()
+{
+}
+
+FeatureStore::~FeatureStore()
+{
+}
+
+bool FeatureStore::operator==(const FeatureStore &other) const
+{
+    return (m_geneIds == other.m_geneIds && m_spotIds == other.m_spotIds
+            && m_counts == other.m_counts && m_geneNames == other.m_geneNames
+            && m_spotsX == other.m_spotsX && m_spotsY == other.m_spotsY);
+}
+
+void FeatureStore::clear()
+{
+    m_geneIds.clear();
+    m_spotIds.clear();
+    m_counts.clear();
+    m_geneNames.clear();
+    m_spotsX.clear();
+    m_spotsY.clear();
+    m_geneIdByName.clear();
+    m_spotIdByCoordinates.clear();
+    m_spotOffsets.clear();
+    m_spotFeatures.clear();
+    m_geneOffsets.clear();
+    m_geneFeatures.clear();
+    m_geneCutoffs.clear();
+}
+
+void FeatureStore::reserve(const int features)
+{
+    m_geneIds.reserve(features);
+    m_spotIds.reserve(features);
+    m_counts.reserve(features);
+}
+
+int FeatureStore::size() const
+{
+    return m_counts.size();
+}
+
+bool FeatureStore::isEmpty() const
+{
+    return m_counts.isEmpty();
+}
+
+int FeatureStore::genesCount() const
+{
+    return m_geneNames.size();
+}
+
+int FeatureStore::spotsCount() const
+{
+    return m_spotsX.size();
+}
+
+quint32 FeatureStore::addGene(const QString &name)
+{
+    auto it = m_geneIdByName.find(name);
+    if (it == m_geneIdByName.end()) {
+        it = m_geneIdByName.insert(name, static_cast<quint32>(m_geneNames.size()));
+        // the table shares the string data of the look up
+        m_geneNames.push_back(it.key());
+    }
+    return it.value();
+}
+
+quint32 FeatureStore::addSpot(const float x, const float y)
+{
+    const quint64 key = spotKey(x, y);
+    auto it = m_spotIdByCoordinates.find(key);
+    if (it == m_spotIdByCoordinates.end()) {
+        it = m_spotIdByCoordinates.insert(key, static_cast<quint32>(m_spotsX.size()));
+        m_spotsX.push_back(x);
+        m_spotsY.push_back(y);
+    }
+    return it.value();
+}
+
+void FeatureStore::addFeature(const quint32 geneId, const quint32 spotId, const int count)
+{
+    Q_ASSERT(geneId < static_cast<quint32>(m_geneNames.size()));
+    Q_ASSERT(spotId < static_cast<quint32>(m_spotsX.size()));
+    m_geneIds.push_back(geneId);
+    m_spotIds.push_back(spotId);
+    m_counts.push_back(count);
+}
+
+void FeatureStore::addFeature(const QString &gene, const float x, const float y, const int count)
+{
+    addFeature(addGene(gene), addSpot(x, y), count);
+}
+
+void FeatureStore::append(const FeatureStore &other)
+{
+    // the genes and spots are added in order of id so the ids of other are
+    // the same ones it would have if its features were added one by one
+    QVector<quint32> geneIds(other.genesCount());
+    for (int i = 0; i < other.genesCount(); ++i) {
+        geneIds[i] = addGene(other.m_geneNames.at(i));
+    }
+    QVector<quint32> spotIds(other.spotsCount());
+    for (int i = 0; i < other.spotsCount(); ++i) {
+        spotIds[i] = addSpot(other.m_spotsX.at(i), other.m_spotsY.at(i));
+    }
+    reserve(size() + other.size());
+    for (int i = 0; i < other.size(); ++i) {
+        m_geneIds.push_back(geneIds.at(static_cast<int>(other.m_geneIds.at(i))));
+        m_spotIds.push_back(spotIds.at(static_cast<int>(other.m_spotIds.at(i))));
+    }
+    m_counts.append(other.m_counts);
+}
+
+FeatureStore::FeatureRef FeatureStore::at(const int index) const
+{
+    Q_ASSERT(index >= 0 && index < size());
+    return FeatureRef(this, index);
+}
+
+FeatureStore::const_iterator FeatureStore::begin() const
+{
+    return const_iterator(this, 0);
+}
+
+FeatureStore::const_iterator FeatureStore::end() const
+{
+    return const_iterator(this, size());
+}
+
+const QString &FeatureStore::geneName(const quint32 geneId) const
+{
+    return m_geneNames.at(static_cast<int>(geneId));
+}
+
+const QVector<quint32> &FeatureStore::geneIds() const
+{
+    return m_geneIds;
+}
+
+const QVector<quint32> &FeatureStore::spotIds() const
+{
+    return m_spotIds;
+}
+
+const QVector<int> &FeatureStore::counts() const
+{
+    return m_counts;
+}
+
+const QVector<QString> &FeatureStore::geneNames() const
+{
+    return m_geneNames;
+}
+
+const QVector<float> &FeatureStore::spotsX() const
+{
+    return m_spotsX;
+}
+
+const QVector<float> &FeatureStore::spotsY() const
+{
+    return m_spotsY;
+}
+
+bool FeatureStore::sameGenes(const FeatureStore &other) const
+{
+    // shared tables are compared without looking at the names
+    return m_geneNames == other.m_geneNames;
+}
+
+void FeatureStore::buildIndexes()
+{
+    buildIndex(m_spotIds, spotsCount(), m_spotOffsets, m_spotFeatures);
+    buildIndex(m_geneIds, genesCount(), m_geneOffsets, m_geneFeatures);
+}
+
+bool FeatureStore::hasIndexes() const
+{
+    return m_spotOffsets.size() == spotsCount() + 1 && m_spotFeatures.size() == size()
+           && m_geneOffsets.size() == genesCount() + 1 && m_geneFeatures.size() == size();
+}
+
+const QVector<int> &FeatureStore::spotOffsets() const
+{
+    return m_spotOffsets;
+}
+
+const QVector<int> &FeatureStore::spotFeatures() const
+{
+    return m_spotFeatures;
+}
+
+const QVector<int> &FeatureStore::geneOffsets() const
+{
+    return m_geneOffsets;
+}
+
+const QVector<int> &FeatureStore::geneFeatures() const
+{
+    return m_geneFeatures;
+}
+
+void FeatureStore::computeGeneCutoffs()
+{
+    Q_ASSERT(hasIndexes());
+    const int minseglen = 2;
+    m_geneCutoffs.fill(1, genesCount());
+    for (int geneId = 0; geneId < genesCount(); ++geneId) {
+        // get all the counts of the spots that contain that gene
+        std::vector<int> counts;
+        counts.reserve(m_geneOffsets.at(geneId + 1) - m_geneOffsets.at(geneId));
+        for (int i = m_geneOffsets.at(geneId); i < m_geneOffsets.at(geneId + 1); ++i) {
+            counts.push_back(m_counts.at(m_geneFeatures.at(i)));
+        }
+        if (counts.empty()) {
+            continue;
+        }
+        const size_t num_features = counts.size();
+        // if too little counts or if all the counts are the same cut off is the min count present
+        if (num_features < minseglen + 1
+            || std::equal(counts.begin() + 1, counts.end(), counts.begin())) {
+            m_geneCutoffs[geneId] = *std::min_element(counts.begin(), counts.end());
+            continue;
+        }
+        // sort the counts and compute a list of their squared sum
+        std::sort(counts.begin(), counts.end());
+        std::vector<int> squared_summed_counts(counts);
+        std::transform(squared_summed_counts.begin(),
+                       squared_summed_counts.end(),
+                       squared_summed_counts.begin(),
+                       squared_summed_counts.begin(),
+                       std::multiplies<int>());
+        std::partial_sum(squared_summed_counts.begin(),
+                         squared_summed_counts.end(),
+                         squared_summed_counts.begin());
+        squared_summed_counts.insert(squared_summed_counts.begin(), 0);
+        // generate a vector taustar with indexes of the counts
+        std::vector<int> taustar;
+        int n = minseglen;
+        std::generate_n(std::back_inserter(taustar),
+                        num_features + minseglen - 2 - 2,
+                        [n]() mutable { return n++; });
+        std::vector<float> tmp1;
+        std::vector<float> tmp2;
+        std::vector<float> tmp3;
+        const float last_count = static_cast<float>(squared_summed_counts.back());
+        // perform tmp3 = (squared_summed_counts / last_count) - (taustar / num_counts)
+        std::transform(squared_summed_counts.begin() + 2,
+                       squared_summed_counts.end() - 1,
+                       std::back_inserter(tmp1),
+                       [=](int count) { return count / last_count; });
+        std::transform(taustar.begin(),
+                       taustar.end(),
+                       std::back_inserter(tmp2),
+                       [=](int tau_value)
+        { return tau_value / static_cast<float>(num_features); });
+        std::transform(tmp1.begin(),
+                       tmp1.end(),
+                       tmp2.begin(),
+                       std::back_inserter(tmp3),
+                       [](float a, float b) { return std::fabs(a - b); });
+        // tau is the distance to the max element in tmp3 which is an index
+        const auto tau = std::distance(tmp3.begin(), std::max_element(tmp3.begin(), tmp3.end()));
+        // get the read count of the tau index and that is the gene cut off
+        const auto cutoff = std::upper_bound(counts.begin(), counts.end(), counts.at(tau));
+        m_geneCutoffs[geneId] = cutoff != counts.end() ? *cutoff : counts.back();
+    }
+}
+
+bool FeatureStore::hasGeneCutoffs() const
+{
+    return m_geneCutoffs.size() == genesCount();
+}
+
+const QVector<int> &FeatureStore::geneCutoffs() const
+{
+    return m_geneCutoffs;
+}
+
+FeatureStore FeatureStore::subset(const QVector<int> &indexes) const
+{
+    FeatureStore store;
+    store.m_geneNames = m_geneNames;
+    store.m_geneIdByName = m_geneIdByName;
+    store.m_spotsX = m_spotsX;
+    store.m_spotsY = m_spotsY;
+    store.m_spotIdByCoordinates = m_spotIdByCoordinates;
+    store.reserve(indexes.size());
+    for (const int index : indexes) {
+        store.m_geneIds.push_back(m_geneIds.at(index));
+        store.m_spotIds.push_back(m_spotIds.at(index));
+        store.m_counts.push_back(m_counts.at(index));
+    }
+    return store;
+}
+
+qint64 FeatureStore::memorySize() const
+{
+    qint64 bytes = sizeof(FeatureStore);
+    bytes += m_geneIds.capacity() * sizeof(quint32) + m_spotIds.capacity() * sizeof(quint32)
+             + m_counts.capacity() * sizeof(int);
+    bytes += (m_spotsX.capacity() + m_spotsY.capacity()) * sizeof(float);
+    bytes += (m_spotOffsets.capacity() + m_spotFeatures.capacity() + m_geneOffsets.capacity()
+              + m_geneFeatures.capacity() + m_geneCutoffs.capacity())
+             * sizeof(int);
+    for (const QString &name : m_geneNames) {
+        bytes += sizeof(QString) + name.capacity() * sizeof(QChar);
+    }
+    // the look ups store a node per gene and spot
+    bytes += m_geneIdByName.size() * (sizeof(QString) + sizeof(quint32) + 2 * sizeof(void *));
+    bytes += m_spotIdByCoordinates.size()
+             * (sizeof(quint64) + sizeof(quint32) + 2 * sizeof(void *));
+    return bytes;
+}
+
+void FeatureStore::buildIndex(const QVector<quint32> &ids,
+                              const int idsCount,
+                              QVector<int> &offsets,
+                              QVector<int> &features)
+{
+    // counting sort of the features by id (the features of each id keep
+    // their order)
+    offsets.fill(0, idsCount + 1);
+    for (const quint32 id : ids) {
+        ++offsets[static_cast<int>(id) + 1];
+    }
+    for (int i = 0; i < idsCount; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    QVector<int> next(offsets);
+    features.resize(ids.size());
+    for (int i = 0; i < ids.size(); ++i) {
+        features[next[static_cast<int>(ids.at(i))]++] = i;
+    }
+}
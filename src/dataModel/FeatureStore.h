@@ -0,0 +1,188 @@
+#ifndef FEATURESTORE_H
+#define FEATURESTORE_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+
+#include <iterator>
+
+#include "dataModel/Feature.h"
+
+// FeatureStore stores a list of features in columns (structure of arrays)
+// instead of one heap object per feature. A feature is a row of the
+// columns gene id, spot id and count, the gene names and the spot
+// coordinates are stored once in the genes and spots tables.
+// The genes and spots are given dense ids in order of appearance.
+// The containers are implicitly shared so copies are cheap until modified.
+// Optionally, look up indexes (features of each spot and of each gene) can
+// be built once the store is filled.
+class FeatureStore
+{
+
+public:
+    // read only view of a feature of the store
+    // (valid while the store is alive and not modified)
+    class FeatureRef
+    {
+
+    public:
+        FeatureRef(const FeatureStore *store, const int index)
+            : m_store(store)
+            , m_index(index)
+        {
+        }
+
+        // the position of the feature in the store
+        int index() const { return m_index; }
+        quint32 geneId() const { return m_store->m_geneIds.at(m_index); }
+        quint32 spotId() const { return m_store->m_spotIds.at(m_index); }
+        const QString &gene() const { return m_store->geneName(geneId()); }
+        int count() const { return m_store->m_counts.at(m_index); }
+        float x() const { return m_store->m_spotsX.at(static_cast<int>(spotId())); }
+        float y() const { return m_store->m_spotsY.at(static_cast<int>(spotId())); }
+        Feature::SpotType spot() const { return Feature::SpotType(x(), y()); }
+
+    private:
+        const FeatureStore *m_store;
+        int m_index;
+    };
+
+    // forward iterator over the features of the store
+    class const_iterator
+    {
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef FeatureRef value_type;
+        typedef int difference_type;
+        typedef const FeatureRef *pointer;
+        typedef FeatureRef reference;
+
+        const_iterator(const FeatureStore *store, const int index)
+            : m_store(store)
+            , m_index(index)
+        {
+        }
+
+        FeatureRef operator*() const { return FeatureRef(m_store, m_index); }
+        const_iterator &operator++()
+        {
+            ++m_index;
+            return *this;
+        }
+        bool operator==(const const_iterator &other) const { return m_index == other.m_index; }
+        bool operator!=(const const_iterator &other) const { return m_index != other.m_index; }
+
+    private:
+        const FeatureStore *m_store;
+        int m_index;
+    };
+
+    FeatureStore();
+    ~FeatureStore();
+
+    bool operator==(const FeatureStore &other) const;
+
+    // removes all the features, genes and spots
+    void clear();
+    // reserves space for the given number of features
+    void reserve(const int features);
+
+    // number of features
+    int size() const;
+    bool isEmpty() const;
+    int genesCount() const;
+    int spotsCount() const;
+
+    // returns the id of the gene (it is added if it is not present)
+    quint32 addGene(const QString &name);
+    // returns the id of the spot (it is added if it is not present)
+    quint32 addSpot(const float x, const float y);
+    // adds a feature (the gene and the spot must be present)
+    void addFeature(const quint32 geneId, const quint32 spotId, const int count);
+    // adds a feature adding its gene and spot if they are not present
+    void addFeature(const QString &gene, const float x, const float y, const int count);
+    // appends the features of other (its genes and spots are added and the ids
+    // are remapped to the ones of this store)
+    void append(const FeatureStore &other);
+
+    // the feature at index
+    FeatureRef at(const int index) const;
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    // the name of the gene with the given id
+    const QString &geneName(const quint32 geneId) const;
+
+    // columns (one element per feature)
+    const QVector<quint32> &geneIds() const;
+    const QVector<quint32> &spotIds() const;
+    const QVector<int> &counts() const;
+    // genes table (one element per gene id)
+    const QVector<QString> &geneNames() const;
+    // spots table (one element per spot id)
+    const QVector<float> &spotsX() const;
+    const QVector<float> &spotsY() const;
+
+    // true if the gene ids of both stores refer to the same genes
+    // (for instance a store and its subsets)
+    bool sameGenes(const FeatureStore &other) const;
+
+    // builds the look up indexes (CSR), they must be built again if features
+    // are added afterwards
+    void buildIndexes();
+    bool hasIndexes() const;
+    // the indexes of the features of spot (or gene) id are the elements
+    // [offsets[id], offsets[id + 1]) of the features index
+    const QVector<int> &spotOffsets() const;
+    const QVector<int> &spotFeatures() const;
+    const QVector<int> &geneOffsets() const;
+    const QVector<int> &geneFeatures() const;
+
+    // computes the cut-off of every gene from the distribution of its counts
+    // (the look up indexes must be built), the features of a gene whose count
+    // is below its cut-off can be hidden
+    void computeGeneCutoffs();
+    bool hasGeneCutoffs() const;
+    // the cut-off of each gene (one element per gene id)
+    const QVector<int> &geneCutoffs() const;
+
+    // returns a store with the features at the given indexes (in that order)
+    // the genes and spots tables are shared so the ids do not change
+    FeatureStore subset(const QVector<int> &indexes) const;
+
+    // approximate size in bytes of the memory used by the store
+    qint64 memorySize() const;
+
+private:
+    // the snapshots are read and written straight from/to the columns
+    friend class DatasetSnapshot;
+
+    // builds a look up index (CSR) of the features by id
+    static void buildIndex(const QVector<quint32> &ids,
+                           const int idsCount,
+                           QVector<int> &offsets,
+                           QVector<int> &features);
+
+    // feature columns
+    QVector<quint32> m_geneIds;
+    QVector<quint32> m_spotIds;
+    QVector<int> m_counts;
+    // genes and spots tables
+    QVector<QString> m_geneNames;
+    QVector<float> m_spotsX;
+    QVector<float> m_spotsY;
+    // look ups to find the id of a gene or a spot
+    QHash<QString, quint32> m_geneIdByName;
+    QHash<quint64, quint32> m_spotIdByCoordinates;
+    // look up indexes
+    QVector<int> m_spotOffsets;
+    QVector<int> m_spotFeatures;
+    QVector<int> m_geneOffsets;
+    QVector<int> m_geneFeatures;
+    // statistics of the genes
+    QVector<int> m_geneCutoffs;
+};
+
+#endif // FEATURESTORE_H
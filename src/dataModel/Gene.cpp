@@ -1,7 +1,10 @@
 #include "Gene.h"
 
+#include "dataModel/Feature.h"
+
 Gene::Gene()
     : m_name()
+    , m_id(Feature::INVALID_GENE_ID)
     , m_color(Visual::DEFAULT_COLOR_GENE)
     , m_selected(false)
     , m_cutoff(1)
@@ -10,6 +13,7 @@ Gene::Gene()
 
 Gene::Gene(const Gene &other)
     : m_name(other.m_name)
+    , m_id(other.m_id)
     , m_color(other.m_color)
     , m_selected(other.m_selected)
     , m_cutoff(other.m_cutoff)
@@ -18,6 +22,7 @@ Gene::Gene(const Gene &other)
 
 Gene::Gene(const QString &name, bool selected, const QColor &color, const int cutoff)
     : m_name(name)
+    , m_id(Feature::INVALID_GENE_ID)
     , m_color(color)
     , m_selected(selected)
     , m_cutoff(cutoff)
@@ -30,6 +35,7 @@ Gene::~Gene()
 Gene &Gene::operator=(const Gene &other)
 {
     m_name = other.m_name;
+    m_id = other.m_id;
     m_selected = other.m_selected;
     m_color = other.m_color;
     m_cutoff = other.m_cutoff;
@@ -47,6 +53,11 @@ const QString Gene::name() const
     return m_name;
 }
 
+quint32 Gene::id() const
+{
+    return m_id;
+}
+
 bool Gene::selected() const
 {
     return m_selected;
@@ -67,6 +78,11 @@ void Gene::name(const QString &name)
     m_name = name;
 }
 
+void Gene::id(quint32 id)
+{
+    m_id = id;
+}
+
 void Gene::selected(bool selected)
 {
     m_selected = selected;
@@ -25,11 +25,14 @@ public:
     bool operator==(const Gene &other) const;
 
     const QString name() const;
+    // the index of the gene in the dataset gene dictionary
+    quint32 id() const;
     bool selected() const;
     const QColor color() const;
     int cut_off() const;
 
     void name(const QString &name);
+    void id(quint32 id);
     void selected(bool selected);
     void color(const QColor &color);
     // the gene cut-off is used to hide
@@ -41,6 +44,7 @@ public:
 
 private:
     QString m_name;
+    quint32 m_id;
     QColor m_color;
     bool m_selected;
     int m_cutoff;
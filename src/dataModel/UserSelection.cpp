@@ -6,6 +6,7 @@
 #include "dataModel/Feature.h"
 #include "math/Common.h"
 
+#include <algorithm>
 #include <numeric>
 #include <unordered_set>
 
@@ -112,7 +113,7 @@ const QString UserSelection::datasetId() const
     return m_datasetId;
 }
 
-const DataProxy::FeatureList UserSelection::selectedFeatures() const
+const FeatureStore UserSelection::selectedFeatures() const
 {
     return m_selectedFeatures;
 }
@@ -247,7 +248,7 @@ void UserSelection::saved(const bool saved)
     m_saved = saved;
 }
 
-void UserSelection::loadFeatures(const DataProxy::FeatureList &features)
+void UserSelection::loadFeatures(const FeatureStore &features)
 {
     m_selectedFeatures = features;
     // clear variables
@@ -257,17 +258,18 @@ void UserSelection::loadFeatures(const DataProxy::FeatureList &features)
     m_totalSpots = 0;
 
     // populate the selected genes and spots by iterating the features
-    QSet<QString> unique_genes;
-    Feature::UniqueSpotsType unique_spots;
-    for (const auto &feature : features) {
-        unique_genes.insert(feature->gene());
-        unique_spots.insert(feature->spot());
-        m_totalReads += feature->count();
+    // (the genes and spots are flagged by id)
+    QVector<bool> unique_genes(features.genesCount(), false);
+    QVector<bool> unique_spots(features.spotsCount(), false);
+    for (int i = 0; i < features.size(); ++i) {
+        unique_genes[static_cast<int>(features.geneIds().at(i))] = true;
+        unique_spots[static_cast<int>(features.spotIds().at(i))] = true;
+        m_totalReads += features.counts().at(i);
     }
 
-    m_totalSpots = unique_spots.size();
+    m_totalSpots = unique_spots.count(true);
     m_totalFeatures = m_selectedFeatures.size();
-    m_totalGenes = unique_genes.size();
+    m_totalGenes = unique_genes.count(true);
 }
 
 QString UserSelection::typeToQString(const UserSelection::Type &type)
@@ -315,28 +317,50 @@ UserSelection::Type UserSelection::QStringToType(const QString &type)
 
 UserSelection::geneTotalCountsVector UserSelection::getGeneCounts() const
 {
-    Feature::geneTotalCounts gene_countsMap;
     geneTotalCountsVector gene_countsVector;
     // aggreate counts by gene
-    for (const auto &feature : m_selectedFeatures) {
-        Q_ASSERT(feature);
-        gene_countsMap[feature->gene()] += feature->count();
-    }
+    const QVector<int> gene_countsById = getGeneCountsById();
     // create a vector of gene-count pairs
-    Feature::geneTotalCounts::const_iterator it = gene_countsMap.constBegin();
-    while (it != gene_countsMap.constEnd()) {
-        gene_countsVector.push_back(geneCount(it.key(), it.value()));
-        ++it;
+    for (int i = 0; i < gene_countsById.size(); ++i) {
+        if (gene_countsById.at(i) != -1) {
+            gene_countsVector.push_back(
+                geneCount(m_selectedFeatures.geneName(static_cast<quint32>(i)),
+                          gene_countsById.at(i)));
+        }
     }
     // return the vector
     return gene_countsVector;
 }
 
+QVector<int> UserSelection::getGeneCountsById() const
+{
+    QVector<int> gene_countsById(m_selectedFeatures.genesCount(), -1);
+    const QVector<quint32> &geneIds = m_selectedFeatures.geneIds();
+    const QVector<int> &counts = m_selectedFeatures.counts();
+    for (int i = 0; i < m_selectedFeatures.size(); ++i) {
+        int &gene_count = gene_countsById[static_cast<int>(geneIds.at(i))];
+        gene_count = std::max(gene_count, 0) + counts.at(i);
+    }
+    return gene_countsById;
+}
+
 Feature::spotTotalCounts UserSelection::getTotalCounts() const
 {
+    // aggregate the counts by spot id first
+    QVector<int> spot_counts(m_selectedFeatures.spotsCount(), -1);
+    const QVector<quint32> &spotIds = m_selectedFeatures.spotIds();
+    const QVector<int> &counts = m_selectedFeatures.counts();
+    for (int i = 0; i < m_selectedFeatures.size(); ++i) {
+        int &spot_count = spot_counts[static_cast<int>(spotIds.at(i))];
+        spot_count = std::max(spot_count, 0) + counts.at(i);
+    }
     Feature::spotTotalCounts read_counts;
-    for (const auto &feature : m_selectedFeatures) {
-        read_counts[feature->spot()] += feature->count();
+    for (int i = 0; i < spot_counts.size(); ++i) {
+        if (spot_counts.at(i) != -1) {
+            read_counts.insert(Feature::SpotType(m_selectedFeatures.spotsX().at(i),
+                                                 m_selectedFeatures.spotsY().at(i)),
+                               spot_counts.at(i));
+        }
     }
     return read_counts;
 }
@@ -7,6 +7,7 @@
 #include <QColor>
 
 #include "dataModel/Feature.h"
+#include "dataModel/FeatureStore.h"
 #include "data/DataProxy.h"
 
 // Gene selection represents a selection of spots made by the user trough the
@@ -40,7 +41,7 @@ public:
     // Id represents databaset ID for objects
     const QString datasetId() const;
     // the list of features present in the selection
-    const DataProxy::FeatureList selectedFeatures() const;
+    const FeatureStore selectedFeatures() const;
     const QString status() const;
     const QString comment() const;
     // whether the selection is valid or not
@@ -67,7 +68,7 @@ public:
     void name(const QString &name);
     void userId(const QString &userId);
     void datasetId(const QString &datasetId);
-    void selectedFeatures(const DataProxy::FeatureList &features);
+    void selectedFeatures(const FeatureStore &features);
     void status(const QString &status);
     void comment(const QString &comment);
     void enabled(const bool enabled);
@@ -81,7 +82,7 @@ public:
     // this method will call selectedFeatures(features) to assign the features
     // but will also compute the selectedGenes and selectedSpots
     // so they can be stored in the selection
-    void loadFeatures(const DataProxy::FeatureList &features);
+    void loadFeatures(const FeatureStore &features);
 
     // convenience type to convert enum types to qstring and viceversea
     static QString typeToQString(const Type &type);
@@ -93,12 +94,17 @@ public:
     geneTotalCountsVector getGeneCounts() const;
     Feature::spotTotalCounts getTotalCounts() const;
 
+    // returns a plain array of gene id -> total count in selection (-1 for the
+    // genes not present in the selection), the gene ids are the ones of
+    // selectedFeatures()
+    QVector<int> getGeneCountsById() const;
+
 private:
     QString m_id;
     QString m_name;
     QString m_userId;
     QString m_datasetId;
-    DataProxy::FeatureList m_selectedFeatures;
+    FeatureStore m_selectedFeatures;
     Type m_type;
     QString m_status;
     QString m_comment;
@@ -102,13 +102,14 @@ public:
         jsonObj["account_id"] = userId();
         jsonObj["dataset_id"] = datasetId();
         QJsonArray geneHits;
-        for (const auto &feature : m_userSelection.selectedFeatures()) {
+        const FeatureStore features = m_userSelection.selectedFeatures();
+        for (const auto feature : features) {
             QJsonArray geneHit;
-            geneHit.append(feature->gene());
+            geneHit.append(feature.gene());
             // TODO temp hack coz they are wronly defined as strings in the server
-            geneHit.append(QString::number(feature->x()));
-            geneHit.append(QString::number(feature->y()));
-            geneHit.append(QString::number(feature->count()));
+            geneHit.append(QString::number(feature.x()));
+            geneHit.append(QString::number(feature.y()));
+            geneHit.append(QString::number(feature.count()));
             geneHits.append(geneHit);
         }
         jsonObj["gene_hits"] = geneHits;
@@ -130,14 +131,13 @@ private:
     // TODO this could be done automatically in serializeVector() we just need to
     // register
     // the selection metatype conversion in the Feature Object
-    const QVariantList serializeSelectionVector(
-        const DataProxy::FeatureList &unserializedVector) const
+    const QVariantList serializeSelectionVector(const FeatureStore &unserializedVector) const
     {
         QVariantList newList;
-        for (const auto &feature : unserializedVector) {
+        for (const auto feature : unserializedVector) {
             QVariantList itemList;
-            itemList << feature->gene() << QString::number(feature->x())
-                     << QString::number(feature->y()) << QString::number(feature->count());
+            itemList << feature.gene() << QString::number(feature.x())
+                     << QString::number(feature.y()) << QString::number(feature.count());
             newList << QVariant::fromValue(itemList);
         }
 
@@ -148,11 +148,11 @@ private:
     // TODO this could be done automatically in serializeVector() we just need to
     // register
     // the selection metatype conversion in the Feature Object
-    const DataProxy::FeatureList unserializeSelectionVector(
-        const QVariantList &serializedVector) const
+    const FeatureStore unserializeSelectionVector(const QVariantList &serializedVector) const
     {
         // unserialize data
-        DataProxy::FeatureList features;
+        FeatureStore features;
+        features.reserve(serializedVector.size());
         QVariantList::const_iterator it;
         QVariantList::const_iterator end = serializedVector.end();
         for (it = serializedVector.begin(); it != end; ++it) {
@@ -164,7 +164,7 @@ private:
             const int x = elementList.at(1).toInt();
             const int y = elementList.at(2).toInt();
             const int count = elementList.at(3).toInt();
-            features.push_back(std::make_shared<Feature>(Feature(gene, x, y, count)));
+            features.addFeature(gene, x, y, count);
         }
         return features;
     }
@@ -3,8 +3,6 @@
 #include <QCoreApplication>
 #include <QDateTime>
 
-#include "dataModel/Feature.h"
-
 static const QString PROPERTY_LIST_DELIMITER = QStringLiteral(";;");
 
 FeatureExporter::FeatureExporter()
@@ -58,7 +56,7 @@ void FeatureExporter::exportStrings(QTextStream &otxt, const QStringList &string
     otxt << strings.join(delimiter) << endl;
 }
 
-void FeatureExporter::exportItem(QTextStream &otxt, const Feature &feature) const
+void FeatureExporter::exportItem(QTextStream &otxt, const FeatureStore::FeatureRef &feature) const
 {
     QStringList list;
     list << QString("%1").arg(feature.gene()) << QString("%1").arg(feature.x())
@@ -67,7 +65,7 @@ void FeatureExporter::exportItem(QTextStream &otxt, const Feature &feature) cons
     exportStrings(otxt, list);
 }
 
-void FeatureExporter::exportItem(QTextStream &otxt, const DataProxy::FeatureList &featureList) const
+void FeatureExporter::exportItem(QTextStream &otxt, const FeatureStore &featureList) const
 {
     // prepend header
     if (m_detailLevel.testFlag(FeatureExporter::Comments)) {
@@ -80,12 +78,12 @@ void FeatureExporter::exportItem(QTextStream &otxt, const DataProxy::FeatureList
         exportStrings(otxt, list);
     }
 
-    for (const auto &feature : featureList) {
-        exportItem(otxt, *feature);
+    for (const auto feature : featureList) {
+        exportItem(otxt, feature);
     }
 }
 
-void FeatureExporter::exportItem(QIODevice &device, const DataProxy::FeatureList &featureList) const
+void FeatureExporter::exportItem(QIODevice &device, const FeatureStore &featureList) const
 {
     // early out
     if (!device.isWritable()) {
@@ -5,10 +5,9 @@
 #include <QStringList>
 #include <QTextStream>
 
-#include "data/DataProxy.h"
+#include "dataModel/FeatureStore.h"
 
 class QIODevice;
-class Feature;
 
 // Simple class to export an UserSelection to a file
 class FeatureExporter
@@ -37,7 +36,7 @@ public:
     ~FeatureExporter();
 
     // the method to call to write the features to a file
-    void exportItem(QIODevice &device, const DataProxy::FeatureList &featureList) const;
+    void exportItem(QIODevice &device, const FeatureStore &featureList) const;
 
     // to add dybamic properties to the document
     void addExportProperty(const QString &property);
@@ -53,8 +52,8 @@ private:
     const QString delimiterCharacter() const;
     // internal functions to do the writing to file object by object
     void exportStrings(QTextStream &otxt, const QStringList &strings) const;
-    void exportItem(QTextStream &otxt, const Feature &feature) const;
-    void exportItem(QTextStream &otxt, const DataProxy::FeatureList &selectionList) const;
+    void exportItem(QTextStream &otxt, const FeatureStore::FeatureRef &feature) const;
+    void exportItem(QTextStream &otxt, const FeatureStore &selectionList) const;
 
     DetailLevels m_detailLevel;
     SeparationModes m_separationMode;
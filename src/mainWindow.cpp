@@ -241,6 +241,22 @@ void MainWindow::setupUi()
     addDockWidget(Qt::LeftDockWidgetArea, dock_genes);
 }
 
+void MainWindow::slotFeaturesProgress(qint64 bytesParsed, qint64 bytesTotal)
+{
+    // the total size is not always known when the features are downloaded
+    if (bytesTotal > 0) {
+        const int percentage = static_cast<int>(100 * bytesParsed / bytesTotal);
+        statusBar()->showMessage(tr("Loading features %1%").arg(percentage));
+    } else {
+        statusBar()->showMessage(tr("Loading features %1 MB").arg(bytesParsed / (1024 * 1024)));
+    }
+}
+
+void MainWindow::slotFeaturesLoaded(bool parsedOk)
+{
+    statusBar()->showMessage(parsedOk ? tr("Features loaded") : tr("Features not loaded"), 5000);
+}
+
 void MainWindow::slotShowAbout()
 {
     QScopedPointer<AboutDialog> about(
@@ -393,6 +409,16 @@ void MainWindow::createConnections()
 
     // connect log out signal from cell view
     connect(m_cellview.data(), SIGNAL(signalLogOut()), this, SLOT(slotLogOutButton()));
+
+    // connect the features loading progress to the status bar
+    connect(m_dataProxy.data(),
+            SIGNAL(signalFeaturesProgress(qint64, qint64)),
+            this,
+            SLOT(slotFeaturesProgress(qint64, qint64)));
+    connect(m_dataProxy.data(),
+            SIGNAL(signalFeaturesLoaded(bool)),
+            this,
+            SLOT(slotFeaturesLoaded(bool)));
 }
 
 void MainWindow::closeEvent(QCloseEvent *event)
@@ -59,6 +59,10 @@ private slots:
     // when user clicks to log out, shows log in dialog
     void slotLogOutButton();
 
+    // shows the progress of the features loading in the status bar
+    void slotFeaturesProgress(qint64 bytesParsed, qint64 bytesTotal);
+    void slotFeaturesLoaded(bool parsedOk);
+
 private:
     // create all the widgets
     void setupUi();
@@ -0,0 +1,112 @@
+#include "LatticeIndex.h"
+
+#include <cmath>
+
+LatticeIndex::LatticeIndex()
+    : m_cellSize(1.0f)
+{
+}
+
+LatticeIndex::LatticeIndex(const float cellSize)
+    : m_cellSize(cellSize)
+{
+    Q_ASSERT(cellSize > 0.0f);
+}
+
+LatticeIndex::~LatticeIndex()
+{
+}
+
+void LatticeIndex::build(const QVector<float> &x, const QVector<float> &y)
+{
+    Q_ASSERT(x.size() == y.size());
+    clear();
+    // the arrays are implicitly shared so they are not copied
+    m_x = x;
+    m_y = y;
+
+    // the cell of each point and the number of points of each cell
+    QVector<int> pointCells(x.size());
+    m_cells.reserve(x.size());
+    m_offsets.push_back(0);
+    for (int i = 0; i < x.size(); ++i) {
+        const quint64 key = cellKey(cell(x.at(i)), cell(y.at(i)));
+        auto it = m_cells.find(key);
+        if (it == m_cells.end()) {
+            it = m_cells.insert(key, m_offsets.size() - 1);
+            m_offsets.push_back(0);
+        }
+        pointCells[i] = it.value();
+        ++m_offsets[it.value() + 1];
+    }
+
+    // counting sort of the points by cell
+    for (int i = 1; i < m_offsets.size(); ++i) {
+        m_offsets[i] += m_offsets.at(i - 1);
+    }
+    QVector<int> next(m_offsets);
+    m_points.resize(x.size());
+    for (int i = 0; i < x.size(); ++i) {
+        m_points[next[pointCells.at(i)]++] = i;
+    }
+}
+
+void LatticeIndex::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_cells.clear();
+    m_offsets.clear();
+    m_points.clear();
+}
+
+bool LatticeIndex::isEmpty() const
+{
+    return m_points.isEmpty();
+}
+
+int LatticeIndex::nearest(const QPointF &p,
+                          const float maxDistance,
+                          const PointFilter &filter) const
+{
+    int nearestPoint = -1;
+    float nearestDistance = maxDistance * maxDistance;
+    const int lastColumn = cell(p.x() + maxDistance);
+    const int lastRow = cell(p.y() + maxDistance);
+    for (int column = cell(p.x() - maxDistance); column <= lastColumn; ++column) {
+        for (int row = cell(p.y() - maxDistance); row <= lastRow; ++row) {
+            const auto it = m_cells.constFind(cellKey(column, row));
+            if (it == m_cells.constEnd()) {
+                continue;
+            }
+            for (int i = m_offsets.at(it.value()); i < m_offsets.at(it.value() + 1); ++i) {
+                const int point = m_points.at(i);
+                if (filter && !filter(point)) {
+                    continue;
+                }
+                const float dx = m_x.at(point) - static_cast<float>(p.x());
+                const float dy = m_y.at(point) - static_cast<float>(p.y());
+                const float distance = dx * dx + dy * dy;
+                // ties go to the point with the lowest index
+                if (distance < nearestDistance
+                    || (distance == nearestDistance
+                        && (nearestPoint == -1 || point < nearestPoint))) {
+                    nearestPoint = point;
+                    nearestDistance = distance;
+                }
+            }
+        }
+    }
+    return nearestPoint;
+}
+
+int LatticeIndex::cell(const qreal coordinate) const
+{
+    return static_cast<int>(std::floor(coordinate / m_cellSize + 0.5));
+}
+
+quint64 LatticeIndex::cellKey(const int column, const int row)
+{
+    return (static_cast<quint64>(static_cast<quint32>(column)) << 32)
+           | static_cast<quint32>(row);
+}
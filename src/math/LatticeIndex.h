@@ -0,0 +1,59 @@
+#ifndef LATTICEINDEX_H
+#define LATTICEINDEX_H
+
+#include <QHash>
+#include <QPointF>
+#include <QVector>
+
+#include <functional>
+
+// Look up of points laid out in a regular lattice (for instance the spots of
+// an array, integer coordinates with some jitter). The points are hashed by
+// the cell of the lattice their coordinates round to so the points around a
+// position are found in constant time (visiting the cells around it) instead
+// of walking down a tree. Several points can share a cell.
+class LatticeIndex
+{
+
+public:
+    // tells if the point of the given index can be returned by a look up
+    typedef std::function<bool(int)> PointFilter;
+
+    LatticeIndex();
+    // the cell size is the distance between the points of the lattice
+    explicit LatticeIndex(const float cellSize);
+    ~LatticeIndex();
+
+    // indexes the points given by the x and y arrays, the index of a point
+    // is its position in the arrays
+    void build(const QVector<float> &x, const QVector<float> &y);
+
+    // clean up
+    void clear();
+
+    bool isEmpty() const;
+
+    // returns the index of the point nearest to p within maxDistance or -1
+    // if there are none, every cell covered by the distance is visited so
+    // the distance is expected to be of the order of the cell size
+    // only the points accepted by the filter (if any) are considered
+    int nearest(const QPointF &p,
+                const float maxDistance,
+                const PointFilter &filter = PointFilter()) const;
+
+private:
+    // the cell (column or row) a coordinate rounds to
+    int cell(const qreal coordinate) const;
+    static quint64 cellKey(const int column, const int row);
+
+    float m_cellSize;
+    QVector<float> m_x;
+    QVector<float> m_y;
+    // the points of a cell are [offsets[i], offsets[i + 1]) of the points
+    // list (CSR) where i is the value of the cell in the look up
+    QHash<quint64, int> m_cells;
+    QVector<int> m_offsets;
+    QVector<int> m_points;
+};
+
+#endif // LATTICEINDEX_H //
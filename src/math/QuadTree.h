@@ -6,9 +6,11 @@
 
 #include <vector>
 #include <array>
+#include <algorithm>
 
 #include "Common.h"
 #include "QuadTreeAABB.h"
+#include "QuadTreePolygon.h"
 
 // Simple template based quad tree implementation using QPointF as lookup
 // method. Each point is associated with data of type T. The N argument
@@ -18,6 +20,12 @@
 // NOTE this implementation does not allow multiple data to be stored in the
 // same point (this is to avoid inf-recursion when splitting).
 
+// The points of all the buckets are stored in a single contiguous list (each
+// leaf bucket owns a range of it) so the look ups do not chase a pointer per
+// bucket. The tree can be built incrementally with insert() or, much faster,
+// in one pass with build() which sorts the points by Morton code (Z order) so
+// the points of neighbouring buckets are also neighbours in memory.
+
 template <typename T, int N = 8>
 class QuadTree
 {
@@ -38,9 +46,19 @@ public:
     // inserted (no data exists on that point).
     bool insert(const QPointF &p, const T &t);
 
+    // replaces the content of the tree (the bounding box is kept) with the
+    // given items, the items outside of the bounding box or in the same point
+    // as a previous item are discarded as with insert(). Returns the number
+    // of items inserted
+    int build(const PointItemList &items);
+
     // return a list of all items within the given area
     void select(const QuadTreeAABB &b, PointItemList &items) const;
 
+    // return a list of all items inside the given polygon (the buckets
+    // completely inside or outside of it are not tested point by point)
+    void select(const QuadTreePolygon &polygon, PointItemList &items) const;
+
     // return the item at the specified point
     void select(const QPointF &p, PointItem &item) const;
 
@@ -56,6 +74,22 @@ private:
     int insert_p(const QPointF &p, const T &t, const int idx);
     void smash(const int idx);
 
+    // builds the bucket idx from the items [begin, end) (sorted in Z order)
+    void build_p(const int idx,
+                 PointItemList &items,
+                 PointItemList &scratch,
+                 QVector<int> &ranks,
+                 const int begin,
+                 const int end,
+                 const int depth);
+
+    // the quadrant (Q0 to Q3) of a bucket with the given middle point the
+    // point p is in
+    static int quadrant(const QPointF &middle_point, const QPointF &p);
+    // 32 bits Morton code of the point p (interleaved bits of its 16 bits
+    // coordinates relative to the aabb, y in the odd bits)
+    static quint32 mortonCode(const QuadTreeAABB &aabb, const QPointF &p);
+
     // Simple representation of a quad tree bucket.
     struct Bucket {
         static const int INSERT_OK = -1;
@@ -65,7 +99,6 @@ private:
         static const int LOOKUP_NOT_FOUND = -2;
         static const int POINT_LIST_LIMIT = N;
 
-        typedef QVector<PointItem> StaticPointItemList;
         typedef std::array<int, 4> QuadArrayType;
 
         Bucket();
@@ -74,22 +107,38 @@ private:
 
         bool contains(const QPointF &p) const;
 
-        int insert(const QPointF &p, const T &t);
+        int insert(const QPointF &p, const T &t, PointItemList &points);
 
-        void select(const QuadTreeAABB &b, PointItemList &items, QuadArrayType &point_array) const;
+        void select(const QuadTreeAABB &b,
+                    PointItemList &items,
+                    QuadArrayType &point_array,
+                    const PointItemList &points) const;
 
-        void select(const QPointF &p, PointItem &item, QuadArrayType &point_array) const;
+        void select(const QPointF &p,
+                    PointItem &item,
+                    QuadArrayType &point_array,
+                    const PointItemList &points) const;
 
         bool isNode() const;
         bool isLeaf() const;
 
         QuadTreeAABB aabb;
         QuadArrayType quads;
-        StaticPointItemList data; // store all data as part of bucket struct
+        // the points of a leaf bucket are [first, first + count) of the
+        // points list, a leaf can hold capacity points before it is moved
+        // to the end of the list (the old range is not reused)
+        // the points of the children of a node built with build() are also
+        // contiguous so the range of a node is its points (count is -1 if
+        // they are not, for instance if a point has been inserted)
+        int first;
+        int count;
+        int capacity;
     };
 
     typedef QVector<Bucket> BucketList;
     BucketList m_data;
+    // the points of all the buckets
+    PointItemList m_points;
 };
 
 /****************************************** DEFINITION
@@ -102,7 +151,7 @@ void QuadTree<T, N>::boundingBoxList(BoundingBoxList &buckets) const
     typename BucketList::const_iterator end = m_data.end();
     for (; it != end; ++it) {
         if (it->isLeaf()) {
-            buckets.push_back(it->QuadTreeAABB);
+            buckets.push_back(it->aabb);
         }
     }
 }
@@ -111,12 +160,14 @@ template <typename T, int N>
 void QuadTree<T, N>::clear()
 {
     m_data.clear();
+    m_points.clear();
 }
 
 template <typename T, int N>
 void QuadTree<T, N>::Bucket::select(const QuadTreeAABB &b,
                                     PointItemList &items,
-                                    QuadArrayType &point_array) const
+                                    QuadArrayType &point_array,
+                                    const PointItemList &points) const
 {
     // early out
     if (!aabb.intersects(b)) {
@@ -126,25 +177,28 @@ void QuadTree<T, N>::Bucket::select(const QuadTreeAABB &b,
         return;
     }
 
+    // add all items if bucket contained (speed up), nodes included if their
+    // points are contiguous
+    const int last = first + count;
+    const bool contained = count >= 0 && b.contains(aabb);
+
     // if none-leaf node (ie. no data)
-    if (isNode()) {
+    if (isNode() && !contained) {
         std::copy(quads.begin(), quads.end(), point_array.begin());
         return;
     }
 
     // else add data selected
-    // add all items if bucket contained (speed up)
-    const typename StaticPointItemList::size_type size = data.size();
-    if (b.contains(aabb)) {
-        for (typename StaticPointItemList::size_type i = 0; i < size; ++i) {
-            items.push_back(data[i]);
+    if (contained) {
+        for (int i = first; i < last; ++i) {
+            items.push_back(points[i]);
         }
     }
     // else test and add individual items
     else {
-        for (typename StaticPointItemList::size_type i = 0; i < size; ++i) {
-            if (b.contains(data[i].first)) {
-                items.push_back(data[i]);
+        for (int i = first; i < last; ++i) {
+            if (b.contains(points[i].first)) {
+                items.push_back(points[i]);
             }
         }
     }
@@ -156,7 +210,8 @@ void QuadTree<T, N>::Bucket::select(const QuadTreeAABB &b,
 template <typename T, int N>
 void QuadTree<T, N>::Bucket::select(const QPointF &p,
                                     PointItem &item,
-                                    QuadArrayType &point_array) const
+                                    QuadArrayType &point_array,
+                                    const PointItemList &points) const
 {
     // early out
     if (!aabb.contains(p)) {
@@ -174,10 +229,10 @@ void QuadTree<T, N>::Bucket::select(const QPointF &p,
 
     // else add data selected
     // test and add individual item
-    const typename StaticPointItemList::size_type size = data.size();
-    for (typename StaticPointItemList::size_type i = 0; i < size; ++i) {
-        if (Math::qFuzzyEqual(p, data[i].first)) {
-            item = data[i];
+    const int last = first + count;
+    for (int i = first; i < last; ++i) {
+        if (Math::qFuzzyEqual(p, points[i].first)) {
+            item = points[i];
         }
     }
 
@@ -187,36 +242,40 @@ void QuadTree<T, N>::Bucket::select(const QPointF &p,
 }
 
 template <typename T, int N>
-int QuadTree<T, N>::Bucket::insert(const QPointF &p, const T &t)
+int QuadTree<T, N>::Bucket::insert(const QPointF &p, const T &t, PointItemList &points)
 {
-    static const int table[] = {0, 1, 3, 2};
-
-    // if non-leaf bucket
+    // if non-leaf bucket (its points will no longer be contiguous)
     if (quads[0] >= 0) {
-        const QPointF middle_point = aabb.middle();
-        const QVector2D middle_vector(p.x() - middle_point.x(), p.y() - middle_point.y());
-        const int idx = ((middle_vector.x() < 0.0) ? 1 : 0)
-                             + ((middle_vector.y() < 0.0) ? 2 : 0);
-        const int q = table[idx];
-        return quads[q];
+        count = -1;
+        return quads[quadrant(aabb.middle(), p)];
     }
 
     // DEBUG force p to be unique to avoid inf recursion!
-    typename StaticPointItemList::size_type size = data.size();
-    for (typename StaticPointItemList::size_type i = 0; i < size; ++i) {
-        if (Math::qFuzzyEqual(data[i].first, p)) {
+    const int last = first + count;
+    for (int i = first; i < last; ++i) {
+        if (Math::qFuzzyEqual(points[i].first, p)) {
             return INSERT_ERROR_NONUNIQUE;
         }
     }
 
     // try to insert
-    if (size == POINT_LIST_LIMIT) {
+    if (count == POINT_LIST_LIMIT) {
         return INSERT_ERROR_FULL;
-    } else {
-        PointItem pair(p, t);
-        data.push_back(pair);
-        return INSERT_OK;
     }
+    if (count == capacity) {
+        // move the points to a range at the end of the list with room
+        // for a full bucket
+        const int newFirst = points.size();
+        points.resize(newFirst + POINT_LIST_LIMIT);
+        for (int i = 0; i < count; ++i) {
+            points[newFirst + i] = points[first + i];
+        }
+        first = newFirst;
+        capacity = POINT_LIST_LIMIT;
+    }
+    points[first + count] = PointItem(p, t);
+    ++count;
+    return INSERT_OK;
 }
 
 template <typename T, int N>
@@ -226,7 +285,7 @@ int QuadTree<T, N>::insert_p(const QPointF &p, const T &t, const int idx)
     int lastIdx;
     int currIdx = idx;
     while ((lastIdx = currIdx) >= 0) {
-        currIdx = m_data[currIdx].insert(p, t);
+        currIdx = m_data[currIdx].insert(p, t, m_points);
         if (currIdx == Bucket::INSERT_ERROR_FULL) {
             // smash bucket and retry insert (recycle index)
             smash((currIdx = lastIdx));
@@ -239,6 +298,7 @@ int QuadTree<T, N>::insert_p(const QPointF &p, const T &t, const int idx)
 template <typename T, int N>
 QuadTree<T, N>::QuadTree()
     : m_data()
+    , m_points()
 {
 }
 
@@ -250,6 +310,7 @@ QuadTree<T, N>::~QuadTree()
 template <typename T, int N>
 QuadTree<T, N>::QuadTree(const QSizeF &size)
     : m_data()
+    , m_points()
 {
     const QuadTreeAABB boundingBox = QuadTreeAABB(0.0, 0.0, size.width(), size.height());
     m_data.push_back(Bucket(boundingBox));
@@ -258,6 +319,7 @@ QuadTree<T, N>::QuadTree(const QSizeF &size)
 template <typename T, int N>
 QuadTree<T, N>::QuadTree(const QuadTreeAABB &boundingBox)
     : m_data()
+    , m_points()
 {
     m_data.push_back(Bucket(boundingBox));
 }
@@ -265,6 +327,7 @@ QuadTree<T, N>::QuadTree(const QuadTreeAABB &boundingBox)
 template <typename T, int N>
 QuadTree<T, N>::QuadTree(const QRectF &rect)
     : m_data()
+    , m_points()
 {
     const QuadTreeAABB boundingBox = QuadTreeAABB(rect);
     m_data.push_back(Bucket(boundingBox));
@@ -281,6 +344,55 @@ bool QuadTree<T, N>::insert(const QPointF &p, const T &t)
     return (idx == Bucket::INSERT_OK);
 }
 
+template <typename T, int N>
+int QuadTree<T, N>::build(const PointItemList &items)
+{
+    if (m_data.empty()) {
+        return 0;
+    }
+    const QuadTreeAABB boundingBox = m_data[0].aabb;
+    m_data.clear();
+    m_points.clear();
+    m_data.push_back(Bucket(boundingBox));
+
+    // sort the items in Z order (the items in the same point are sorted
+    // by position so they are next to each other, the first one is kept)
+    typedef QPair<quint32, int> CodeIndex;
+    QVector<CodeIndex> codes;
+    codes.reserve(items.size());
+    for (int i = 0; i < items.size(); ++i) {
+        if (boundingBox.contains(items[i].first)) {
+            codes.push_back(qMakePair(mortonCode(boundingBox, items[i].first), i));
+        }
+    }
+    std::stable_sort(codes.begin(),
+                     codes.end(),
+                     [&items](const CodeIndex &c0, const CodeIndex &c1) {
+                         if (c0.first != c1.first) {
+                             return c0.first < c1.first;
+                         }
+                         const QPointF &p0 = items[c0.second].first;
+                         const QPointF &p1 = items[c1.second].first;
+                         return p0.x() < p1.x() || (p0.x() == p1.x() && p0.y() < p1.y());
+                     });
+
+    PointItemList sorted;
+    sorted.reserve(codes.size());
+    for (const CodeIndex &code : codes) {
+        const PointItem &item = items[code.second];
+        if (sorted.empty() || !Math::qFuzzyEqual(sorted.last().first, item.first)) {
+            sorted.push_back(item);
+        }
+    }
+
+    // the leaves are appended to the points list in Z order
+    PointItemList scratch(sorted.size());
+    QVector<int> ranks(sorted.size());
+    m_points.reserve(sorted.size());
+    build_p(0, sorted, scratch, ranks, 0, sorted.size(), 0);
+    return m_points.size();
+}
+
 template <typename T, int N>
 bool QuadTree<T, N>::contains(const QPointF &p) const
 {
@@ -303,7 +415,7 @@ void QuadTree<T, N>::select(const QuadTreeAABB &b, PointItemList &items) const
         indicies.pop_back();
 
         typename Bucket::QuadArrayType ret;
-        m_data[idx].select(b, items, ret);
+        m_data[idx].select(b, items, ret, m_points);
 
         if (ret[0] >= 0) {
             indicies.push_back(ret[0]);
@@ -320,6 +432,70 @@ void QuadTree<T, N>::select(const QuadTreeAABB &b, PointItemList &items) const
     }
 }
 
+template <typename T, int N>
+void QuadTree<T, N>::select(const QuadTreePolygon &polygon, PointItemList &items) const
+{
+    // the buckets to visit and whether they are known to be inside the polygon
+    typedef QVector<QPair<int, bool>> IndexList;
+    IndexList indicies;
+
+    if (!m_data.empty() && !polygon.isEmpty()) {
+        indicies.push_back(qMakePair(0, false));
+    }
+
+    // the coordinates of the points of a bucket (they are tested together)
+    std::array<float, N> x;
+    std::array<float, N> y;
+    std::array<quint8, N> inside;
+
+    while (!indicies.empty()) {
+        const int idx = indicies.back().first;
+        bool bucket_inside = indicies.back().second;
+        indicies.pop_back();
+
+        const Bucket &bucket = m_data[idx];
+        if (!bucket_inside) {
+            const QuadTreePolygon::Overlap overlap = polygon.overlap(bucket.aabb);
+            if (overlap == QuadTreePolygon::Outside) {
+                continue;
+            }
+            // the buckets inside the polygon are accepted with all their children
+            bucket_inside = (overlap == QuadTreePolygon::Inside);
+        }
+
+        // if none-leaf node (ie. no data) unless its points can be added
+        if (bucket.isNode() && !(bucket_inside && bucket.count >= 0)) {
+            for (const int quad : bucket.quads) {
+                if (quad >= 0) {
+                    indicies.push_back(qMakePair(quad, bucket_inside));
+                }
+            }
+            continue;
+        }
+
+        const PointItem *data = m_points.constData() + bucket.first;
+        const int size = bucket.count;
+        if (bucket_inside) {
+            for (int i = 0; i < size; ++i) {
+                items.push_back(data[i]);
+            }
+            continue;
+        }
+
+        // the bucket crosses the boundary of the polygon so its points are tested
+        for (int i = 0; i < size; ++i) {
+            x[i] = data[i].first.x();
+            y[i] = data[i].first.y();
+        }
+        polygon.contains(x.data(), y.data(), size, inside.data());
+        for (int i = 0; i < size; ++i) {
+            if (inside[i] != 0) {
+                items.push_back(data[i]);
+            }
+        }
+    }
+}
+
 template <typename T, int N>
 void QuadTree<T, N>::select(const QPointF &p, PointItem &item) const
 {
@@ -335,7 +511,7 @@ void QuadTree<T, N>::select(const QPointF &p, PointItem &item) const
         indicies.pop_back();
 
         typename Bucket::QuadArrayType ret;
-        m_data[idx].select(p, item, ret);
+        m_data[idx].select(p, item, ret, m_points);
 
         if (ret[0] >= 0) {
             indicies.push_back(ret[0]);
@@ -384,21 +560,138 @@ void QuadTree<T, N>::smash(const int idx)
         = {{newIdxHead + 0, newIdxHead + 1, newIdxHead + 2, newIdxHead + 3}};
     std::copy(newIdxList.begin(), newIdxList.end(), m_data[idx].quads.begin());
 
+    // remove data from parent (its range of points is not reused)
+    const PointItemList data = m_points.mid(m_data[idx].first, m_data[idx].count);
+    m_data[idx].count = -1;
+    m_data[idx].capacity = 0;
+
     // reinsert data
-    const typename Bucket::StaticPointItemList::size_type size = m_data[idx].data.size();
-    for (typename Bucket::StaticPointItemList::size_type i = 0; i < size; ++i) {
-        insert_p(m_data[idx].data[i].first, m_data[idx].data[i].second, idx); // [*]
+    for (const PointItem &item : data) {
+        insert_p(item.first, item.second, idx); // [*]
+    }
+}
+
+template <typename T, int N>
+void QuadTree<T, N>::build_p(const int idx,
+                             PointItemList &items,
+                             PointItemList &scratch,
+                             QVector<int> &ranks,
+                             const int begin,
+                             const int end,
+                             const int depth)
+{
+    // the buckets are split up to the precision of the coordinates, the
+    // points left beyond that depth are too close to be told apart
+    static const int MAX_DEPTH = 32;
+
+    // NOTE reallocation of m_data can be triggered when the children are
+    //     created so make sure NOT to to use any locally cached references!
+
+    if (end - begin <= N || depth == MAX_DEPTH) {
+        Bucket &bucket = m_data[idx];
+        bucket.first = m_points.size();
+        for (int i = begin; i < end && bucket.count < N; ++i) {
+            // the items in the same point are usually removed when sorted
+            // but points closer than the fuzzy compare may not be consecutive
+            bool unique = true;
+            for (int j = bucket.first; j < m_points.size() && unique; ++j) {
+                unique = !Math::qFuzzyEqual(m_points[j].first, items[i].first);
+            }
+            if (unique) {
+                m_points.push_back(items[i]);
+                ++bucket.count;
+            }
+        }
+        bucket.capacity = bucket.count;
+        return;
     }
 
-    // remove data from parent
-    m_data[idx].data.clear();
+    // create 4 new buckets (same layout as smash)
+    const int newIdxHead = m_data.size();
+    const QuadTreeAABB aabb = m_data[idx].aabb;
+    m_data.push_back(Bucket(aabb.split(QuadTreeAABB::Q0)));
+    m_data.push_back(Bucket(aabb.split(QuadTreeAABB::Q1)));
+    m_data.push_back(Bucket(aabb.split(QuadTreeAABB::Q2)));
+    m_data.push_back(Bucket(aabb.split(QuadTreeAABB::Q3)));
+    for (int q = 0; q < 4; ++q) {
+        m_data[idx].quads[q] = newIdxHead + q;
+    }
+
+    // the items of each quadrant in Z order, the quadrants are given by the
+    // middle of the bucket as in insert() and the items are sorted so they
+    // are usually in order already, if not (the Morton code of an item next
+    // to the middle was rounded to the other side) they are counting sorted
+    static const int zOrder[] = {QuadTreeAABB::Q2, QuadTreeAABB::Q3, QuadTreeAABB::Q1,
+                                 QuadTreeAABB::Q0};
+    static const int zRank[] = {3, 2, 0, 1};
+    const QPointF middle_point = aabb.middle();
+    std::array<int, 5> offsets = {{begin, 0, 0, 0, 0}};
+    bool ordered = true;
+    for (int i = begin; i < end; ++i) {
+        ranks[i] = zRank[quadrant(middle_point, items[i].first)];
+        ++offsets[ranks[i] + 1];
+        ordered = ordered && (i == begin || ranks[i - 1] <= ranks[i]);
+    }
+    for (int r = 1; r < 5; ++r) {
+        offsets[r] += offsets[r - 1];
+    }
+    if (!ordered) {
+        std::array<int, 4> next = {{offsets[0], offsets[1], offsets[2], offsets[3]}};
+        for (int i = begin; i < end; ++i) {
+            scratch[next[ranks[i]]++] = items[i];
+        }
+        std::copy(scratch.begin() + begin, scratch.begin() + end, items.begin() + begin);
+    }
+
+    const int first = m_points.size();
+    for (int r = 0; r < 4; ++r) {
+        build_p(newIdxHead + zOrder[r],
+                items,
+                scratch,
+                ranks,
+                offsets[r],
+                offsets[r + 1],
+                depth + 1);
+    }
+    m_data[idx].first = first;
+    m_data[idx].count = m_points.size() - first;
+}
+
+template <typename T, int N>
+int QuadTree<T, N>::quadrant(const QPointF &middle_point, const QPointF &p)
+{
+    static const int table[] = {0, 1, 3, 2};
+    const QVector2D middle_vector(p.x() - middle_point.x(), p.y() - middle_point.y());
+    const int idx = ((middle_vector.x() < 0.0) ? 1 : 0) + ((middle_vector.y() < 0.0) ? 2 : 0);
+    return table[idx];
+}
+
+template <typename T, int N>
+quint32 QuadTree<T, N>::mortonCode(const QuadTreeAABB &aabb, const QPointF &p)
+{
+    // spread the 16 bits of v to the even bits
+    const auto spread = [](quint32 v) {
+        v = (v | (v << 8)) & 0x00FF00FFu;
+        v = (v | (v << 4)) & 0x0F0F0F0Fu;
+        v = (v | (v << 2)) & 0x33333333u;
+        v = (v | (v << 1)) & 0x55555555u;
+        return v;
+    };
+    const auto quantize = [](const double v, const double origin, const double size) {
+        const double scaled = size > 0.0 ? (v - origin) / size * 65536.0 : 0.0;
+        return static_cast<quint32>(qBound(0.0, scaled, 65535.0));
+    };
+    return spread(quantize(p.x(), aabb.x, aabb.width))
+           | (spread(quantize(p.y(), aabb.y, aabb.height)) << 1);
 }
 
 // GLQuadTree::Bucket
 template <typename T, int N>
 QuadTree<T, N>::Bucket::Bucket()
     : aabb()
-    , data()
+    , first(0)
+    , count(0)
+    , capacity(0)
 {
     std::fill(quads.begin(), quads.end(), -1);
 }
@@ -411,7 +704,9 @@ QuadTree<T, N>::Bucket::~Bucket()
 template <typename T, int N>
 QuadTree<T, N>::Bucket::Bucket(const QuadTreeAABB &b)
     : aabb(b)
-    , data()
+    , first(0)
+    , count(0)
+    , capacity(0)
 {
     std::fill(quads.begin(), quads.end(), -1);
 }
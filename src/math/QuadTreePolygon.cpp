@@ -0,0 +1,125 @@
+#include "QuadTreePolygon.h"
+
+#include <algorithm>
+
+QuadTreePolygon::QuadTreePolygon()
+    : m_boundingBox()
+{
+}
+
+QuadTreePolygon::QuadTreePolygon(const QPolygonF &polygon)
+    : m_boundingBox(polygon.boundingRect())
+{
+    // the polygon is closed so a last vertex equal to the first is dropped
+    int vertices = polygon.size();
+    if (vertices > 1 && polygon.first() == polygon.last()) {
+        --vertices;
+    }
+    if (vertices < 3) {
+        return;
+    }
+
+    m_x0.reserve(vertices);
+    m_y0.reserve(vertices);
+    m_x1.reserve(vertices);
+    m_y1.reserve(vertices);
+    m_slope.reserve(vertices);
+    for (int i = 0; i < vertices; ++i) {
+        const QPointF &p0 = polygon.at(i);
+        const QPointF &p1 = polygon.at((i + 1) % vertices);
+        m_x0.push_back(p0.x());
+        m_y0.push_back(p0.y());
+        m_x1.push_back(p1.x());
+        m_y1.push_back(p1.y());
+        const float dy = m_y1.last() - m_y0.last();
+        m_slope.push_back(dy != 0.0f ? (m_x1.last() - m_x0.last()) / dy : 0.0f);
+    }
+}
+
+QuadTreePolygon::~QuadTreePolygon()
+{
+}
+
+bool QuadTreePolygon::isEmpty() const
+{
+    return m_x0.isEmpty();
+}
+
+const QuadTreeAABB &QuadTreePolygon::boundingBox() const
+{
+    return m_boundingBox;
+}
+
+bool QuadTreePolygon::contains(const QPointF &p) const
+{
+    const float x = p.x();
+    const float y = p.y();
+    quint8 inside;
+    contains(&x, &y, 1, &inside);
+    return inside != 0;
+}
+
+void QuadTreePolygon::contains(const float *x,
+                               const float *y,
+                               const int count,
+                               quint8 *inside) const
+{
+    std::fill(inside, inside + count, 0);
+    // even-odd rule, a point is inside if the horizontal ray from the point
+    // to the left crosses an odd number of edges
+    // the loop over the points has no branches so it is vectorized
+    for (int edge = 0; edge < m_x0.size(); ++edge) {
+        const float x0 = m_x0.at(edge);
+        const float y0 = m_y0.at(edge);
+        const float y1 = m_y1.at(edge);
+        const float slope = m_slope.at(edge);
+        for (int i = 0; i < count; ++i) {
+            const bool crosses = (y0 > y[i]) != (y1 > y[i]);
+            const bool left = x[i] < x0 + slope * (y[i] - y0);
+            inside[i] ^= static_cast<quint8>(crosses & left);
+        }
+    }
+}
+
+QuadTreePolygon::Overlap QuadTreePolygon::overlap(const QuadTreeAABB &b) const
+{
+    if (isEmpty() || !m_boundingBox.intersects(b)) {
+        return Outside;
+    }
+    for (int edge = 0; edge < m_x0.size(); ++edge) {
+        if (edgeIntersects(edge, b)) {
+            return Intersects;
+        }
+    }
+    // no edge crosses the AABB so it is either inside or outside
+    return contains(b.middle()) ? Inside : Outside;
+}
+
+bool QuadTreePolygon::edgeIntersects(const int edge, const QuadTreeAABB &b) const
+{
+    // simple SAT (Separating Axis Theorem) approach, the axes are the ones
+    // of the AABB and the normal of the edge
+    const float x0 = m_x0.at(edge);
+    const float y0 = m_y0.at(edge);
+    const float x1 = m_x1.at(edge);
+    const float y1 = m_y1.at(edge);
+    const float bx0 = b.x;
+    const float by0 = b.y;
+    const float bx1 = b.x + b.width;
+    const float by1 = b.y + b.height;
+    if (std::max(x0, x1) < bx0 || std::min(x0, x1) > bx1 || std::max(y0, y1) < by0
+        || std::min(y0, y1) > by1) {
+        return false;
+    }
+
+    // the side of the line of the edge each corner of the AABB is on
+    const float dx = x1 - x0;
+    const float dy = y1 - y0;
+    const float corners[4] = {dx * (by0 - y0) - dy * (bx0 - x0),
+                              dx * (by0 - y0) - dy * (bx1 - x0),
+                              dx * (by1 - y0) - dy * (bx1 - x0),
+                              dx * (by1 - y0) - dy * (bx0 - x0)};
+    const bool allAbove = std::all_of(corners, corners + 4, [](float s) { return s > 0.0f; });
+    const bool allBelow = std::all_of(corners, corners + 4, [](float s) { return s < 0.0f; });
+    return !allAbove && !allBelow;
+}
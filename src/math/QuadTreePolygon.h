@@ -0,0 +1,57 @@
+#ifndef QUADTREEPOLYGON_H
+#define QUADTREEPOLYGON_H
+
+#include "QuadTreeAABB.h"
+
+#include <QPolygonF>
+#include <QVector>
+
+// Simple implementation of a polygon used to select the points of a quad tree
+// (for instance a lasso selection). The polygon is always closed and the
+// points are tested with the even-odd rule.
+// The buckets of a quad tree can be classified against the polygon so the
+// ones completely inside or outside are accepted or rejected without testing
+// their points. The points are tested edge by edge over arrays of
+// coordinates so the inner loop is vectorized.
+class QuadTreePolygon
+{
+
+public:
+    // Overlap: the position of an AABB with respect to the polygon
+    enum Overlap { Outside, Inside, Intersects };
+
+    QuadTreePolygon();
+    explicit QuadTreePolygon(const QPolygonF &polygon);
+    ~QuadTreePolygon();
+
+    // a polygon with less than three vertices contains no points
+    bool isEmpty() const;
+
+    // the AABB of the vertices
+    const QuadTreeAABB &boundingBox() const;
+
+    bool contains(const QPointF &p) const;
+
+    // tests the points given by the x and y arrays (count elements), the
+    // element i of inside is set to 1 if the point i is inside and 0 if not
+    void contains(const float *x, const float *y, const int count, quint8 *inside) const;
+
+    // Overlap: the AABB intersects an edge of the polygon or it is
+    // completely inside or outside of it
+    Overlap overlap(const QuadTreeAABB &b) const;
+
+private:
+    // true if the edge crosses or touches the AABB
+    bool edgeIntersects(const int edge, const QuadTreeAABB &b) const;
+
+    // the edges (from vertex i to vertex i + 1 and from the last to the
+    // first) and the inverse of their slopes (0 if horizontal)
+    QVector<float> m_x0;
+    QVector<float> m_y0;
+    QVector<float> m_x1;
+    QVector<float> m_y1;
+    QVector<float> m_slope;
+    QuadTreeAABB m_boundingBox;
+};
+
+#endif // QUADTREEPOLYGON_H //
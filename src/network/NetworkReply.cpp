@@ -22,6 +22,7 @@
 
 NetworkReply::NetworkReply(QNetworkReply *networkReply)
     : m_reply(networkReply)
+    , m_streaming(false)
 {
     Q_ASSERT_X(networkReply != nullptr, "NetworkReply", "Null-pointer assertion error!");
 
@@ -30,6 +31,7 @@ NetworkReply::NetworkReply(QNetworkReply *networkReply)
 
     // connect signals
     connect(m_reply.data(), SIGNAL(finished()), this, SLOT(slotFinished()));
+    connect(m_reply.data(), SIGNAL(readyRead()), this, SLOT(slotReadyRead()));
     connect(m_reply.data(), SIGNAL(metaDataChanged()), this, SLOT(slotMetaDataChanged()));
     connect(m_reply.data(),
             SIGNAL(error(QNetworkReply::NetworkError)),
@@ -94,6 +96,9 @@ void NetworkReply::slotAbort()
 
 void NetworkReply::slotFinished()
 {
+    // emit the data that could be left in streaming mode
+    slotReadyRead();
+
     // determine return code
     switch (m_reply->error()) {
     case QNetworkReply::NoError:
@@ -110,6 +115,30 @@ void NetworkReply::slotFinished()
     emit signalFinished(QVariant::fromValue<int>(m_code));
 }
 
+void NetworkReply::slotReadyRead()
+{
+    if (!m_streaming || m_reply->bytesAvailable() == 0) {
+        return;
+    }
+    // the content of an error reply is needed to parse the error
+    const int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (m_reply->error() != QNetworkReply::NoError || status < 200 || status >= 300) {
+        return;
+    }
+    emit signalDataReceived(m_reply->readAll());
+}
+
+void NetworkReply::setStreaming(const bool streaming)
+{
+    m_streaming = streaming;
+}
+
+qint64 NetworkReply::contentLength() const
+{
+    const QVariant length = m_reply->header(QNetworkRequest::ContentLengthHeader);
+    return length.isValid() ? length.toLongLong() : -1;
+}
+
 void NetworkReply::slotMetaDataChanged()
 {
     QString contentTypeHeader = m_reply->header(QNetworkRequest::ContentTypeHeader).toString();
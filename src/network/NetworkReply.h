@@ -48,6 +48,14 @@ public:
     // true if the reply request was obtained from the disk cache
     bool wasCached() const;
 
+    // in streaming mode the data of a successful reply is emitted with
+    // signalDataReceived() as soon as it arrives instead of being kept
+    // in the reply (getRaw() and getJSON() will only return the data not
+    // emitted yet). The data of failed replies is kept to parse the errors
+    void setStreaming(const bool streaming);
+    // the size of the reply data given by the server (-1 if unknown)
+    qint64 contentLength() const;
+
     // adds an error to the list
     void registerError(QSharedPointer<Error> error);
 
@@ -56,6 +64,7 @@ public slots:
     // These slots are invoked from the Qt network reply object
     void slotAbort();
     void slotFinished();
+    void slotReadyRead();
     void slotMetaDataChanged();
     void slotError(QNetworkReply::NetworkError networkError);
     void slotSslErrors(QList<QSslError> sslErrorList);
@@ -64,6 +73,8 @@ signals:
 
     // signal operation Finished (code = abort, error, ok)
     void signalFinished(QVariant code);
+    // data received in streaming mode (emitted before signalFinished)
+    void signalDataReceived(QByteArray data);
 
 private:
     // Qt network reply
@@ -74,6 +85,8 @@ private:
     ReturnCode m_code;
     // header content type
     QString m_mime;
+    // true if the data is emitted as it arrives
+    bool m_streaming;
 
     Q_DISABLE_COPY(NetworkReply)
 };
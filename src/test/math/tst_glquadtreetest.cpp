@@ -1,5 +1,8 @@
 #include <QtTest/QTest>
 #include <QtCore/QTime>
+#include <QPolygonF>
+#include <QSet>
+#include <cmath>
 #include "math/QuadTree.h"
 
 Q_DECLARE_METATYPE(QList<QPointF>)
@@ -74,6 +77,157 @@ void GLQuadTreeTest::testInsert_data()
     QTest::newRow("simple4") << (points << p[17]) << 13 << true;
 }
 
+void GLQuadTreeTest::testSelectPolygon()
+{
+    QFETCH(QPolygonF, polygon);
+    QFETCH(int, expected);
+
+    // a point in the middle of each cell of the tree (64 points)
+    TestQuadTree quadTree(QSizeF(8.0f, 8.0f));
+    PointList points;
+    for (int y = 0; y < 8; ++y) {
+        for (int x = 0; x < 8; ++x) {
+            points << QPointF(x + 0.5, y + 0.5);
+            QVERIFY2(quadTree.insert(points.last(), points.size() - 1), "Unable to insert point!");
+        }
+    }
+
+    TestQuadTree::PointItemList items;
+    quadTree.select(QuadTreePolygon(polygon), items);
+    QCOMPARE(items.size(), expected);
+
+    // exactly the points inside the polygon are selected
+    QSet<int> selected;
+    for (const auto &item : items) {
+        selected.insert(item.second);
+    }
+    for (int i = 0; i < points.size(); ++i) {
+        QCOMPARE(selected.contains(i), polygon.containsPoint(points[i], Qt::OddEvenFill));
+    }
+}
+
+void GLQuadTreeTest::testSelectPolygon_data()
+{
+    QTest::addColumn<QPolygonF>("polygon");
+    QTest::addColumn<int>("expected");
+
+    QTest::newRow("empty") << QPolygonF() << 0;
+    QTest::newRow("segment") << (QPolygonF() << QPointF(0.1, 0.3) << QPointF(7.7, 7.2)) << 0;
+    QTest::newRow("outside") << (QPolygonF() << QPointF(9.0, 9.0) << QPointF(12.0, 9.0)
+                                             << QPointF(12.0, 12.0))
+                             << 0;
+    QTest::newRow("all") << QPolygonF(QRectF(-1.0, -1.0, 10.0, 10.0)) << 64;
+    QTest::newRow("rectangle") << QPolygonF(QRectF(1.0, 2.0, 3.0, 4.0)) << 12;
+    QTest::newRow("triangle") << (QPolygonF() << QPointF(0.1, 0.2) << QPointF(7.9, 0.1)
+                                              << QPointF(0.2, 7.9))
+                              << 36;
+    // L shape (the cells of the inner corner are not selected)
+    QTest::newRow("concave") << (QPolygonF() << QPointF(0.0, 0.0) << QPointF(2.0, 0.0)
+                                             << QPointF(2.0, 6.0) << QPointF(8.0, 6.0)
+                                             << QPointF(8.0, 8.0) << QPointF(0.0, 8.0))
+                             << 28;
+    // a closed polygon (first vertex repeated) selects the same points
+    QTest::newRow("closed") << (QPolygonF() << QPointF(0.1, 0.2) << QPointF(7.9, 0.1)
+                                            << QPointF(0.2, 7.9) << QPointF(0.1, 0.2))
+                            << 36;
+}
+
+void GLQuadTreeTest::testSelectPolygonRandom()
+{
+    typedef QuadTree<int, 8> RandomQuadTree;
+    RandomQuadTree quadTree(QSizeF(100.0f, 100.0f));
+    PointList points;
+    qsrand(42);
+    for (int i = 0; i < 10000; ++i) {
+        const QPointF point((qrand() % 100000) / 1000.0, (qrand() % 100000) / 1000.0);
+        if (quadTree.insert(point, points.size())) {
+            points << point;
+        }
+    }
+
+    // star shaped polygons with an increasing number of vertices
+    for (int vertices = 3; vertices < 40; vertices += 3) {
+        QPolygonF polygon;
+        for (int i = 0; i < vertices; ++i) {
+            const double angle = (2.0 * M_PI * i) / vertices;
+            const double radius = 10.0 + (qrand() % 40);
+            polygon << QPointF(50.0 + radius * std::cos(angle), 50.0 + radius * std::sin(angle));
+        }
+        const QuadTreePolygon quadTreePolygon(polygon);
+
+        RandomQuadTree::PointItemList items;
+        quadTree.select(quadTreePolygon, items);
+        QSet<int> selected;
+        for (const auto &item : items) {
+            selected.insert(item.second);
+        }
+        QCOMPARE(selected.size(), items.size());
+
+        // the buckets accepted or rejected in bulk give the same result as
+        // testing every point
+        for (int i = 0; i < points.size(); ++i) {
+            QCOMPARE(selected.contains(i), quadTreePolygon.contains(points[i]));
+        }
+    }
+}
+
+void GLQuadTreeTest::testBuild()
+{
+    typedef QuadTree<int, 8> RandomQuadTree;
+    const QuadTreeAABB boundingBox(0.0f, 0.0f, 100.0f, 100.0f);
+    RandomQuadTree insertTree(boundingBox);
+    RandomQuadTree buildTree(boundingBox);
+
+    // random points with some repeated points and points outside the tree
+    RandomQuadTree::PointItemList items;
+    qsrand(42);
+    for (int i = 0; i < 10000; ++i) {
+        const QPointF point((qrand() % 11000) / 100.0, (qrand() % 10000) / 100.0);
+        items << qMakePair(point, i);
+        if (i % 10 == 0) {
+            items << qMakePair(point, -i);
+        }
+    }
+    int inserted = 0;
+    for (const auto &item : items) {
+        inserted += insertTree.insert(item.first, item.second) ? 1 : 0;
+    }
+    QCOMPARE(buildTree.build(items), inserted);
+
+    // the same items are selected by area and by point
+    for (int i = 0; i < 100; ++i) {
+        const QuadTreeAABB area((qrand() % 100), (qrand() % 100), (qrand() % 30), (qrand() % 30));
+        RandomQuadTree::PointItemList insertItems;
+        RandomQuadTree::PointItemList buildItems;
+        insertTree.select(area, insertItems);
+        buildTree.select(area, buildItems);
+        QSet<int> insertSelected;
+        QSet<int> buildSelected;
+        for (const auto &item : insertItems) {
+            insertSelected.insert(item.second);
+        }
+        for (const auto &item : buildItems) {
+            buildSelected.insert(item.second);
+        }
+        QCOMPARE(buildItems.size(), insertItems.size());
+        QCOMPARE(buildSelected, insertSelected);
+    }
+    for (const auto &item : items) {
+        RandomQuadTree::PointItem insertItem(QPointF(), -1);
+        RandomQuadTree::PointItem buildItem(QPointF(), -1);
+        insertTree.select(item.first, insertItem);
+        buildTree.select(item.first, buildItem);
+        QCOMPARE(buildItem.second, insertItem.second);
+    }
+
+    // points can be inserted in a built tree
+    QVERIFY2(!buildTree.insert(items.first().first, 0), "Inserted a repeated point!");
+    QVERIFY2(buildTree.insert(QPointF(50.005, 50.005), -1), "Unable to insert point!");
+    RandomQuadTree::PointItem item(QPointF(), 0);
+    buildTree.select(QPointF(50.005, 50.005), item);
+    QCOMPARE(item.second, -1);
+}
+
 } // namespace unit //
 QTEST_MAIN(unit::GLQuadTreeTest)
 #include "tst_glquadtreetest.moc"
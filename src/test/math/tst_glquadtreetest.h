@@ -27,6 +27,12 @@ private Q_SLOTS:
 
     void testInsert();
     void testInsert_data();
+
+    void testSelectPolygon();
+    void testSelectPolygon_data();
+    void testSelectPolygonRandom();
+
+    void testBuild();
 };
 
 } // namespace unit //
@@ -0,0 +1,140 @@
+#include <QtTest/QTest>
+#include <QPointF>
+
+#include "math/LatticeIndex.h"
+
+#include "tst_latticeindextest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// an array of 4x4 spots with some jitter (the spot in (2, 2) is missing and
+// there are two spots in the cell (3, 3))
+void arraySpots(QVector<float> &x, QVector<float> &y)
+{
+    for (int row = 0; row < 4; ++row) {
+        for (int column = 0; column < 4; ++column) {
+            if (row == 2 && column == 2) {
+                continue;
+            }
+            x << column + ((row + column) % 3 - 1) * 0.1f;
+            y << row + ((row * column) % 3 - 1) * 0.1f;
+        }
+    }
+    x << 3.3f;
+    y << 3.2f;
+}
+}
+
+LatticeIndexTest::LatticeIndexTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void LatticeIndexTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void LatticeIndexTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void LatticeIndexTest::testNearest()
+{
+    QFETCH(QPointF, point);
+    QFETCH(float, distance);
+    QFETCH(int, expected);
+
+    QVector<float> x;
+    QVector<float> y;
+    arraySpots(x, y);
+    LatticeIndex index;
+    index.build(x, y);
+
+    QCOMPARE(index.nearest(point, distance), expected);
+}
+
+void LatticeIndexTest::testNearest_data()
+{
+    QTest::addColumn<QPointF>("point");
+    QTest::addColumn<float>("distance");
+    QTest::addColumn<int>("expected");
+
+    // the spots are numbered row by row skipping the missing one
+    QTest::newRow("exact") << QPointF(-0.1, -0.1) << 0.01f << 0;
+    QTest::newRow("jitter") << QPointF(1.0, 1.0) << 0.5f << 5;
+    QTest::newRow("too_far") << QPointF(1.0, 1.3) << 0.2f << -1;
+    QTest::newRow("missing") << QPointF(2.0, 2.0) << 0.5f << -1;
+    QTest::newRow("next_cell") << QPointF(2.0, 1.8) << 1.2f << 6;
+    QTest::newRow("shared_cell") << QPointF(3.3, 3.1) << 0.5f << 15;
+    QTest::newRow("outside") << QPointF(-3.0, 8.0) << 1.0f << -1;
+}
+
+void LatticeIndexTest::testNearestRandom()
+{
+    // spots of an array with jitter and random points around it
+    QVector<float> x;
+    QVector<float> y;
+    qsrand(42);
+    for (int row = 0; row < 30; ++row) {
+        for (int column = 0; column < 30; ++column) {
+            if (qrand() % 5 != 0) {
+                x << column + (qrand() % 61 - 30) / 100.0f;
+                y << row + (qrand() % 61 - 30) / 100.0f;
+            }
+        }
+    }
+    LatticeIndex index(1.0f);
+    index.build(x, y);
+    QVERIFY(!index.isEmpty());
+
+    // the look up finds the same point as testing every point
+    for (int i = 0; i < 1000; ++i) {
+        const QPointF point((qrand() % 3400 - 200) / 100.0, (qrand() % 3400 - 200) / 100.0);
+        const float distance = (qrand() % 250) / 100.0f;
+        int expected = -1;
+        float expectedDistance = distance * distance;
+        for (int spot = 0; spot < x.size(); ++spot) {
+            const float dx = x.at(spot) - static_cast<float>(point.x());
+            const float dy = y.at(spot) - static_cast<float>(point.y());
+            const float spotDistance = dx * dx + dy * dy;
+            if (spotDistance < expectedDistance
+                || (spotDistance == expectedDistance && expected == -1)) {
+                expected = spot;
+                expectedDistance = spotDistance;
+            }
+        }
+        QCOMPARE(index.nearest(point, distance), expected);
+    }
+
+    index.clear();
+    QVERIFY(index.isEmpty());
+    QCOMPARE(index.nearest(QPointF(1.0, 1.0), 1.0f), -1);
+}
+
+void LatticeIndexTest::testNearestFilter()
+{
+    QVector<float> x;
+    QVector<float> y;
+    arraySpots(x, y);
+    LatticeIndex index;
+    index.build(x, y);
+
+    // the spots rejected by the filter are skipped even if they are nearer
+    const QPointF point(1.0, 1.0);
+    QCOMPARE(index.nearest(point, 1.2f), 5);
+    QCOMPARE(index.nearest(point, 1.2f, [](int spot) { return spot != 5; }), 6);
+    QCOMPARE(index.nearest(point, 1.2f, [](int spot) { return spot != 5 && spot != 6; }), 4);
+    QCOMPARE(index.nearest(point, 0.5f, [](int spot) { return spot != 5; }), -1);
+    QCOMPARE(index.nearest(point, 1.2f, [](int) { return false; }), -1);
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::LatticeIndexTest)
+#include "tst_latticeindextest.moc"
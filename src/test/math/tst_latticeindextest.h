@@ -0,0 +1,28 @@
+#ifndef TST_LATTICEINDEXTEST_H
+#define TST_LATTICEINDEXTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class LatticeIndexTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LatticeIndexTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testNearest();
+    void testNearest_data();
+    void testNearestRandom();
+    void testNearestFilter();
+};
+
+} // namespace unit //
+
+#endif // TST_LATTICEINDEXTEST_H //
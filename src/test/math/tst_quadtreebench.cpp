@@ -0,0 +1,373 @@
+#include <QtTest/QTest>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+
+#include "math/QuadTree.h"
+
+#include "tst_quadtreebench.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// number of spots of a big dataset
+static const int NUM_SPOTS = 50000;
+// number of spots in a row of the array
+static const int ROW_SPOTS = 250;
+// number of areas and points looked up in the select benchmarks
+static const int NUM_QUERIES = 1000;
+
+typedef QuadTree<int, 8> FlatQuadTree;
+typedef FlatQuadTree::PointItem PointItem;
+typedef FlatQuadTree::PointItemList PointItemList;
+
+// the tree previously stored the points of each bucket in its own list
+// (only the insert and select functions are kept)
+class BucketsQuadTree
+{
+public:
+    explicit BucketsQuadTree(const QuadTreeAABB &boundingBox)
+        : m_data(1, Bucket(boundingBox))
+    {
+    }
+
+    bool insert(const QPointF &p, const int t)
+    {
+        if (!m_data[0].aabb.contains(p)) {
+            return false;
+        }
+        int idx = 0;
+        while (true) {
+            Bucket &bucket = m_data[idx];
+            if (bucket.quads[0] >= 0) {
+                const QPointF middle = bucket.aabb.middle();
+                static const int table[] = {0, 1, 3, 2};
+                idx = bucket.quads[table[(p.x() < middle.x() ? 1 : 0)
+                                         + (p.y() < middle.y() ? 2 : 0)]];
+                continue;
+            }
+            for (const PointItem &item : bucket.data) {
+                if (Math::qFuzzyEqual(item.first, p)) {
+                    return false;
+                }
+            }
+            if (bucket.data.size() < 8) {
+                bucket.data.push_back(PointItem(p, t));
+                return true;
+            }
+            smash(idx);
+        }
+    }
+
+    void select(const QuadTreeAABB &b, PointItemList &items) const
+    {
+        QVector<int> indexes(1, 0);
+        while (!indexes.empty()) {
+            const Bucket &bucket = m_data[indexes.back()];
+            indexes.pop_back();
+            if (!bucket.aabb.intersects(b)) {
+                continue;
+            }
+            if (bucket.quads[0] >= 0) {
+                std::copy(bucket.quads.begin(), bucket.quads.end(), std::back_inserter(indexes));
+                continue;
+            }
+            const bool contained = b.contains(bucket.aabb);
+            for (const PointItem &item : bucket.data) {
+                if (contained || b.contains(item.first)) {
+                    items.push_back(item);
+                }
+            }
+        }
+    }
+
+    void select(const QPointF &p, PointItem &item) const
+    {
+        QVector<int> indexes(1, 0);
+        while (!indexes.empty()) {
+            const Bucket &bucket = m_data[indexes.back()];
+            indexes.pop_back();
+            if (!bucket.aabb.contains(p)) {
+                continue;
+            }
+            if (bucket.quads[0] >= 0) {
+                std::copy(bucket.quads.begin(), bucket.quads.end(), std::back_inserter(indexes));
+                continue;
+            }
+            for (const PointItem &data : bucket.data) {
+                if (Math::qFuzzyEqual(p, data.first)) {
+                    item = data;
+                }
+            }
+        }
+    }
+
+private:
+    struct Bucket {
+        explicit Bucket(const QuadTreeAABB &b = QuadTreeAABB())
+            : aabb(b)
+        {
+            quads.fill(-1);
+        }
+
+        QuadTreeAABB aabb;
+        std::array<int, 4> quads;
+        QVector<PointItem> data;
+    };
+
+    void smash(const int idx)
+    {
+        const int head = m_data.size();
+        const QuadTreeAABB aabb = m_data[idx].aabb;
+        m_data.push_back(Bucket(aabb.split(QuadTreeAABB::Q0)));
+        m_data.push_back(Bucket(aabb.split(QuadTreeAABB::Q1)));
+        m_data.push_back(Bucket(aabb.split(QuadTreeAABB::Q2)));
+        m_data.push_back(Bucket(aabb.split(QuadTreeAABB::Q3)));
+        const QVector<PointItem> data = m_data[idx].data;
+        m_data[idx].data.clear();
+        for (int q = 0; q < 4; ++q) {
+            m_data[idx].quads[q] = head + q;
+        }
+        for (const PointItem &item : data) {
+            insert(item.first, item.second);
+        }
+    }
+
+    QVector<Bucket> m_data;
+};
+
+// the layouts and ways to build the tree compared
+enum TreeType { Buckets, FlatInsert, FlatBuild };
+
+const QuadTreeAABB boundingBox()
+{
+    return QuadTreeAABB(0.0f, 0.0f, ROW_SPOTS, NUM_SPOTS / ROW_SPOTS);
+}
+
+// the spots are an array with some jitter given in the order of the features
+// file (row by row)
+PointItemList spotItems()
+{
+    PointItemList items;
+    qsrand(42);
+    for (int i = 0; i < NUM_SPOTS; ++i) {
+        const float jitterX = (qrand() % 100) / 250.0f;
+        const float jitterY = (qrand() % 100) / 250.0f;
+        items.push_back(PointItem(QPointF(i % ROW_SPOTS + jitterX, i / ROW_SPOTS + jitterY), i));
+    }
+    return items;
+}
+
+// the areas of a rubber band selection of a few rows/columns of spots
+QVector<QuadTreeAABB> selectionAreas()
+{
+    QVector<QuadTreeAABB> areas;
+    qsrand(7);
+    const QuadTreeAABB border = boundingBox();
+    for (int i = 0; i < NUM_QUERIES; ++i) {
+        areas.push_back(QuadTreeAABB(qrand() % static_cast<int>(border.width),
+                                     qrand() % static_cast<int>(border.height),
+                                     1 + qrand() % 20,
+                                     1 + qrand() % 20));
+    }
+    return areas;
+}
+
+void fillFlat(FlatQuadTree &tree, const PointItemList &items, const TreeType type)
+{
+    if (type == FlatBuild) {
+        tree.build(items);
+    } else {
+        for (const PointItem &item : items) {
+            tree.insert(item.first, item.second);
+        }
+    }
+}
+
+void addTypes()
+{
+    QTest::addColumn<int>("type");
+
+    QTest::newRow("buckets") << static_cast<int>(Buckets);
+    QTest::newRow("flat_insert") << static_cast<int>(FlatInsert);
+    QTest::newRow("flat_build") << static_cast<int>(FlatBuild);
+}
+}
+
+QuadTreeBench::QuadTreeBench(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void QuadTreeBench::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void QuadTreeBench::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void QuadTreeBench::benchBuild()
+{
+    QFETCH(int, type);
+
+    const PointItemList items = spotItems();
+    if (type == Buckets) {
+        QBENCHMARK
+        {
+            BucketsQuadTree tree(boundingBox());
+            for (const PointItem &item : items) {
+                tree.insert(item.first, item.second);
+            }
+        }
+    } else {
+        QBENCHMARK
+        {
+            FlatQuadTree tree(boundingBox());
+            fillFlat(tree, items, static_cast<TreeType>(type));
+        }
+    }
+}
+
+void QuadTreeBench::benchBuild_data()
+{
+    addTypes();
+}
+
+void QuadTreeBench::benchInsert()
+{
+    QFETCH(int, type);
+
+    // half of the spots are in the tree and the other half are inserted
+    const PointItemList items = spotItems();
+    PointItemList initial;
+    PointItemList inserted;
+    for (int i = 0; i < items.size(); ++i) {
+        (i % 2 == 0 ? initial : inserted).push_back(items.at(i));
+    }
+    if (type == Buckets) {
+        BucketsQuadTree tree(boundingBox());
+        for (const PointItem &item : initial) {
+            tree.insert(item.first, item.second);
+        }
+        QBENCHMARK_ONCE
+        {
+            for (const PointItem &item : inserted) {
+                QVERIFY(tree.insert(item.first, item.second));
+            }
+        }
+    } else {
+        FlatQuadTree tree(boundingBox());
+        fillFlat(tree, initial, static_cast<TreeType>(type));
+        QBENCHMARK_ONCE
+        {
+            for (const PointItem &item : inserted) {
+                QVERIFY(tree.insert(item.first, item.second));
+            }
+        }
+    }
+}
+
+void QuadTreeBench::benchInsert_data()
+{
+    addTypes();
+}
+
+void QuadTreeBench::benchSelect()
+{
+    QFETCH(int, type);
+
+    const PointItemList items = spotItems();
+    const QVector<QuadTreeAABB> areas = selectionAreas();
+    PointItemList selected;
+    int count = 0;
+    if (type == Buckets) {
+        BucketsQuadTree tree(boundingBox());
+        for (const PointItem &item : items) {
+            tree.insert(item.first, item.second);
+        }
+        QBENCHMARK
+        {
+            count = 0;
+            for (const QuadTreeAABB &area : areas) {
+                selected.clear();
+                tree.select(area, selected);
+                count += selected.size();
+            }
+        }
+    } else {
+        FlatQuadTree tree(boundingBox());
+        fillFlat(tree, items, static_cast<TreeType>(type));
+        QBENCHMARK
+        {
+            count = 0;
+            for (const QuadTreeAABB &area : areas) {
+                selected.clear();
+                tree.select(area, selected);
+                count += selected.size();
+            }
+        }
+    }
+    qDebug() << count << "spots selected";
+}
+
+void QuadTreeBench::benchSelect_data()
+{
+    addTypes();
+}
+
+void QuadTreeBench::benchSelectPoint()
+{
+    QFETCH(int, type);
+
+    // the spots are looked up in random order
+    const PointItemList items = spotItems();
+    QVector<QPointF> points;
+    for (int i = 0; i < NUM_QUERIES; ++i) {
+        points.push_back(items.at(qrand() % items.size()).first);
+    }
+    PointItem item(QPointF(), -1);
+    int found = 0;
+    if (type == Buckets) {
+        BucketsQuadTree tree(boundingBox());
+        for (const PointItem &spot : items) {
+            tree.insert(spot.first, spot.second);
+        }
+        QBENCHMARK
+        {
+            found = 0;
+            for (const QPointF &point : points) {
+                tree.select(point, item);
+                found += item.second >= 0 ? 1 : 0;
+            }
+        }
+    } else {
+        FlatQuadTree tree(boundingBox());
+        fillFlat(tree, items, static_cast<TreeType>(type));
+        QBENCHMARK
+        {
+            found = 0;
+            for (const QPointF &point : points) {
+                tree.select(point, item);
+                found += item.second >= 0 ? 1 : 0;
+            }
+        }
+    }
+    QCOMPARE(found, points.size());
+}
+
+void QuadTreeBench::benchSelectPoint_data()
+{
+    addTypes();
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::QuadTreeBench)
+#include "tst_quadtreebench.moc"
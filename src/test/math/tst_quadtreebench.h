@@ -0,0 +1,38 @@
+#ifndef TST_QUADTREEBENCH_H
+#define TST_QUADTREEBENCH_H
+
+#include <QObject>
+
+namespace unit
+{
+
+// benchmarks of the QuadTree with the points of all the buckets in a single
+// list (built point by point or in one pass sorted in Z order) against the
+// previous layout with a list of points per bucket
+class QuadTreeBench : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QuadTreeBench(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchBuild();
+    void benchBuild_data();
+
+    void benchInsert();
+    void benchInsert_data();
+
+    void benchSelect();
+    void benchSelect_data();
+
+    void benchSelectPoint();
+    void benchSelectPoint_data();
+};
+
+} // namespace unit //
+
+#endif // TST_QUADTREEBENCH_H
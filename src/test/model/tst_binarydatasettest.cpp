@@ -0,0 +1,146 @@
+#include <QtTest/QTest>
+#include <QTemporaryDir>
+
+#include "data/BinaryDataset.h"
+#include "dataModel/FeatureStore.h"
+
+#include "tst_binarydatasettest.h"
+
+namespace unit
+{
+
+BinaryDatasetTest::BinaryDatasetTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void BinaryDatasetTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void BinaryDatasetTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void BinaryDatasetTest::testWriteAndOpen()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.path() + "/dataset.stb";
+
+    FeatureStore features;
+    features.addFeature("Actb", 10.5, 2.0, 3);
+    features.addFeature("Gapdh", 11.0, 2.0, 7);
+    features.addFeature("Géne", 10.5, 2.0, 1);
+    features.addFeature("Actb", 11.0, 2.0, 2);
+    const QRect chip(QPoint(2, 2), QPoint(32, 34));
+    const QTransform alignment(1.5, 0.0, 0.0, 0.0, 1.5, 0.0, 10.0, 20.0, 1.0);
+    QVERIFY(BinaryDataset::write(filename, features, chip, alignment));
+    QVERIFY(BinaryDataset::isBinaryFile(filename));
+
+    BinaryDataset dataset;
+    QVERIFY(dataset.open(filename));
+    QCOMPARE(dataset.genesCount(), 3);
+    QCOMPARE(dataset.spotsCount(), 2);
+    QCOMPARE(dataset.countsCount(), 4);
+    QCOMPARE(dataset.geneName(0), QString("Actb"));
+    QCOMPARE(dataset.geneName(1), QString("Gapdh"));
+    QCOMPARE(dataset.geneName(2), QString("Géne"));
+    QCOMPARE(dataset.chipDimensions(), chip);
+    QCOMPARE(dataset.alignmentMatrix(), alignment);
+
+    // spots in order of appearance, counts grouped by spot
+    QCOMPARE(dataset.spotsX()[0], 10.5f);
+    QCOMPARE(dataset.spotsX()[1], 11.0f);
+    QCOMPARE(dataset.spotsY()[0], 2.0f);
+    const quint32 offsets[] = {0, 2, 4};
+    const quint32 genes[] = {0, 2, 1, 0};
+    const quint32 counts[] = {3, 1, 7, 2};
+    for (int i = 0; i < 3; ++i) {
+        QCOMPARE(dataset.spotsOffsets()[i], offsets[i]);
+    }
+    for (int i = 0; i < 4; ++i) {
+        QCOMPARE(dataset.genesIndexes()[i], genes[i]);
+        QCOMPARE(dataset.counts()[i], counts[i]);
+    }
+
+    dataset.close();
+    QVERIFY(!dataset.isOpen());
+}
+
+void BinaryDatasetTest::testConvert()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.path() + "/converted.stb";
+
+    const QByteArray rawData("[{\"barcode\": \"A\", \"gene\": \"Actb\", \"hits\": 3, "
+                             "\"x\": 10, \"y\": 22},"
+                             "{\"barcode\": \"A\", \"gene\": \"Gapdh\", \"hits\": 1, "
+                             "\"x\": 10, \"y\": 22},"
+                             "{\"barcode\": \"B\", \"gene\": \"Actb\", \"hits\": 7, "
+                             "\"x\": 12, \"y\": 21}]");
+    QVERIFY(BinaryDataset::convert(rawData, filename, QRect(), QTransform()));
+
+    BinaryDataset dataset;
+    QVERIFY(dataset.open(filename));
+    QCOMPARE(dataset.genesCount(), 2);
+    QCOMPARE(dataset.spotsCount(), 2);
+    QCOMPARE(dataset.countsCount(), 3);
+    QCOMPARE(dataset.counts()[2], 7u);
+
+    QVERIFY(!BinaryDataset::convert(QByteArray("[{\"gene\": "), filename, QRect(), QTransform()));
+}
+
+void BinaryDatasetTest::testOpenInvalid()
+{
+    QFETCH(QByteArray, content);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.path() + "/invalid.stb";
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(content);
+    file.close();
+
+    BinaryDataset dataset;
+    QVERIFY(!dataset.open(filename));
+    QVERIFY(!dataset.isOpen());
+}
+
+void BinaryDatasetTest::testOpenInvalid_data()
+{
+    QTest::addColumn<QByteArray>("content");
+
+    // a valid file to be corrupted
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.path() + "/valid.stb";
+    FeatureStore features;
+    features.addFeature("Actb", 10.0, 2.0, 3);
+    features.addFeature("Gapdh", 11.0, 2.0, 7);
+    QVERIFY(BinaryDataset::write(filename, features, QRect(), QTransform()));
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray valid = file.readAll();
+
+    QByteArray wrong_version(valid);
+    wrong_version[8] = 2;
+    // the gene indexes are followed by the counts at the end of the file
+    QByteArray wrong_gene(valid);
+    wrong_gene[valid.size() - 12] = 100;
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("json") << QByteArray("[{\"gene\": \"Actb\", \"hits\": 3, \"x\": 1, \"y\": 2}]");
+    QTest::newRow("truncated") << valid.left(valid.size() - 4);
+    QTest::newRow("wrong_version") << wrong_version;
+    QTest::newRow("wrong_gene_index") << wrong_gene;
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::BinaryDatasetTest)
+#include "tst_binarydatasettest.moc"
@@ -0,0 +1,28 @@
+#ifndef TST_BINARYDATASETTEST_H
+#define TST_BINARYDATASETTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class BinaryDatasetTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BinaryDatasetTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testWriteAndOpen();
+    void testConvert();
+    void testOpenInvalid();
+    void testOpenInvalid_data();
+};
+
+} // namespace unit //
+
+#endif // TST_BINARYDATASETTEST_H
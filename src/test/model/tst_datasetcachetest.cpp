@@ -0,0 +1,119 @@
+#include <QtTest/QTest>
+
+#include "data/DatasetCache.h"
+
+#include "tst_datasetcachetest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// creates a dataset content whose size is dominated by the image
+DatasetContent createContent(const QString &gene, const int imageSize)
+{
+    DatasetContent content;
+    content.features.addFeature(gene, 1.0, 2.0, 3);
+    content.figureBlue = QByteArray(imageSize, 'b');
+    content.lastModified = "1";
+    return content;
+}
+}
+
+DatasetCacheTest::DatasetCacheTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void DatasetCacheTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void DatasetCacheTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void DatasetCacheTest::testFind()
+{
+    DatasetCache cache(1024 * 1024);
+    const DatasetContent content = createContent("Actb", 1000);
+    DatasetContent cached;
+    QVERIFY(!cache.find("A", "1", cached));
+    cache.insert("A", content);
+    QVERIFY(cache.contains("A"));
+    QCOMPARE(cache.size(), content.memorySize());
+
+    QVERIFY(cache.find("A", "1", cached));
+    QVERIFY(cached.features == content.features);
+    QCOMPARE(cached.figureBlue, content.figureBlue);
+    QCOMPARE(cache.hits(), 1);
+    QCOMPARE(cache.misses(), 1);
+
+    cache.remove("A");
+    QVERIFY(!cache.contains("A"));
+    QCOMPARE(cache.size(), qint64(0));
+}
+
+void DatasetCacheTest::testModified()
+{
+    DatasetCache cache(1024 * 1024);
+    cache.insert("A", createContent("Actb", 1000));
+
+    // the content of a modified dataset is not valid anymore
+    DatasetContent cached;
+    QVERIFY(!cache.find("A", "2", cached));
+    QVERIFY(!cache.contains("A"));
+    QCOMPARE(cache.misses(), 1);
+    QCOMPARE(cache.size(), qint64(0));
+}
+
+void DatasetCacheTest::testEviction()
+{
+    const DatasetContent content = createContent("Actb", 10000);
+    // room for two datasets
+    DatasetCache cache(content.memorySize() * 2 + content.memorySize() / 2);
+    cache.insert("A", content);
+    cache.insert("B", createContent("Gapdh", 10000));
+
+    // A becomes the most recently used one so B is evicted
+    DatasetContent cached;
+    QVERIFY(cache.find("A", "1", cached));
+    cache.insert("C", createContent("Mbp", 10000));
+    QCOMPARE(cache.count(), 2);
+    QVERIFY(cache.contains("A"));
+    QVERIFY(!cache.contains("B"));
+    QVERIFY(cache.contains("C"));
+    QVERIFY(cache.size() <= cache.budget());
+
+    // contents bigger than the budget are not cached
+    cache.insert("D", createContent("Actb", 100000));
+    QVERIFY(!cache.contains("D"));
+    QCOMPARE(cache.count(), 2);
+}
+
+void DatasetCacheTest::testBudget()
+{
+    const DatasetContent content = createContent("Actb", 10000);
+    DatasetCache cache(content.memorySize() * 10);
+    cache.insert("A", content);
+    cache.insert("B", createContent("Gapdh", 10000));
+    cache.insert("C", createContent("Mbp", 10000));
+    QCOMPARE(cache.count(), 3);
+
+    // lowering the budget evicts the least recently used datasets
+    cache.budget(content.memorySize() + content.memorySize() / 2);
+    QCOMPARE(cache.count(), 1);
+    QVERIFY(cache.contains("C"));
+
+    cache.clear();
+    QCOMPARE(cache.count(), 0);
+    QCOMPARE(cache.size(), qint64(0));
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::DatasetCacheTest)
+#include "tst_datasetcachetest.moc"
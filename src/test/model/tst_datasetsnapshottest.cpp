@@ -0,0 +1,179 @@
+#include <QtTest/QTest>
+#include <QTemporaryDir>
+#include <QFile>
+
+#include <algorithm>
+
+#include "data/DatasetSnapshot.h"
+
+#include "tst_datasetsnapshottest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// creates a small set of features with its indexes and cut-offs
+FeatureStore createFeatures()
+{
+    FeatureStore features;
+    features.addFeature("Actb", 10.5, 2.0, 3);
+    features.addFeature("Gapdh", 10.5, 2.0, 7);
+    features.addFeature("Actb", 11.0, 2.0, 1);
+    features.addFeature("Actb", 12.0, 3.0, 9);
+    features.addFeature("Mbp", 12.0, 3.0, 2);
+    features.buildIndexes();
+    features.computeGeneCutoffs();
+    return features;
+}
+}
+
+DatasetSnapshotTest::DatasetSnapshotTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void DatasetSnapshotTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void DatasetSnapshotTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void DatasetSnapshotTest::testWriteAndRead()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const DatasetSnapshot snapshot(dir.path());
+    const FeatureStore features = createFeatures();
+
+    FeatureStore read;
+    QVERIFY(!snapshot.read("dataset", "1", read));
+    QVERIFY(DatasetSnapshot::write(snapshot.fileName("dataset"), "dataset", "1", features));
+    QVERIFY(snapshot.read("dataset", "1", read));
+
+    // same features, indexes and cut-offs
+    QVERIFY(read == features);
+    QVERIFY(read.hasIndexes());
+    QCOMPARE(read.spotOffsets(), features.spotOffsets());
+    QCOMPARE(read.spotFeatures(), features.spotFeatures());
+    QCOMPARE(read.geneOffsets(), features.geneOffsets());
+    QCOMPARE(read.geneFeatures(), features.geneFeatures());
+    QCOMPARE(read.geneCutoffs(), features.geneCutoffs());
+
+    // the look ups are built as well
+    QCOMPARE(read.addGene("Mbp"), 2u);
+    QCOMPARE(read.addSpot(12.0, 3.0), 2u);
+
+    snapshot.remove("dataset");
+    QVERIFY(!QFile::exists(snapshot.fileName("dataset")));
+}
+
+void DatasetSnapshotTest::testOutdated()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const DatasetSnapshot snapshot(dir.path());
+    QVERIFY(DatasetSnapshot::write(snapshot.fileName("dataset"), "dataset", "1", createFeatures()));
+
+    // the dataset was modified so the snapshot is removed
+    FeatureStore read;
+    QVERIFY(!snapshot.read("dataset", "2", read));
+    QVERIFY(read.isEmpty());
+    QVERIFY(!QFile::exists(snapshot.fileName("dataset")));
+}
+
+void DatasetSnapshotTest::testContains()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const DatasetSnapshot snapshot(dir.path());
+    QVERIFY(!snapshot.contains("dataset", "1"));
+    QVERIFY(DatasetSnapshot::write(snapshot.fileName("dataset"), "dataset", "1", createFeatures()));
+
+    // only the key is checked and the outdated snapshot is not removed
+    QVERIFY(snapshot.contains("dataset", "1"));
+    QVERIFY(!snapshot.contains("dataset", "2"));
+    QVERIFY(!snapshot.contains("dataset2", "1"));
+    QVERIFY(QFile::exists(snapshot.fileName("dataset")));
+}
+
+void DatasetSnapshotTest::testReadProgress()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const DatasetSnapshot snapshot(dir.path());
+    const QString filename = snapshot.fileName("dataset");
+    QVERIFY(DatasetSnapshot::write(filename, "dataset", "1", createFeatures()));
+
+    // the bytes read grow up to the size of the file
+    QVector<qint64> progress;
+    FeatureStore read;
+    QVERIFY(snapshot.read("dataset", "1", read, [&progress](qint64 bytes) {
+        progress.push_back(bytes);
+        return true;
+    }));
+    QVERIFY(!progress.isEmpty());
+    QVERIFY(std::is_sorted(progress.begin(), progress.end()));
+    QCOMPARE(progress.last(), QFile(filename).size());
+
+    // a cancelled read does not remove the snapshot
+    read.clear();
+    QVERIFY(!snapshot.read("dataset", "1", read, [](qint64) { return false; }));
+    QVERIFY(read.isEmpty());
+    QVERIFY(QFile::exists(filename));
+    QVERIFY(snapshot.read("dataset", "1", read));
+}
+
+void DatasetSnapshotTest::testReadInvalid()
+{
+    QFETCH(int, size);
+    QFETCH(int, position);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const DatasetSnapshot snapshot(dir.path());
+    const QString filename = snapshot.fileName("dataset");
+    QVERIFY(DatasetSnapshot::write(filename, "dataset", "1", createFeatures()));
+
+    // truncate the file or corrupt one byte
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QByteArray content = file.readAll();
+    if (size >= 0) {
+        content.truncate(size);
+    } else {
+        content[position] = static_cast<char>(0xFF);
+    }
+    file.resize(0);
+    file.write(content);
+    file.close();
+
+    FeatureStore read;
+    QVERIFY(!snapshot.read("dataset", "1", read));
+    QVERIFY(!QFile::exists(filename));
+}
+
+void DatasetSnapshotTest::testReadInvalid_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("position");
+
+    QTest::newRow("empty") << 0 << 0;
+    QTest::newRow("header_only") << 144 << 0;
+    QTest::newRow("truncated") << 300 << 0;
+    QTest::newRow("magic") << -1 << 0;
+    QTest::newRow("version") << -1 << 8;
+    QTest::newRow("key") << -1 << 144;
+    // first gene id of the features column (after the header, key, names and spots)
+    QTest::newRow("gene_id") << -1 << 144 + 16 + 16 + 16 + 16 + 16 + 3;
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::DatasetSnapshotTest)
+#include "tst_datasetsnapshottest.moc"
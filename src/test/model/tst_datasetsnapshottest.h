@@ -0,0 +1,30 @@
+#ifndef TST_DATASETSNAPSHOTTEST_H
+#define TST_DATASETSNAPSHOTTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class DatasetSnapshotTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DatasetSnapshotTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testWriteAndRead();
+    void testOutdated();
+    void testContains();
+    void testReadProgress();
+    void testReadInvalid();
+    void testReadInvalid_data();
+};
+
+} // namespace unit //
+
+#endif // TST_DATASETSNAPSHOTTEST_H
@@ -0,0 +1,89 @@
+#include <QtTest/QTest>
+
+#include "data/FeaturesParser.h"
+
+#include "tst_featuresparserbench.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// number of unique genes of the generated datasets
+static const int NUM_GENES = 20000;
+
+// generates a features JSON array with random genes, coordinates and counts
+// (same format as the one given by the server)
+QByteArray generateFeatures(const int num_features)
+{
+    qsrand(42);
+    QByteArray rawData;
+    rawData.reserve(num_features * 80);
+    rawData.append("[");
+    for (int i = 0; i < num_features; ++i) {
+        rawData.append(i == 0 ? "{\"barcode\": \"B" : ", {\"barcode\": \"B")
+            .append(QByteArray::number(i))
+            .append("\", \"gene\": \"Gene")
+            .append(QByteArray::number(qrand() % NUM_GENES))
+            .append("\", \"hits\": ")
+            .append(QByteArray::number(1 + qrand() % 500))
+            .append(", \"x\": ")
+            .append(QByteArray::number(1 + (qrand() % 3300) / 100.0))
+            .append(", \"y\": ")
+            .append(QByteArray::number(1 + (qrand() % 3500) / 100.0))
+            .append("}");
+    }
+    rawData.append("]");
+    return rawData;
+}
+}
+
+FeaturesParserBench::FeaturesParserBench(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void FeaturesParserBench::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void FeaturesParserBench::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void FeaturesParserBench::benchParseFeatures()
+{
+    QFETCH(int, features);
+    QFETCH(bool, parallel);
+
+    const QByteArray rawData = generateFeatures(features);
+    QBENCHMARK_ONCE
+    {
+        FeatureStore parsedFeatures;
+        const bool parsedOk = parallel ? data::parseFeaturesParallel(rawData, parsedFeatures)
+                                       : data::parseFeatures(rawData, parsedFeatures);
+        QVERIFY(parsedOk);
+        QCOMPARE(parsedFeatures.size(), features);
+    }
+}
+
+void FeaturesParserBench::benchParseFeatures_data()
+{
+    QTest::addColumn<int>("features");
+    QTest::addColumn<bool>("parallel");
+
+    QTest::newRow("1M_single") << 1000000 << false;
+    QTest::newRow("1M_parallel") << 1000000 << true;
+    QTest::newRow("5M_single") << 5000000 << false;
+    QTest::newRow("5M_parallel") << 5000000 << true;
+    QTest::newRow("10M_single") << 10000000 << false;
+    QTest::newRow("10M_parallel") << 10000000 << true;
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::FeaturesParserBench)
+#include "tst_featuresparserbench.moc"
@@ -0,0 +1,27 @@
+#ifndef TST_FEATURESPARSERBENCH_H
+#define TST_FEATURESPARSERBENCH_H
+
+#include <QObject>
+
+namespace unit
+{
+
+// benchmarks of the single threaded and the parallel features parsers
+class FeaturesParserBench : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FeaturesParserBench(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchParseFeatures();
+    void benchParseFeatures_data();
+};
+
+} // namespace unit //
+
+#endif // TST_FEATURESPARSERBENCH_H
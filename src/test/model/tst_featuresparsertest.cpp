@@ -0,0 +1,251 @@
+#include <QtTest/QTest>
+#include <QJsonDocument>
+#include <QtConcurrent>
+
+#include "data/FeaturesParser.h"
+#include "data/ObjectParser.h"
+#include "dataModel/FeatureDTO.h"
+#include "dataModel/Feature.h"
+
+#include "tst_featuresparsertest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// reference parsing path (JSON -> QVariantMap -> ObjectParser -> FeatureDTO)
+// the typed parser must give exactly the same output as this one
+bool parseFeaturesVariant(const QByteArray &rawData, FeatureStore &features)
+{
+    const QJsonDocument doc = QJsonDocument::fromJson(rawData);
+    if (doc.isNull() || !doc.isArray()) {
+        return false;
+    }
+    for (const QVariant &var : doc.toVariant().toList()) {
+        FeatureDTO dto;
+        data::parseObject(var, &dto);
+        const Feature &feature = dto.feature();
+        features.addFeature(feature.gene(), feature.x(), feature.y(), feature.count());
+    }
+    return true;
+}
+
+// generates a features JSON array with random genes, coordinates and counts
+QByteArray generateFeatures(const int num_features, const int num_genes)
+{
+    qsrand(42);
+    QByteArray rawData("[");
+    for (int i = 0; i < num_features; ++i) {
+        const QString object
+            = QString("{\"barcode\": \"B%1\", \"gene\": \"Gene%2\", \"hits\": %3, "
+                      "\"x\": %4, \"y\": %5}")
+                  .arg(i)
+                  .arg(qrand() % num_genes)
+                  .arg(1 + qrand() % 500)
+                  .arg(1 + (qrand() % 3300) / 100.0)
+                  .arg(1 + (qrand() % 3500) / 100.0);
+        rawData.append(i == 0 ? "" : ",").append(object.toUtf8());
+    }
+    rawData.append("]");
+    return rawData;
+}
+}
+
+FeaturesParserTest::FeaturesParserTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void FeaturesParserTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void FeaturesParserTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void FeaturesParserTest::testParseFeatures()
+{
+    QFETCH(QByteArray, rawData);
+    QFETCH(int, features);
+    QFETCH(int, genes);
+
+    FeatureStore expectedFeatures;
+    QVERIFY(parseFeaturesVariant(rawData, expectedFeatures));
+
+    FeatureStore parsedFeatures;
+    QVERIFY(data::parseFeatures(rawData, parsedFeatures));
+
+    QCOMPARE(parsedFeatures.size(), features);
+    QCOMPARE(parsedFeatures.genesCount(), genes);
+    // same features, genes and spots (with the same ids)
+    QVERIFY(parsedFeatures == expectedFeatures);
+}
+
+void FeaturesParserTest::testParseFeatures_data()
+{
+    QTest::addColumn<QByteArray>("rawData");
+    QTest::addColumn<int>("features");
+    QTest::addColumn<int>("genes");
+
+    QTest::newRow("empty") << QByteArray("[]") << 0 << 0;
+    QTest::newRow("single") << QByteArray("[{\"gene\": \"Actb\", \"hits\": 3, "
+                                          "\"x\": 10.5, \"y\": 22.25}]")
+                            << 1 << 1;
+    QTest::newRow("shared_gene") << QByteArray("[{\"gene\": \"Actb\", \"hits\": 3, "
+                                               "\"x\": 10, \"y\": 22},"
+                                               "{\"gene\": \"Actb\", \"hits\": 1, "
+                                               "\"x\": 11, \"y\": 22},"
+                                               "{\"gene\": \"Gapdh\", \"hits\": 7, "
+                                               "\"x\": 10, \"y\": 22}]")
+                                 << 3 << 2;
+    QTest::newRow("key_order") << QByteArray("[{\"y\": 4.5, \"hits\": 12, \"barcode\": "
+                                             "\"ACGT\", \"x\": 30.75, \"gene\": \"Mbp\"}]")
+                               << 1 << 1;
+    QTest::newRow("unicode_gene") << QByteArray("[{\"gene\": \"G\\u00e9ne\", \"hits\": 2, "
+                                                "\"x\": 1, \"y\": 2}]")
+                                  << 1 << 1;
+    QTest::newRow("generated") << generateFeatures(10000, 500) << 10000 << 500;
+}
+
+void FeaturesParserTest::testParseInvalid()
+{
+    QFETCH(QByteArray, rawData);
+
+    FeatureStore parsedFeatures;
+    QVERIFY(!data::parseFeatures(rawData, parsedFeatures));
+}
+
+void FeaturesParserTest::testParseInvalid_data()
+{
+    QTest::addColumn<QByteArray>("rawData");
+
+    QTest::newRow("truncated") << QByteArray("[{\"gene\": \"Actb\", \"hits\": 3, ");
+    QTest::newRow("null_value") << QByteArray("[{\"gene\": \"Actb\", \"hits\": null, "
+                                              "\"x\": 1, \"y\": 2}]");
+    QTest::newRow("bool_value") << QByteArray("[{\"gene\": \"Actb\", \"hits\": true, "
+                                              "\"x\": 1, \"y\": 2}]");
+    QTest::newRow("missing_gene") << QByteArray("[{\"hits\": 3, \"x\": 1, \"y\": 2}]");
+}
+
+void FeaturesParserTest::testParseParallel()
+{
+    QFETCH(QByteArray, rawData);
+    QFETCH(int, chunks);
+
+    FeatureStore expectedFeatures;
+    QVERIFY(data::parseFeatures(rawData, expectedFeatures));
+
+    FeatureStore parsedFeatures;
+    QVERIFY(data::parseFeaturesParallel(rawData,
+                                        parsedFeatures,
+                                        data::ParseProgressCallback(),
+                                        chunks));
+
+    QCOMPARE(parsedFeatures.size(), expectedFeatures.size());
+    QVERIFY(parsedFeatures == expectedFeatures);
+}
+
+void FeaturesParserTest::testParseParallel_data()
+{
+    QTest::addColumn<QByteArray>("rawData");
+    QTest::addColumn<int>("chunks");
+
+    const QByteArray generated = generateFeatures(10000, 500);
+    QTest::newRow("empty") << QByteArray("[]") << 4;
+    QTest::newRow("single") << QByteArray("[{\"gene\": \"Actb\", \"hits\": 3, "
+                                          "\"x\": 10.5, \"y\": 22.25}]")
+                            << 4;
+    QTest::newRow("brace_in_string") << QByteArray("[{\"gene\": \"A},{b\", \"hits\": 3, "
+                                                   "\"x\": 10, \"y\": 22},"
+                                                   "{\"gene\": \"Gapdh\", \"hits\": 7, "
+                                                   "\"x\": 10, \"y\": 22}]")
+                                     << 8;
+    QTest::newRow("generated_1") << generated << 1;
+    QTest::newRow("generated_2") << generated << 2;
+    QTest::newRow("generated_7") << generated << 7;
+    QTest::newRow("generated_32") << generated << 32;
+    QTest::newRow("generated_auto") << generated << 0;
+}
+
+void FeaturesParserTest::testParseParallelInvalid()
+{
+    QFETCH(QByteArray, rawData);
+
+    FeatureStore parsedFeatures;
+    QVERIFY(!data::parseFeaturesParallel(rawData,
+                                         parsedFeatures,
+                                         data::ParseProgressCallback(),
+                                         4));
+}
+
+void FeaturesParserTest::testParseParallelInvalid_data()
+{
+    testParseInvalid_data();
+
+    const QByteArray feature("{\"gene\": \"Actb\", \"hits\": 3, \"x\": 1, \"y\": 2}");
+    QTest::newRow("trailing_comma") << QByteArray("[" + feature + "," + feature + ",]");
+    QTest::newRow("missing_comma") << QByteArray("[" + feature + feature + "]");
+    QTest::newRow("trailing_data") << QByteArray("[" + feature + "," + feature + "],");
+}
+
+void FeaturesParserTest::testParseStream()
+{
+    QFETCH(QByteArray, rawData);
+    QFETCH(int, chunkSize);
+    QFETCH(bool, valid);
+
+    FeatureStore expectedFeatures;
+    QCOMPARE(data::parseFeatures(rawData, expectedFeatures), valid);
+
+    // the stream is parsed in a worker thread while the data is added
+    data::FeaturesStream stream;
+    FeatureStore parsedFeatures;
+    QFuture<bool> parsing = QtConcurrent::run([&]() { return stream.parse(parsedFeatures); });
+    for (int i = 0; i < rawData.size(); i += chunkSize) {
+        stream.addData(rawData.mid(i, chunkSize));
+    }
+    stream.finish();
+
+    QCOMPARE(parsing.result(), valid);
+    if (valid) {
+        QCOMPARE(parsedFeatures.size(), expectedFeatures.size());
+        QVERIFY(parsedFeatures == expectedFeatures);
+    }
+}
+
+void FeaturesParserTest::testParseStream_data()
+{
+    QTest::addColumn<QByteArray>("rawData");
+    QTest::addColumn<int>("chunkSize");
+    QTest::addColumn<bool>("valid");
+
+    const QByteArray generated = generateFeatures(10000, 500);
+    QTest::newRow("empty") << QByteArray("[]") << 1 << true;
+    QTest::newRow("generated_1") << generated << 1 << true;
+    QTest::newRow("generated_7") << generated << 7 << true;
+    QTest::newRow("generated_4096") << generated << 4096 << true;
+    QTest::newRow("generated_whole") << generated << generated.size() << true;
+    QTest::newRow("truncated") << generated.left(generated.size() / 2) << 4096 << false;
+    QTest::newRow("trailing_data") << QByteArray(generated + "[]") << 4096 << false;
+}
+
+void FeaturesParserTest::testParseStreamCancelled()
+{
+    data::FeaturesStream stream;
+    FeatureStore parsedFeatures;
+    QFuture<bool> parsing = QtConcurrent::run([&]() { return stream.parse(parsedFeatures); });
+    // the stream is cancelled once all the data is added but before it is finished
+    stream.addData(QByteArray("[{\"gene\": \"Actb\", \"hits\": 3, \"x\": 1, \"y\": 2}]"));
+    stream.cancel();
+    QVERIFY(!parsing.result());
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::FeaturesParserTest)
+#include "tst_featuresparsertest.moc"
@@ -0,0 +1,40 @@
+#ifndef TST_FEATURESPARSERTEST_H
+#define TST_FEATURESPARSERTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class FeaturesParserTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FeaturesParserTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testParseFeatures();
+    void testParseFeatures_data();
+
+    void testParseInvalid();
+    void testParseInvalid_data();
+
+    void testParseParallel();
+    void testParseParallel_data();
+
+    void testParseParallelInvalid();
+    void testParseParallelInvalid_data();
+
+    void testParseStream();
+    void testParseStream_data();
+
+    void testParseStreamCancelled();
+};
+
+} // namespace unit //
+
+#endif // TST_FEATURESPARSERTEST_H
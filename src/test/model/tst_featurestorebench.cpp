@@ -0,0 +1,152 @@
+#include <QtTest/QTest>
+#include <QList>
+
+#include <memory>
+#include <numeric>
+
+#include "dataModel/FeatureStore.h"
+#include "dataModel/Feature.h"
+
+#include "tst_featurestorebench.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// number of unique genes of the generated datasets
+static const int NUM_GENES = 20000;
+
+// the features were previously stored as a list of shared features
+typedef std::shared_ptr<Feature> FeaturePtr;
+typedef QList<FeaturePtr> FeatureList;
+
+// generates random features (same distribution as the parser benchmark)
+FeatureStore generateFeatures(const int num_features)
+{
+    qsrand(42);
+    FeatureStore features;
+    features.reserve(num_features);
+    for (int i = 0; i < num_features; ++i) {
+        features.addFeature(QString("Gene%1").arg(qrand() % NUM_GENES),
+                            1 + (qrand() % 3300) / 100.0f,
+                            1 + (qrand() % 3500) / 100.0f,
+                            1 + qrand() % 500);
+    }
+    return features;
+}
+
+// builds the list of shared features of the store (the gene names are shared
+// like the parser used to do)
+FeatureList toFeatureList(const FeatureStore &features)
+{
+    FeatureList list;
+    list.reserve(features.size());
+    for (const auto feature : features) {
+        list.push_back(std::make_shared<Feature>(feature.gene(),
+                                                 feature.x(),
+                                                 feature.y(),
+                                                 feature.count(),
+                                                 feature.geneId()));
+    }
+    return list;
+}
+
+// approximate size in bytes of the memory used by the list
+qint64 memorySize(const FeatureList &features)
+{
+    // the list node, the control block and the feature of make_shared and
+    // the malloc headers of the two allocations
+    const qint64 perFeature = sizeof(void *) + 2 * sizeof(int) + sizeof(Feature)
+                              + 2 * 2 * sizeof(void *);
+    return sizeof(FeatureList) + features.size() * perFeature;
+}
+}
+
+FeatureStoreBench::FeatureStoreBench(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void FeatureStoreBench::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void FeatureStoreBench::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void FeatureStoreBench::benchMemory()
+{
+    QFETCH(int, features);
+
+    const FeatureStore store = generateFeatures(features);
+    const FeatureList list = toFeatureList(store);
+    const qint64 storeSize = store.memorySize();
+    const qint64 listSize = memorySize(list);
+    qDebug() << "store" << storeSize / (1024 * 1024) << "MB," << storeSize / features
+             << "bytes per feature";
+    qDebug() << "list" << listSize / (1024 * 1024) << "MB," << listSize / features
+             << "bytes per feature";
+    QVERIFY(storeSize < listSize);
+}
+
+void FeatureStoreBench::benchMemory_data()
+{
+    QTest::addColumn<int>("features");
+
+    QTest::newRow("1M") << 1000000;
+    QTest::newRow("5M") << 5000000;
+}
+
+void FeatureStoreBench::benchScan()
+{
+    QFETCH(int, features);
+    QFETCH(bool, columns);
+
+    // full scan computing the total count of every spot
+    const FeatureStore store = generateFeatures(features);
+    qint64 total = 0;
+    if (columns) {
+        QBENCHMARK
+        {
+            QVector<int> totals(store.spotsCount(), 0);
+            const QVector<quint32> &spotIds = store.spotIds();
+            const QVector<int> &counts = store.counts();
+            for (int i = 0; i < store.size(); ++i) {
+                totals[static_cast<int>(spotIds.at(i))] += counts.at(i);
+            }
+            total = std::accumulate(totals.begin(), totals.end(), qint64(0));
+        }
+    } else {
+        const FeatureList list = toFeatureList(store);
+        QBENCHMARK
+        {
+            QHash<Feature::SpotType, int> totals;
+            for (const FeaturePtr &feature : list) {
+                totals[feature->spot()] += feature->count();
+            }
+            total = std::accumulate(totals.begin(), totals.end(), qint64(0));
+        }
+    }
+    QCOMPARE(total, std::accumulate(store.counts().begin(), store.counts().end(), qint64(0)));
+}
+
+void FeatureStoreBench::benchScan_data()
+{
+    QTest::addColumn<int>("features");
+    QTest::addColumn<bool>("columns");
+
+    QTest::newRow("1M_list") << 1000000 << false;
+    QTest::newRow("1M_store") << 1000000 << true;
+    QTest::newRow("5M_list") << 5000000 << false;
+    QTest::newRow("5M_store") << 5000000 << true;
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::FeatureStoreBench)
+#include "tst_featurestorebench.moc"
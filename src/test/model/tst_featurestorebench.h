@@ -0,0 +1,29 @@
+#ifndef TST_FEATURESTOREBENCH_H
+#define TST_FEATURESTOREBENCH_H
+
+#include <QObject>
+
+namespace unit
+{
+
+// benchmarks of the columnar feature store against a list of shared features
+class FeatureStoreBench : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FeatureStoreBench(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchMemory();
+    void benchMemory_data();
+    void benchScan();
+    void benchScan_data();
+};
+
+} // namespace unit //
+
+#endif // TST_FEATURESTOREBENCH_H
@@ -0,0 +1,134 @@
+#include <QtTest/QTest>
+
+#include "dataModel/FeatureStore.h"
+
+#include "tst_featurestoretest.h"
+
+namespace unit
+{
+
+FeatureStoreTest::FeatureStoreTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void FeatureStoreTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void FeatureStoreTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void FeatureStoreTest::testAddFeatures()
+{
+    FeatureStore features;
+    QVERIFY(features.isEmpty());
+    features.addFeature("Actb", 10.5, 2.0, 3);
+    features.addFeature("Gapdh", 11.0, 2.0, 7);
+    features.addFeature("Actb", 11.0, 2.0, 2);
+    features.addFeature("Mbp", -0.0, 2.0, 1);
+    features.addFeature("Mbp", 0.0, 2.0, 4);
+
+    // genes and spots get ids in order of appearance
+    QCOMPARE(features.size(), 5);
+    QCOMPARE(features.genesCount(), 3);
+    QCOMPARE(features.spotsCount(), 3);
+    QCOMPARE(features.addGene("Gapdh"), 1u);
+    QCOMPARE(features.addSpot(11.0, 2.0), 1u);
+    QCOMPARE(features.geneName(2), QString("Mbp"));
+
+    const FeatureStore::FeatureRef feature = features.at(2);
+    QCOMPARE(feature.gene(), QString("Actb"));
+    QCOMPARE(feature.geneId(), 0u);
+    QCOMPARE(feature.spotId(), 1u);
+    QCOMPARE(feature.x(), 11.0f);
+    QCOMPARE(feature.y(), 2.0f);
+    QCOMPARE(feature.count(), 2);
+
+    int total = 0;
+    for (const auto row : features) {
+        total += row.count();
+    }
+    QCOMPARE(total, 17);
+
+    features.clear();
+    QVERIFY(features.isEmpty());
+    QCOMPARE(features.genesCount(), 0);
+    QCOMPARE(features.spotsCount(), 0);
+}
+
+void FeatureStoreTest::testAppend()
+{
+    FeatureStore first;
+    first.addFeature("Actb", 1.0, 1.0, 3);
+    first.addFeature("Gapdh", 2.0, 1.0, 7);
+    FeatureStore second;
+    second.addFeature("Mbp", 3.0, 1.0, 1);
+    second.addFeature("Gapdh", 1.0, 1.0, 2);
+
+    // appending gives the same store as adding the features one by one
+    FeatureStore expected;
+    expected.addFeature("Actb", 1.0, 1.0, 3);
+    expected.addFeature("Gapdh", 2.0, 1.0, 7);
+    expected.addFeature("Mbp", 3.0, 1.0, 1);
+    expected.addFeature("Gapdh", 1.0, 1.0, 2);
+
+    first.append(second);
+    QVERIFY(first == expected);
+    QCOMPARE(first.at(3).geneId(), 1u);
+    QCOMPARE(first.at(3).spotId(), 0u);
+}
+
+void FeatureStoreTest::testIndexes()
+{
+    FeatureStore features;
+    features.addFeature("Actb", 1.0, 1.0, 3);
+    features.addFeature("Gapdh", 2.0, 1.0, 7);
+    features.addFeature("Gapdh", 1.0, 1.0, 2);
+    features.addFeature("Mbp", 2.0, 1.0, 1);
+    QVERIFY(!features.hasIndexes());
+    features.buildIndexes();
+    QVERIFY(features.hasIndexes());
+
+    // features by spot
+    const QVector<int> spotOffsets = {0, 2, 4};
+    const QVector<int> spotFeatures = {0, 2, 1, 3};
+    QCOMPARE(features.spotOffsets(), spotOffsets);
+    QCOMPARE(features.spotFeatures(), spotFeatures);
+
+    // features by gene
+    const QVector<int> geneOffsets = {0, 1, 3, 4};
+    const QVector<int> geneFeatures = {0, 1, 2, 3};
+    QCOMPARE(features.geneOffsets(), geneOffsets);
+    QCOMPARE(features.geneFeatures(), geneFeatures);
+
+    features.addFeature("Actb", 2.0, 1.0, 5);
+    QVERIFY(!features.hasIndexes());
+}
+
+void FeatureStoreTest::testSubset()
+{
+    FeatureStore features;
+    features.addFeature("Actb", 1.0, 1.0, 3);
+    features.addFeature("Gapdh", 2.0, 1.0, 7);
+    features.addFeature("Mbp", 1.0, 1.0, 2);
+
+    const FeatureStore subset = features.subset({2, 0});
+    QCOMPARE(subset.size(), 2);
+    QVERIFY(subset.sameGenes(features));
+    QCOMPARE(subset.at(0).gene(), QString("Mbp"));
+    QCOMPARE(subset.at(0).geneId(), 2u);
+    QCOMPARE(subset.at(1).count(), 3);
+
+    FeatureStore other;
+    other.addFeature("Gapdh", 2.0, 1.0, 7);
+    QVERIFY(!other.sameGenes(features));
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::FeatureStoreTest)
+#include "tst_featurestoretest.moc"
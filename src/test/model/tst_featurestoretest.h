@@ -0,0 +1,28 @@
+#ifndef TST_FEATURESTORETEST_H
+#define TST_FEATURESTORETEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+class FeatureStoreTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FeatureStoreTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testAddFeatures();
+    void testAppend();
+    void testIndexes();
+    void testSubset();
+};
+
+} // namespace unit //
+
+#endif // TST_FEATURESTORETEST_H
@@ -14,11 +14,18 @@
 #include "test/controller/tst_widgets.h"
 #include "test/math/tst_glaabbtest.h"
 #include "test/math/tst_glquadtreetest.h"
+#include "test/math/tst_latticeindextest.h"
 #include "test/math/tst_glheatmaptest.h"
 #include "test/model/tst_objectparsertest.h"
+#include "test/model/tst_featuresparsertest.h"
+#include "test/model/tst_binarydatasettest.h"
+#include "test/model/tst_featurestoretest.h"
+#include "test/model/tst_datasetcachetest.h"
+#include "test/model/tst_datasetsnapshottest.h"
 #include "test/utils/tst_mathextendedtest.h"
 #include "test/network/test_auth.h"
 #include "test/network/test_rest.h"
+#include "test/viewOpenGL/tst_generenderertest.h"
 #include "test/viewOpenGL/test_AssertOpenGL.h"
 
 using namespace unit;
@@ -33,11 +40,18 @@ int main(int argc, char **argv)
     // suite.addTest(new WidgetsTest, "Widgets");
     suite.addTest(new GLAABBTest, "GLAABB");
     suite.addTest(new GLQuadTreeTest, "GLQuadTree").dependsOn("GLAABB");
+    suite.addTest(new LatticeIndexTest, "LatticeIndex");
     suite.addTest(new GLHeatMapTest, "GLHeatMap");
     suite.addTest(new ObjectParserTest, "ObjectParser");
+    suite.addTest(new FeaturesParserTest, "FeaturesParser");
+    suite.addTest(new BinaryDatasetTest, "BinaryDataset");
+    suite.addTest(new FeatureStoreTest, "FeatureStore");
+    suite.addTest(new DatasetCacheTest, "DatasetCache");
+    suite.addTest(new DatasetSnapshotTest, "DatasetSnapshot");
     suite.addTest(new MathExtendedTest, "MathExtended");
     suite.addTest(new AuthTest, "Authorization");
     suite.addTest(new RestTest, "REST Services");
+    suite.addTest(new GeneRendererTest, "GeneRenderer");
     suite.addTest(new OpenGLAssertTest, "OpenGL Assert");
 
     return suite.exec();
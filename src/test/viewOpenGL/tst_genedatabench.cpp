@@ -0,0 +1,137 @@
+#include <QtTest/QTest>
+#include <QVector4D>
+
+#include <algorithm>
+
+#include "viewOpenGL/GeneData.h"
+
+#include "tst_genedatabench.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// number of spots of a big dataset
+static const int NUM_SPOTS = 50000;
+
+// the spots data was previously stored in parallel arrays of floats
+// (a color vector and a float for the reads, visible and selected values)
+// NOTE the modified spots are not marked in any of the layouts as GeneData
+// only marks them once the buffers are allocated (a context is needed)
+struct FloatArrays {
+    explicit FloatArrays(const int spots)
+        : colors(spots)
+        , reads(spots, 0.0)
+        , visible(spots, 0.0)
+        , selected(spots, 0.0)
+    {
+    }
+
+    void updateSpot(const int index, const int value, const bool isVisible, const QColor &color)
+    {
+        reads[index] = static_cast<float>(value);
+        visible[index] = static_cast<float>(isVisible);
+        if (!isVisible) {
+            selected[index] = 0.0;
+        }
+        colors[index] = QVector4D(color.redF(), color.greenF(), color.blueF(), color.alphaF());
+    }
+
+    static int spotSize() { return static_cast<int>(sizeof(QVector4D) + 3 * sizeof(float)); }
+
+    QVector<QVector4D> colors;
+    QVector<float> reads;
+    QVector<float> visible;
+    QVector<float> selected;
+};
+
+// the order in which the spots are updated, all the spots (updateVisual())
+// or the spots of some genes scattered in the arrays (updateVisual(genes))
+QVector<int> spotsOrder(const bool scattered)
+{
+    QVector<int> spots;
+    for (int i = 0; i < NUM_SPOTS; ++i) {
+        spots.push_back(i);
+    }
+    if (scattered) {
+        qsrand(42);
+        std::random_shuffle(spots.begin(), spots.end(), [](int n) { return qrand() % n; });
+        spots.resize(NUM_SPOTS / 4);
+    }
+    return spots;
+}
+
+// the color of a spot (a few colors like the genes colors)
+QColor spotColor(const int spot)
+{
+    return QColor::fromHsv((spot % 12) * 30, 200, 255);
+}
+}
+
+GeneDataBench::GeneDataBench(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void GeneDataBench::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void GeneDataBench::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void GeneDataBench::benchUpdateVisual()
+{
+    QFETCH(bool, packed);
+    QFETCH(bool, scattered);
+
+    const QVector<int> spots = spotsOrder(scattered);
+    if (packed) {
+        GeneData data;
+        for (int i = 0; i < NUM_SPOTS; ++i) {
+            data.addSpot(i % 250, i / 250);
+        }
+        qDebug() << "packed" << sizeof(GeneData::SpotAttributes) << "bytes per spot,"
+                 << (spots.size() * sizeof(GeneData::SpotAttributes)) / 1024 << "KB written";
+        QBENCHMARK
+        {
+            for (const int spot : spots) {
+                data.updateSpot(spot, spot % 500, spot % 3 != 0, spotColor(spot));
+            }
+        }
+        QCOMPARE(data.spotReads(spots.last()), spots.last() % 500);
+        QCOMPARE(data.spotVisible(spots.last()), spots.last() % 3 != 0);
+    } else {
+        FloatArrays data(NUM_SPOTS);
+        qDebug() << "float arrays" << FloatArrays::spotSize() << "bytes per spot,"
+                 << (spots.size() * FloatArrays::spotSize()) / 1024 << "KB written";
+        QBENCHMARK
+        {
+            for (const int spot : spots) {
+                data.updateSpot(spot, spot % 500, spot % 3 != 0, spotColor(spot));
+            }
+        }
+        QCOMPARE(static_cast<int>(data.reads.at(spots.last())), spots.last() % 500);
+    }
+}
+
+void GeneDataBench::benchUpdateVisual_data()
+{
+    QTest::addColumn<bool>("packed");
+    QTest::addColumn<bool>("scattered");
+
+    QTest::newRow("all_float_arrays") << false << false;
+    QTest::newRow("all_packed") << true << false;
+    QTest::newRow("scattered_float_arrays") << false << true;
+    QTest::newRow("scattered_packed") << true << true;
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::GeneDataBench)
+#include "tst_genedatabench.moc"
@@ -0,0 +1,30 @@
+#ifndef TST_GENEDATABENCH_H
+#define TST_GENEDATABENCH_H
+
+#include <QObject>
+
+namespace unit
+{
+
+// benchmarks of the spot updates done by GeneRendererGL::updateVisual on the
+// packed attributes of GeneData against the previous parallel float arrays
+// the cache misses can be measured with the -perf -perfcounter cache-misses
+// options (Linux only)
+class GeneDataBench : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GeneDataBench(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchUpdateVisual();
+    void benchUpdateVisual_data();
+};
+
+} // namespace unit //
+
+#endif // TST_GENEDATABENCH_H
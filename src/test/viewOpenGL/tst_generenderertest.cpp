@@ -0,0 +1,274 @@
+#include <QtTest/QTest>
+
+#include <algorithm>
+#include <numeric>
+
+#include "concurrent/DataRenderer.h"
+#include "viewOpenGL/GeneRendererGL.h"
+
+#include "tst_generenderertest.h"
+
+namespace unit
+{
+
+namespace
+{
+
+// the thresholds of the renderer (a random one is moved on each step with
+// RandomThreshold)
+enum Threshold {
+    ReadsLower,
+    ReadsUpper,
+    GenesLower,
+    GenesUpper,
+    TotalReadsLower,
+    TotalReadsUpper,
+    RandomThreshold
+};
+
+static const int NUM_GENES = 40;
+static const int NUM_SPOTS = 3000;
+static const int MAX_SPOT_GENES = 20;
+static const int MAX_COUNT = 60;
+static const int NUM_STEPS = 200;
+
+// the data of the renderer used to compute the rendering data of the spots
+// and to find the ids between the old and new bound of a threshold
+struct RendererData {
+    FeatureStore features;
+    QVector<DataRenderer::GeneState> geneStates;
+    QVector<int> totalReads;
+    QVector<int> totalGenes;
+    QVector<int> spotsByTotalReads;
+    QVector<int> spotsByTotalGenes;
+    QVector<int> featuresByCount;
+};
+
+// random features (each spot has each gene at most once) and genes states
+void randomData(RendererData &data)
+{
+    qsrand(42);
+    QVector<quint32> genes;
+    for (int gene = 0; gene < NUM_GENES; ++gene) {
+        genes.push_back(data.features.addGene(QString("gene%1").arg(gene)));
+        DataRenderer::GeneState state;
+        state.color[0] = (qrand() % 256) / 255.0f;
+        state.color[1] = (qrand() % 256) / 255.0f;
+        state.color[2] = (qrand() % 256) / 255.0f;
+        state.color[3] = 1.0f;
+        state.cutoff = qrand() % 10;
+        state.selected = qrand() % 5 != 0;
+        data.geneStates.push_back(state);
+    }
+    for (int spot = 0; spot < NUM_SPOTS; ++spot) {
+        const quint32 spotId = data.features.addSpot(spot % 50, spot / 50);
+        std::random_shuffle(genes.begin(), genes.end(), [](int n) { return qrand() % n; });
+        const int spotGenes = qrand() % (MAX_SPOT_GENES + 1);
+        for (int i = 0; i < spotGenes; ++i) {
+            data.features.addFeature(genes.at(i), spotId, 1 + qrand() % MAX_COUNT);
+        }
+    }
+    data.features.buildIndexes();
+
+    // the totals of the spots and the ids sorted by value
+    data.totalReads.fill(0, NUM_SPOTS);
+    data.totalGenes.fill(0, NUM_SPOTS);
+    for (int i = 0; i < data.features.size(); ++i) {
+        const int spot = static_cast<int>(data.features.spotIds().at(i));
+        data.totalReads[spot] += data.features.counts().at(i);
+        ++data.totalGenes[spot];
+    }
+    const auto sortedIds = [](const QVector<int> &values) {
+        QVector<int> ids(values.size());
+        std::iota(ids.begin(), ids.end(), 0);
+        std::sort(ids.begin(), ids.end(), [&values](const int a, const int b) {
+            return values.at(a) < values.at(b);
+        });
+        return ids;
+    };
+    data.spotsByTotalReads = sortedIds(data.totalReads);
+    data.spotsByTotalGenes = sortedIds(data.totalGenes);
+    data.featuresByCount = sortedIds(data.features.counts());
+}
+
+int &thresholdLimit(DataRenderer::Settings &settings, const Threshold threshold)
+{
+    switch (threshold) {
+    case ReadsLower:
+        return settings.readsLower;
+    case ReadsUpper:
+        return settings.readsUpper;
+    case GenesLower:
+        return settings.genesLower;
+    case GenesUpper:
+        return settings.genesUpper;
+    case TotalReadsLower:
+        return settings.totalReadsLower;
+    default:
+        return settings.totalReadsUpper;
+    }
+}
+
+// the highest value of the threshold
+int thresholdMaximum(const Threshold threshold)
+{
+    if (threshold == ReadsLower || threshold == ReadsUpper) {
+        return MAX_COUNT;
+    } else if (threshold == GenesLower || threshold == GenesUpper) {
+        return MAX_SPOT_GENES;
+    }
+    return MAX_SPOT_GENES * MAX_COUNT;
+}
+
+// the spots to update when the threshold moves from previous to limit
+// (as GeneRendererGL::updateThreshold() does)
+QVector<int> changedSpots(const RendererData &data,
+                          const Threshold threshold,
+                          const int previous,
+                          const int limit)
+{
+    const bool features = threshold == ReadsLower || threshold == ReadsUpper;
+    const QVector<int> *sortedIds = &data.featuresByCount;
+    const QVector<int> *values = &data.features.counts();
+    if (threshold == GenesLower || threshold == GenesUpper) {
+        sortedIds = &data.spotsByTotalGenes;
+        values = &data.totalGenes;
+    } else if (threshold == TotalReadsLower || threshold == TotalReadsUpper) {
+        sortedIds = &data.spotsByTotalReads;
+        values = &data.totalReads;
+    }
+    const bool lower = threshold == ReadsLower || threshold == GenesLower
+                       || threshold == TotalReadsLower;
+    int first = 0;
+    int last = 0;
+    GeneRendererGL::thresholdChangedRange(*sortedIds,
+                                          *values,
+                                          previous,
+                                          limit,
+                                          lower ? GeneRendererGL::LowerBound
+                                                : GeneRendererGL::UpperBound,
+                                          first,
+                                          last);
+
+    QVector<int> spots;
+    QVector<bool> added(NUM_SPOTS, false);
+    for (int i = first; i < last; ++i) {
+        const int id = sortedIds->at(i);
+        const int spot = features ? static_cast<int>(data.features.spotIds().at(id)) : id;
+        if (!added.at(spot)) {
+            added[spot] = true;
+            spots.push_back(spot);
+        }
+    }
+    return spots;
+}
+
+// renders the spots and writes their data to the spots data (indexed by
+// spot) as GeneRendererGL::slotUpdateFinished() does
+void renderSpots(const RendererData &data,
+                 const DataRenderer::Settings &settings,
+                 const QVector<int> &spots,
+                 QVector<DataRenderer::SpotData> &spotsData)
+{
+    DataRenderer::Input input;
+    input.features = &data.features;
+    input.geneStates = &data.geneStates;
+    input.totalReads = &data.totalReads;
+    input.totalGenes = &data.totalGenes;
+    input.settings = settings;
+    QVector<DataRenderer::SpotData> rendered;
+    int pooledMin = 0;
+    int pooledMax = 0;
+    DataRenderer::render(input, spots, rendered, pooledMin, pooledMax);
+    for (int i = 0; i < spots.size(); ++i) {
+        DataRenderer::SpotData &spotData = spotsData[spots.at(i)];
+        if (rendered.at(i).outside) {
+            // the value and the color of a hidden spot are kept
+            spotData.visible = false;
+        } else {
+            spotData = rendered.at(i);
+        }
+    }
+}
+}
+
+GeneRendererTest::GeneRendererTest(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void GeneRendererTest::initTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void GeneRendererTest::cleanupTestCase()
+{
+    QVERIFY2(true, "Empty");
+}
+
+void GeneRendererTest::testThresholdUpdates()
+{
+    QFETCH(int, threshold);
+    QFETCH(bool, genesCutoff);
+
+    RendererData data;
+    randomData(data);
+    QVector<int> allSpots(NUM_SPOTS);
+    std::iota(allSpots.begin(), allSpots.end(), 0);
+
+    // all the spots are inside the thresholds at first
+    DataRenderer::Settings settings;
+    settings.readsLower = 0;
+    settings.readsUpper = thresholdMaximum(ReadsUpper);
+    settings.genesLower = 0;
+    settings.genesUpper = thresholdMaximum(GenesUpper);
+    settings.totalReadsLower = 0;
+    settings.totalReadsUpper = thresholdMaximum(TotalReadsUpper);
+    settings.genesCutoff = genesCutoff;
+    settings.pooled = false;
+    settings.poolingMode = Visual::PoolReadsCount;
+    QVector<DataRenderer::SpotData> spotsData(NUM_SPOTS);
+    renderSpots(data, settings, allSpots, spotsData);
+
+    // the bounds are moved in both directions (crossing the other bound too)
+    for (int step = 0; step < NUM_STEPS; ++step) {
+        const Threshold moved = threshold == RandomThreshold
+                                    ? static_cast<Threshold>(qrand() % RandomThreshold)
+                                    : static_cast<Threshold>(threshold);
+        int &limit = thresholdLimit(settings, moved);
+        const int previous = limit;
+        limit = qrand() % (thresholdMaximum(moved) + 2);
+        renderSpots(data, settings, changedSpots(data, moved, previous, limit), spotsData);
+
+        QVector<DataRenderer::SpotData> expected(NUM_SPOTS);
+        renderSpots(data, settings, allSpots, expected);
+        for (int spot = 0; spot < NUM_SPOTS; ++spot) {
+            QCOMPARE(spotsData.at(spot).visible, expected.at(spot).visible);
+            if (expected.at(spot).visible) {
+                QCOMPARE(spotsData.at(spot).value, expected.at(spot).value);
+                QCOMPARE(spotsData.at(spot).color, expected.at(spot).color);
+            }
+        }
+    }
+}
+
+void GeneRendererTest::testThresholdUpdates_data()
+{
+    QTest::addColumn<int>("threshold");
+    QTest::addColumn<bool>("genesCutoff");
+
+    QTest::newRow("reads_lower") << static_cast<int>(ReadsLower) << false;
+    QTest::newRow("reads_upper") << static_cast<int>(ReadsUpper) << false;
+    QTest::newRow("genes_lower") << static_cast<int>(GenesLower) << false;
+    QTest::newRow("genes_upper") << static_cast<int>(GenesUpper) << false;
+    QTest::newRow("total_reads_lower") << static_cast<int>(TotalReadsLower) << false;
+    QTest::newRow("total_reads_upper") << static_cast<int>(TotalReadsUpper) << false;
+    QTest::newRow("all") << static_cast<int>(RandomThreshold) << false;
+    QTest::newRow("all_cutoff") << static_cast<int>(RandomThreshold) << true;
+}
+
+} // namespace unit //
+
+QTEST_MAIN(unit::GeneRendererTest)
+#include "tst_generenderertest.moc"
@@ -0,0 +1,29 @@
+#ifndef TST_GENERENDERERTEST_H
+#define TST_GENERENDERERTEST_H
+
+#include <QObject>
+
+namespace unit
+{
+
+// the spots updated when a threshold bound moves (see
+// GeneRendererGL::thresholdChangedRange()) must end up with the same
+// rendering data as rendering all the spots again (no OpenGL is needed)
+class GeneRendererTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GeneRendererTest(QObject *parent = 0);
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testThresholdUpdates();
+    void testThresholdUpdates_data();
+};
+
+} // namespace unit //
+
+#endif // TST_GENERENDERERTEST_H //
@@ -20,6 +20,8 @@ static const int DEFAULT_MIN_ZOOM = 1;
 static const int DEFAULT_MAX_ZOOM = 100;
 static const int OPENGL_VERSION_MAJOR = 2;
 static const int OPENGL_VERSION_MINOR = 0;
+// the minimum distance in pixels between the vertices of the lasso
+static const int MIN_LASSO_VERTEX_DISTANCE = 3;
 
 namespace
 {
@@ -64,6 +66,9 @@ CellGLView::CellGLView(QWidget *parent)
     format.setDepthBufferSize(0);
     format.setSwapInterval(0);
     setFormat(format);
+
+    // the nodes get the mouse moves without buttons pressed (hover)
+    setMouseTracking(true);
 }
 
 CellGLView::~CellGLView()
@@ -303,7 +308,12 @@ bool CellGLView::sendMouseEventToNodes(const QPoint &point,
 {
     bool mouseEventWasSentToAtleastOneNode = false;
     for (const auto &node : m_nodes) {
-        const QPointF localPoint = nodeTransformations(node).inverted().map(point);
+        // map the point to the node cordinate system
+        QTransform node_trans = nodeTransformations(node);
+        if (node->transformable()) {
+            node_trans *= sceneTransformations();
+        }
+        const QPointF localPoint = node_trans.inverted().map(QPointF(point));
         if (filterFunc(*node) && node->contains(localPoint)) {
             mouseEventWasSentToAtleastOneNode = true;
             QMouseEvent newEvent(event->type(),
@@ -322,13 +332,15 @@ bool CellGLView::sendMouseEventToNodes(const QPoint &point,
             } else {
                 qDebug() << "Mouse event type not recognized";
             }
+        } else if (type == moveType && filterFunc(*node)) {
+            node->mouseLeaveEvent();
         }
     }
 
     return mouseEventWasSentToAtleastOneNode;
 }
 
-void CellGLView::sendRubberBandEventToNodes(const QRectF &rubberBand, const QMouseEvent *event)
+void CellGLView::sendRubberBandEventToNodes(const QPolygonF &rubberBand, const QMouseEvent *event)
 {
     // notify nodes for rubberband
     for (const auto &node : m_nodes) {
@@ -340,10 +352,10 @@ void CellGLView::sendRubberBandEventToNodes(const QRectF &rubberBand, const QMou
             }
 
             // map selected area to node cordinate system
-            QRectF transformed = node_trans.inverted().mapRect(rubberBand);
-            // if selection area is not inside the bounding rect select empty rect
-            if (!node->boundingRect().contains(transformed)) {
-                transformed = QRectF();
+            QPolygonF transformed = node_trans.inverted().map(rubberBand);
+            // if selection area is not inside the bounding rect select empty area
+            if (!node->boundingRect().contains(transformed.boundingRect())) {
+                transformed = QPolygonF();
             }
 
             // Set the new selection area
@@ -365,6 +377,12 @@ void CellGLView::mousePressEvent(QMouseEvent *event)
         m_rubberBanding = true;
         m_originRubberBand = event->pos();
         m_rubberband->setRubberbandRect(QRect());
+        // holding alt selects with a lasso instead of a rectangle
+        m_lasso.clear();
+        if (event->modifiers().testFlag(Qt::AltModifier)) {
+            m_lasso << event->pos();
+        }
+        m_rubberband->setRubberbandPath(m_lasso);
         // draw rubberband
         update();
     } else {
@@ -394,16 +412,24 @@ void CellGLView::mouseReleaseEvent(QMouseEvent *event)
     // first check if we are selecting
     if (event->button() == Qt::LeftButton && m_selecting && m_rubberBanding) {
         unsetCursor();
-        const QPoint origin = m_originRubberBand;
-        const QPoint destiny = event->pos();
-        const QRectF rubberBandRect = QRect(qMin(origin.x(), destiny.x()),
-                                            qMin(origin.y(), destiny.y()),
-                                            qAbs(origin.x() - destiny.x()) + 1,
-                                            qAbs(origin.y() - destiny.y()) + 1);
-        sendRubberBandEventToNodes(rubberBandRect, event);
+        if (!m_lasso.isEmpty()) {
+            // the lasso is closed from the last vertex to the first one
+            m_lasso << event->pos();
+            sendRubberBandEventToNodes(QPolygonF(m_lasso), event);
+        } else {
+            const QPoint origin = m_originRubberBand;
+            const QPoint destiny = event->pos();
+            const QRectF rubberBandRect = QRect(qMin(origin.x(), destiny.x()),
+                                                qMin(origin.y(), destiny.y()),
+                                                qAbs(origin.x() - destiny.x()) + 1,
+                                                qAbs(origin.y() - destiny.y()) + 1);
+            sendRubberBandEventToNodes(QPolygonF(rubberBandRect), event);
+        }
         // reset rubberband variables
         m_rubberBanding = false;
+        m_lasso.clear();
         m_rubberband->setRubberbandRect(QRect());
+        m_rubberband->setRubberbandPath(m_lasso);
     } else if (event->button() == Qt::LeftButton && m_panning && !m_selecting) {
         unsetCursor();
         m_panning = false;
@@ -419,14 +445,23 @@ void CellGLView::mouseMoveEvent(QMouseEvent *event)
 {
     // first check if we are in selection mode
     if (event->buttons() & Qt::LeftButton && m_selecting && m_rubberBanding) {
-        // get rubberband
-        const QPoint origin = m_originRubberBand;
-        const QPoint destiny = event->pos();
-        const QRectF rubberBandRect = QRect(qMin(origin.x(), destiny.x()),
-                                            qMin(origin.y(), destiny.y()),
-                                            qAbs(origin.x() - destiny.x()) + 1,
-                                            qAbs(origin.y() - destiny.y()) + 1);
-        m_rubberband->setRubberbandRect(rubberBandRect);
+        if (!m_lasso.isEmpty()) {
+            // the lasso gets a new vertex every few pixels
+            const QPoint delta = event->pos() - m_lasso.last();
+            if (delta.manhattanLength() >= MIN_LASSO_VERTEX_DISTANCE) {
+                m_lasso << event->pos();
+                m_rubberband->setRubberbandPath(m_lasso);
+            }
+        } else {
+            // get rubberband
+            const QPoint origin = m_originRubberBand;
+            const QPoint destiny = event->pos();
+            const QRectF rubberBandRect = QRect(qMin(origin.x(), destiny.x()),
+                                                qMin(origin.y(), destiny.y()),
+                                                qAbs(origin.x() - destiny.x()) + 1,
+                                                qAbs(origin.y() - destiny.y()) + 1);
+            m_rubberband->setRubberbandRect(rubberBandRect);
+        }
         // draw rubberband
         update();
     } else if (event->buttons() & Qt::LeftButton && m_panning && !m_selecting) {
@@ -445,6 +480,15 @@ void CellGLView::mouseMoveEvent(QMouseEvent *event)
     event->ignore();
 }
 
+void CellGLView::leaveEvent(QEvent *event)
+{
+    // the mouse is not over any node anymore
+    for (const auto &node : m_nodes) {
+        node->mouseLeaveEvent();
+    }
+    QOpenGLWidget::leaveEvent(event);
+}
+
 void CellGLView::keyPressEvent(QKeyEvent *event)
 {
     const float shortest_side_length = qMin(m_viewport.width(), m_viewport.height());
@@ -3,6 +3,7 @@
 
 #include <QOpenGLWidget>
 #include <QPointer>
+#include <QPolygon>
 
 #include "GraphicItemGL.h"
 #include "SelectionEvent.h"
@@ -61,6 +62,7 @@ public:
     void mousePressEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
 
 public slots:
@@ -112,8 +114,9 @@ private:
     // this function ensures that the whole image fits to the canvas
     void setDefaultPanningAndZooming();
 
-    // notify rubberbandable nodes with a rubberband event
-    void sendRubberBandEventToNodes(const QRectF &rubberBand, const QMouseEvent *event);
+    // notify rubberbandable nodes with a rubberband event (the area is the
+    // rubberband rectangle or the lasso)
+    void sendRubberBandEventToNodes(const QPolygonF &rubberBand, const QMouseEvent *event);
 
     // returns true if the event was sent to at least one of the nodes
     bool sendMouseEventToNodes(const QPoint &point,
@@ -131,6 +134,8 @@ private:
     // auxiliary variables for panning, zoom and selection
     QPoint m_originPanning;
     QPoint m_originRubberBand;
+    // the vertices of the lasso (empty if selecting with a rectangle)
+    QPolygon m_lasso;
     bool m_panning;
     bool m_rubberBanding;
     bool m_selecting;
@@ -1,25 +1,48 @@
 #include "GeneData.h"
 
-static const int QUAD_SIZE = 4;
-static const QVector2D ta(0.0, 0.0);
-static const QVector2D tb(0.0, 1.0);
-static const QVector2D tc(1.0, 1.0);
-static const QVector2D td(1.0, 0.0);
+#include <QOpenGLShaderProgram>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+
+#include <cstddef>
+
+// modified spots closer than this are uploaded together
+static const int MAX_DIRTY_GAP = 64;
 
 namespace
 {
 
-QColor fromOpenGLColor(const QVector4D opengl_color)
+void toSpotColor(const QRgb rgba, GeneData::SpotAttributes &attributes)
 {
-    return QColor::fromRgbF(opengl_color.x(), opengl_color.y(), opengl_color.z(), opengl_color.w());
+    attributes.color[0] = static_cast<quint8>(qRed(rgba));
+    attributes.color[1] = static_cast<quint8>(qGreen(rgba));
+    attributes.color[2] = static_cast<quint8>(qBlue(rgba));
+    attributes.color[3] = static_cast<quint8>(qAlpha(rgba));
 }
 
-QVector4D fromQtColor(const QColor color)
-{
-    return QVector4D(color.redF(), color.greenF(), color.blueF(), color.alphaF());
-}
+// shader attributes of the interleaved spot attributes
+struct AttributeLayout {
+    const char *name;
+    GLenum type;
+    int tupleSize;
+    GLboolean normalized;
+    size_t offset;
+};
+
+static const AttributeLayout ATTRIBUTES_LAYOUT[]
+    = {{"colorAttr", GL_UNSIGNED_BYTE, 4, GL_TRUE, offsetof(GeneData::SpotAttributes, color)},
+       {"flagsAttr", GL_UNSIGNED_BYTE, 1, GL_FALSE, offsetof(GeneData::SpotAttributes, flags)},
+       {"countAttr", GL_FLOAT, 1, GL_FALSE, offsetof(GeneData::SpotAttributes, value)}};
+static const char *POSITION_ATTRIBUTE = "vertexAttr";
 }
+
+static_assert(sizeof(GeneData::SpotAttributes) == 12, "unexpected spot attributes size");
+
 GeneData::GeneData()
+    : m_hasDirty(false)
+    , m_reallocate(true)
+    , m_vaoChecked(false)
+    , m_vaoConfigured(false)
 {
 }
 
@@ -29,115 +52,245 @@ GeneData::~GeneData()
 
 void GeneData::clearData()
 {
-    m_vertices.clear();
-    m_textures.clear();
-    m_colors.clear();
-    m_indexes.clear();
-    m_reads.clear();
-    m_visible.clear();
-    m_selected.clear();
-}
-
-int GeneData::addQuad(const float x, const float y, const float size, const QColor &color)
-{
-    const int index_count = static_cast<int>(m_vertices.size());
-
-    m_vertices.append(QVector3D(x - size / 2.0, y - size / 2.0, 0.0));
-    m_vertices.append(QVector3D(x + size / 2.0, y - size / 2.0, 0.0));
-    m_vertices.append(QVector3D(x + size / 2.0, y + size / 2.0, 0.0));
-    m_vertices.append(QVector3D(x - size / 2.0, y + size / 2.0, 0.0));
-
-    m_textures.append(ta);
-    m_textures.append(tb);
-    m_textures.append(tc);
-    m_textures.append(td);
-
-    const QVector4D opengl_color = fromQtColor(color);
-    m_colors.append(opengl_color);
-    m_colors.append(opengl_color);
-    m_colors.append(opengl_color);
-    m_colors.append(opengl_color);
-
-    m_indexes.append(index_count);
-    m_indexes.append(index_count + 1);
-    m_indexes.append(index_count + 2);
-    m_indexes.append(index_count);
-    m_indexes.append(index_count + 2);
-    m_indexes.append(index_count + 3);
-
-    // update custom vertex arrays
-    for (int i = 0; i < QUAD_SIZE; ++i) {
-        m_reads.append(0.0);
-        m_visible.append(0.0);
-        m_selected.append(0.0);
-    }
+    m_positions.clear();
+    m_attributes.clear();
+    m_reallocate = true;
+}
+
+int GeneData::addSpot(const float x, const float y, const QColor &color)
+{
+    const int index = m_positions.size();
+
+    // the size of the spot is given to the shaders as the point size
+    m_positions.append(QVector2D(x, y));
+    SpotAttributes attributes = {};
+    toSpotColor(color.rgba(), attributes);
+    m_attributes.append(attributes);
 
-    // return first index of the quad created
-    return index_count;
+    // the buffers are allocated with the new size in the next upload
+    m_reallocate = true;
+
+    // return the index of the spot created
+    return index;
 }
 
-void GeneData::updateQuadSize(const int index, const float x, const float y, const float size)
+void GeneData::updateSpot(const int index,
+                          const int reads,
+                          const bool visible,
+                          const QColor &color)
 {
-    m_vertices[index] = QVector3D(x - size / 2.0, y - size / 2.0, 0.0);
-    m_vertices[index + 1] = QVector3D(x + size / 2.0, y - size / 2.0, 0.0);
-    m_vertices[index + 2] = QVector3D(x + size / 2.0, y + size / 2.0, 0.0);
-    m_vertices[index + 3] = QVector3D(x - size / 2.0, y + size / 2.0, 0.0);
+    updateSpot(index, reads, visible, color.rgba());
 }
 
-void GeneData::updateQuadColor(const int index, const QColor &color)
+void GeneData::updateSpot(const int index, const int reads, const bool visible, const QRgb color)
 {
-    const QVector4D opengl_color = fromQtColor(color);
-    for (int i = 0; i < QUAD_SIZE; ++i) {
-        m_colors[index + i] = opengl_color;
-    }
+    SpotAttributes &attributes = m_attributes[index];
+    toSpotColor(color, attributes);
+    attributes.value = static_cast<float>(reads);
+    attributes.flags = visible ? (attributes.flags | SpotAttributes::Visible) : 0;
+    setDirty(index);
 }
 
-void GeneData::updateQuadSelected(const int index, const bool selected)
+void GeneData::updateSpotColor(const int index, const QColor &color)
 {
-    for (int i = 0; i < QUAD_SIZE; ++i) {
-        m_selected[index + i] = static_cast<float>(selected);
-    }
+    toSpotColor(color.rgba(), m_attributes[index]);
+    setDirty(index);
+}
+
+void GeneData::updateSpotSelected(const int index, const bool selected)
+{
+    setSpotFlag(index, SpotAttributes::Selected, selected);
+}
+
+void GeneData::updateSpotVisible(const int index, const bool visible)
+{
+    setSpotFlag(index, SpotAttributes::Visible, visible);
+}
+
+void GeneData::updateSpotReads(const int index, const int reads)
+{
+    m_attributes[index].value = static_cast<float>(reads);
+    setDirty(index);
+}
+
+QColor GeneData::spotColor(const int index) const
+{
+    const quint8 *color = m_attributes.at(index).color;
+    return QColor(color[0], color[1], color[2], color[3]);
+}
+
+bool GeneData::spotSelected(const int index) const
+{
+    return (m_attributes.at(index).flags & SpotAttributes::Selected) != 0;
 }
 
-void GeneData::updateQuadVisible(const int index, const bool visible)
+bool GeneData::spotVisible(const int index) const
 {
-    for (int i = 0; i < QUAD_SIZE; ++i) {
-        m_visible[index + i] = static_cast<float>(visible);
+    return (m_attributes.at(index).flags & SpotAttributes::Visible) != 0;
+}
+
+int GeneData::spotReads(const int index) const
+{
+    return static_cast<int>(m_attributes.at(index).value);
+}
+
+void GeneData::clearSelectionArray()
+{
+    for (SpotAttributes &attributes : m_attributes) {
+        attributes.flags &= ~SpotAttributes::Selected;
     }
+    // the whole array is uploaded
+    m_dirty.fill(true);
+    m_hasDirty = true;
 }
 
-void GeneData::updateQuadReads(const int index, const int reads)
+int GeneData::spotsCount() const
 {
-    for (int i = 0; i < QUAD_SIZE; ++i) {
-        m_reads[index + i] = static_cast<float>(reads);
+    return m_positions.size();
+}
+
+const QVector<QVector2D> &GeneData::positions() const
+{
+    return m_positions;
+}
+
+const QVector<GeneData::SpotAttributes> &GeneData::attributes() const
+{
+    return m_attributes;
+}
+
+void GeneData::setSpotFlag(const int index, const quint8 flag, const bool enable)
+{
+    quint8 &flags = m_attributes[index].flags;
+    flags = enable ? (flags | flag) : (flags & ~flag);
+    setDirty(index);
+}
+
+void GeneData::setDirty(const int index)
+{
+    // the whole buffers are uploaded when they are allocated
+    if (m_reallocate) {
+        return;
     }
+    m_dirty.setBit(index);
+    m_hasDirty = true;
 }
 
-QColor GeneData::quadColor(const int index) const
+void GeneData::uploadAttributes()
 {
-    // all vertices has same color
-    return fromOpenGLColor(m_colors.at(index));
+    const char *data = reinterpret_cast<const char *>(m_attributes.constData());
+    const int spot_size = static_cast<int>(sizeof(SpotAttributes));
+    const int spots = m_dirty.size();
+    int spot = 0;
+    while (spot < spots) {
+        if (!m_dirty.testBit(spot)) {
+            ++spot;
+            continue;
+        }
+        // the range goes on while the gap to the next modified spot is small
+        int last = spot;
+        for (int next = spot + 1; next < spots && next - last <= MAX_DIRTY_GAP; ++next) {
+            if (m_dirty.testBit(next)) {
+                last = next;
+            }
+        }
+        const int offset = spot * spot_size;
+        m_attributesBuffer.write(offset, data + offset, (last + 1 - spot) * spot_size);
+        spot = last + 1;
+    }
+    m_dirty.fill(false);
+    m_hasDirty = false;
 }
 
-bool GeneData::quadSelected(const int index) const
+bool GeneData::uploadBuffers()
 {
-    // all vertices has same value
-    return static_cast<bool>(m_selected.at(index));
+    if (m_reallocate) {
+        // the buffers are allocated and filled with the whole arrays
+        const int spots = spotsCount();
+        if (!m_positionsBuffer.isCreated()) {
+            m_positionsBuffer.create();
+            // the positions only change when the spots are created
+            m_positionsBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+        }
+        m_positionsBuffer.bind();
+        m_positionsBuffer.allocate(m_positions.constData(),
+                                   spots * static_cast<int>(sizeof(QVector2D)));
+        if (!m_attributesBuffer.isCreated()) {
+            m_attributesBuffer.create();
+            m_attributesBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+        }
+        m_attributesBuffer.bind();
+        m_attributesBuffer.allocate(m_attributes.constData(),
+                                    spots * static_cast<int>(sizeof(SpotAttributes)));
+        m_dirty.fill(false, spots);
+        m_hasDirty = false;
+        m_reallocate = false;
+        return true;
+    }
+
+    // only the modified spots are uploaded
+    if (m_hasDirty) {
+        m_attributesBuffer.bind();
+        uploadAttributes();
+    }
+    return false;
 }
 
-bool GeneData::quadVisible(const int index) const
+void GeneData::setAttributeBuffers(QOpenGLShaderProgram &program)
 {
-    // all vertices has same value
-    return static_cast<bool>(m_visible.at(index));
+    m_positionsBuffer.bind();
+    program.setAttributeBuffer(POSITION_ATTRIBUTE, GL_FLOAT, 0, 2);
+    program.enableAttributeArray(POSITION_ATTRIBUTE);
+
+    // QOpenGLShaderProgram always normalizes integer attributes so the
+    // interleaved attributes are set with glVertexAttribPointer
+    QOpenGLFunctions *functions = QOpenGLContext::currentContext()->functions();
+    m_attributesBuffer.bind();
+    for (const AttributeLayout &layout : ATTRIBUTES_LAYOUT) {
+        const int location = program.attributeLocation(layout.name);
+        if (location == -1) {
+            continue;
+        }
+        functions->glVertexAttribPointer(static_cast<GLuint>(location),
+                                         layout.tupleSize,
+                                         layout.type,
+                                         layout.normalized,
+                                         static_cast<GLsizei>(sizeof(SpotAttributes)),
+                                         reinterpret_cast<const void *>(layout.offset));
+        program.enableAttributeArray(location);
+    }
 }
 
-int GeneData::quadReads(const int index) const
+void GeneData::bindBuffers(QOpenGLShaderProgram &program)
 {
-    // all vertices has same value
-    return static_cast<int>(m_reads.at(index));
+    // vertex array objects are not available in every OpenGL 2 implementation
+    if (!m_vaoChecked) {
+        m_vao.create();
+        m_vaoChecked = true;
+    }
+    const bool allocated = uploadBuffers();
+    if (m_vao.isCreated()) {
+        // the bindings are stored in the vertex array object, they are set
+        // again only if the buffers were allocated
+        m_vao.bind();
+        if (allocated || !m_vaoConfigured) {
+            setAttributeBuffers(program);
+            m_vaoConfigured = true;
+        }
+    } else {
+        setAttributeBuffers(program);
+    }
 }
 
-void GeneData::clearSelectionArray()
+void GeneData::releaseBuffers(QOpenGLShaderProgram &program)
 {
-    std::fill(m_selected.begin(), m_selected.end(), 0.0);
+    if (m_vao.isCreated()) {
+        m_vao.release();
+    } else {
+        program.disableAttributeArray(POSITION_ATTRIBUTE);
+        for (const AttributeLayout &layout : ATTRIBUTES_LAYOUT) {
+            program.disableAttributeArray(layout.name);
+        }
+    }
+    QOpenGLBuffer::release(QOpenGLBuffer::VertexBuffer);
 }
@@ -3,22 +3,40 @@
 
 #include <QVector>
 #include <QVector2D>
-#include <QVector3D>
-#include <QVector4D>
 #include <QColor>
+#include <QBitArray>
+#include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
+
+class QOpenGLShaderProgram;
 
 // This class contains the GeneRendererGL visual
 // data containers and it presents an easy interface
 // to add/remove/update data
-// The main principle is that the data points are stored
-// as triangles but they are represented as quads
-// Each spot in the array will be represented as one quad
+// Each spot in the array is represented by a single vertex which is drawn
+// as a point sprite (the shaders draw the shape of the spot in the point)
 // and the color of the spot will be computed summing up
 // all the gene counts in the spot (accounting for thresholds)
+// The attributes of a spot which are updated together (color, flags and
+// value) are packed in a small struct and stored interleaved in one OpenGL
+// buffer, the positions are stored in another one as they do not change.
+// The spots modified by the update functions are marked and only those ranges
+// are uploaded to the buffers before the next draw
 class GeneData
 {
 
 public:
+    // the interleaved attributes of a spot (12 bytes), the color is read as
+    // normalized RGBA8 and the flags as an integer by the shaders
+    struct SpotAttributes {
+        enum Flags { Visible = 1, Selected = 2 };
+
+        quint8 color[4];
+        quint8 flags;
+        quint8 padding[3];
+        float value;
+    };
+
     GeneData();
     ~GeneData();
 
@@ -26,56 +44,72 @@ public:
     void clearData();
 
     // adds a new data point to the arrays (returns the new index of the element)
-    int addQuad(const float x,
-                const float y,
-                const float size = 1.0,
-                const QColor &color = Qt::white);
-
-    // update geometry and rendering data
-    void updateQuadSize(const int index, const float x, const float y, const float size);
-    void updateQuadColor(const int index, const QColor &newcolor);
-    void updateQuadSelected(const int index, const bool selected);
-    void updateQuadVisible(const int index, const bool visible);
-    void updateQuadReads(const int index, const int reads);
+    // the spots are indexed in order of creation (0 to number of spots - 1)
+    int addSpot(const float x, const float y, const QColor &color = Qt::white);
+
+    // update rendering data (a spot that is not visible is not selected)
+    void updateSpot(const int index, const int reads, const bool visible, const QColor &color);
+    void updateSpot(const int index, const int reads, const bool visible, const QRgb color);
+    void updateSpotColor(const int index, const QColor &newcolor);
+    void updateSpotSelected(const int index, const bool selected);
+    void updateSpotVisible(const int index, const bool visible);
+    void updateSpotReads(const int index, const int reads);
 
     // some getters
-    QColor quadColor(const int index) const;
-    bool quadSelected(const int index) const;
-    bool quadVisible(const int index) const;
-    int quadReads(const int index) const;
+    QColor spotColor(const int index) const;
+    bool spotSelected(const int index) const;
+    bool spotVisible(const int index) const;
+    int spotReads(const int index) const;
 
     // set selected array to all false
     void clearSelectionArray();
 
+    // number of spots (vertices to draw as GL_POINTS)
+    int spotsCount() const;
+
+    // uploads the data modified since the last call to the OpenGL buffers and
+    // binds the buffers to the attributes of the shader program
+    // a current OpenGL context is needed
+    void bindBuffers(QOpenGLShaderProgram &program);
+    // releases the buffers bound with bindBuffers()
+    void releaseBuffers(QOpenGLShaderProgram &program);
+
+    // the attributes of the spots (the data uploaded to the buffers)
+    const QVector<QVector2D> &positions() const;
+    const QVector<SpotAttributes> &attributes() const;
+
+private:
+    // sets or clears a flag of the spot
+    void setSpotFlag(const int index, const quint8 flag, const bool enable);
+    // marks the attributes of the spot to be uploaded
+    void setDirty(const int index);
+    // uploads the modified spots, close ranges are merged to make fewer uploads
+    void uploadAttributes();
+    // uploads the modified data (the buffers are allocated again if spots
+    // were added or removed), returns true if the buffers were allocated
+    bool uploadBuffers();
+    // sets the buffers as the attribute arrays of the shader program
+    void setAttributeBuffers(QOpenGLShaderProgram &program);
+
     // OpenGL data arrays
-    QVector<QVector3D> m_vertices;
-    QVector<QVector2D> m_textures;
-    QVector<QVector4D> m_colors;
-    QVector<unsigned> m_indexes;
-    // Implicit converstion here
-    // but the rendering data is being
-    // refactored. Computation of color
-    // will not be performed in the shaders..
-    QVector<float> m_reads;
-    QVector<float> m_visible;
-    QVector<float> m_selected;
-
-    /* NEW RENDERING DATA MODEL
-    // the spots numered from 1 to num_spots
-    std::vector<int> indexes;
-    // gene index is the position of the index in the list of counts for each spot
-    // not to confuxed to the index of a spot. The gene index is just the position of the count
-    std::unordered_map<QString, int> gene_index;
-    // a simple map from spot coordinate (x,y) to spot index
-    std::unordered_map<std::pair<int, int>, int> spot_index;
-    // vector of vectors
-    std::vector<std::vector<int> > index_counts;
-
-    std::vector<int> getCountsGene(const QString &geneName) const;
-    std::vector<int> getCountsSpot(const std::pair<int, int> spot) const;
-    std::vector<int> getAccumulatedCounts() const;
-    int getCount(const QString &geneName, const std::pair<int, int> spot) const;
-*/
+    QVector<QVector2D> m_positions;
+    QVector<SpotAttributes> m_attributes;
+
+    // OpenGL buffers
+    QOpenGLBuffer m_positionsBuffer;
+    QOpenGLBuffer m_attributesBuffer;
+    // the attribute arrays bindings (if vertex array objects are supported)
+    QOpenGLVertexArrayObject m_vao;
+    // the spots modified since the last upload (one bit per spot)
+    QBitArray m_dirty;
+    bool m_hasDirty;
+    // the buffers must be allocated again (spots were added or removed)
+    bool m_reallocate;
+    // the creation of the vertex array object has been tried
+    bool m_vaoChecked;
+    // the vertex array object has the attribute arrays bindings
+    bool m_vaoConfigured;
+
     Q_DISABLE_COPY(GeneData)
 };
 
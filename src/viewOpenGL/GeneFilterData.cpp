@@ -0,0 +1,180 @@
+#include "GeneFilterData.h"
+
+#include <QOpenGLShaderProgram>
+#include <QOpenGLTexture>
+
+#include <algorithm>
+
+// the number of columns of the textures (a power of two so the shaders
+// compute the row and column of a texel exactly)
+static const int TEXTURE_WIDTH = 1024;
+// the texture units of the samplers
+static const int COUNTS_TEXTURE_UNIT = 0;
+static const int GENES_TEXTURE_UNIT = 1;
+static const int STATES_TEXTURE_UNIT = 2;
+// the largest integer stored in a texel (24 bits)
+static const int MAX_TEXEL_VALUE = (1 << 24) - 1;
+
+static const char *SPOTS_ATTRIBUTE = "filterAttr";
+
+GeneFilterData::GeneFilterData()
+    : m_featuresDirty(true)
+    , m_statesDirty(true)
+{
+}
+
+GeneFilterData::~GeneFilterData()
+{
+}
+
+void GeneFilterData::clearData()
+{
+    m_spots.clear();
+    m_countsTexels.clear();
+    m_genesTexels.clear();
+    m_statesTexels.clear();
+    m_featuresDirty = true;
+    m_statesDirty = true;
+}
+
+void GeneFilterData::setFeatures(const FeatureStore &features,
+                                 const QVector<int> &totalReads,
+                                 const QVector<int> &totalGenes)
+{
+    Q_ASSERT(features.hasIndexes());
+    const QVector<int> &spotOffsets = features.spotOffsets();
+    const QVector<int> &spotFeatures = features.spotFeatures();
+    const QVector<quint32> &geneIds = features.geneIds();
+    const QVector<int> &counts = features.counts();
+
+    // the range of features of each spot and its totals
+    m_spots.resize(features.spotsCount());
+    for (int spot = 0; spot < features.spotsCount(); ++spot) {
+        m_spots[spot] = QVector4D(spotOffsets.at(spot),
+                                  spotOffsets.at(spot + 1) - spotOffsets.at(spot),
+                                  totalReads.at(spot),
+                                  totalGenes.at(spot));
+    }
+
+    // the count and the gene of the features in order of spot
+    const int texels = textureRows(features.size()) * TEXTURE_WIDTH;
+    m_countsTexels.fill(0, texels * 4);
+    m_genesTexels.fill(0, texels * 4);
+    for (int i = 0; i < spotFeatures.size(); ++i) {
+        const int feature = spotFeatures.at(i);
+        setTexel(m_countsTexels, i, counts.at(feature));
+        setTexel(m_genesTexels, i, static_cast<int>(geneIds.at(feature)));
+    }
+    m_featuresDirty = true;
+}
+
+void GeneFilterData::setGeneStates(const QVector<DataRenderer::GeneState> &states)
+{
+    // two texels per gene, the color and the cut-off (the alpha component
+    // is 255 if the gene is selected)
+    const int texels = textureRows(states.size() * 2) * TEXTURE_WIDTH;
+    m_statesTexels.fill(0, texels * 4);
+    for (int gene = 0; gene < states.size(); ++gene) {
+        const DataRenderer::GeneState &state = states.at(gene);
+        quint8 *color = m_statesTexels.data() + gene * 8;
+        for (int i = 0; i < 4; ++i) {
+            color[i] = static_cast<quint8>(state.color[i] * 255.0f + 0.5f);
+        }
+        setTexel(m_statesTexels, gene * 2 + 1, state.cutoff);
+        color[7] = state.selected ? 255 : 0;
+    }
+    m_statesDirty = true;
+}
+
+bool GeneFilterData::isSupported(GraphicItemGL::QOpenGLFunctionsVersion &qopengl_functions) const
+{
+    GLint vertexUnits = 0;
+    qopengl_functions.glGetIntegerv(GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS, &vertexUnits);
+    GLint maxSize = 0;
+    qopengl_functions.glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    const int rows = std::max(m_countsTexels.size(), m_statesTexels.size()) / (TEXTURE_WIDTH * 4);
+    // the offsets of the features are passed to the shader as floats, which
+    // are only exact below 2^24
+    const int featureTexels = m_countsTexels.size() / 4;
+    return vertexUnits > STATES_TEXTURE_UNIT && maxSize >= TEXTURE_WIDTH && rows <= maxSize
+           && featureTexels <= MAX_TEXEL_VALUE;
+}
+
+void GeneFilterData::bind(QOpenGLShaderProgram &program,
+                          GraphicItemGL::QOpenGLFunctionsVersion &qopengl_functions)
+{
+    if (m_featuresDirty) {
+        m_countsTexture.reset(createTexture(m_countsTexels));
+        m_genesTexture.reset(createTexture(m_genesTexels));
+        if (!m_spotsBuffer.isCreated()) {
+            m_spotsBuffer.create();
+            m_spotsBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+        }
+        m_spotsBuffer.bind();
+        m_spotsBuffer.allocate(m_spots.constData(),
+                               m_spots.size() * static_cast<int>(sizeof(QVector4D)));
+        m_featuresDirty = false;
+    }
+    if (m_statesDirty) {
+        m_statesTexture.reset(createTexture(m_statesTexels));
+        m_statesDirty = false;
+    }
+
+    m_countsTexture->bind(COUNTS_TEXTURE_UNIT);
+    m_genesTexture->bind(GENES_TEXTURE_UNIT);
+    m_statesTexture->bind(STATES_TEXTURE_UNIT);
+    program.setUniformValue("in_countsTexture", COUNTS_TEXTURE_UNIT);
+    program.setUniformValue("in_genesTexture", GENES_TEXTURE_UNIT);
+    program.setUniformValue("in_statesTexture", STATES_TEXTURE_UNIT);
+    program.setUniformValue("in_textureWidth", static_cast<GLfloat>(TEXTURE_WIDTH));
+    program.setUniformValue("in_featuresRows",
+                            static_cast<GLfloat>(m_countsTexture->height()));
+    program.setUniformValue("in_statesRows", static_cast<GLfloat>(m_statesTexture->height()));
+
+    m_spotsBuffer.bind();
+    program.setAttributeBuffer(SPOTS_ATTRIBUTE, GL_FLOAT, 0, 4);
+    program.enableAttributeArray(SPOTS_ATTRIBUTE);
+    QOpenGLBuffer::release(QOpenGLBuffer::VertexBuffer);
+    qopengl_functions.glActiveTexture(GL_TEXTURE0);
+}
+
+void GeneFilterData::release(QOpenGLShaderProgram &program,
+                             GraphicItemGL::QOpenGLFunctionsVersion &qopengl_functions)
+{
+    // the attribute is disabled before the vertex array object of the
+    // GeneData is released as it would be stored in it
+    program.disableAttributeArray(SPOTS_ATTRIBUTE);
+    m_statesTexture->release(STATES_TEXTURE_UNIT);
+    m_genesTexture->release(GENES_TEXTURE_UNIT);
+    m_countsTexture->release(COUNTS_TEXTURE_UNIT);
+    qopengl_functions.glActiveTexture(GL_TEXTURE0);
+}
+
+QOpenGLTexture *GeneFilterData::createTexture(const QVector<quint8> &texels)
+{
+    QOpenGLTexture *texture = new QOpenGLTexture(QOpenGLTexture::Target2D);
+    texture->setAutoMipMapGenerationEnabled(false);
+    texture->setFormat(QOpenGLTexture::RGBA8_UNorm);
+    texture->setSize(TEXTURE_WIDTH, texels.size() / (TEXTURE_WIDTH * 4));
+    texture->allocateStorage();
+    texture->setData(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8, texels.constData());
+    // the texels are read exactly (no interpolation)
+    texture->setMinMagFilters(QOpenGLTexture::Nearest, QOpenGLTexture::Nearest);
+    texture->setWrapMode(QOpenGLTexture::ClampToEdge);
+    return texture;
+}
+
+void GeneFilterData::setTexel(QVector<quint8> &texels, const int texel, const int value)
+{
+    const int clamped = std::min(std::max(value, 0), MAX_TEXEL_VALUE);
+    quint8 *rgb = texels.data() + texel * 4;
+    rgb[0] = static_cast<quint8>(clamped & 0xFF);
+    rgb[1] = static_cast<quint8>((clamped >> 8) & 0xFF);
+    rgb[2] = static_cast<quint8>((clamped >> 16) & 0xFF);
+}
+
+int GeneFilterData::textureRows(const int texels)
+{
+    // textures have at least one row
+    return std::max(1, (texels + TEXTURE_WIDTH - 1) / TEXTURE_WIDTH);
+}
@@ -0,0 +1,88 @@
+#ifndef GENEFILTERDATA_H
+#define GENEFILTERDATA_H
+
+#include <QVector>
+#include <QVector4D>
+#include <QOpenGLBuffer>
+#include <QScopedPointer>
+
+#include "dataModel/FeatureStore.h"
+#include "concurrent/DataRenderer.h"
+#include "GraphicItemGL.h"
+
+class QOpenGLShaderProgram;
+class QOpenGLTexture;
+
+// This class contains the data of the GPU filtering mode of the GeneRendererGL
+// In this mode the thresholds and cut-off tests and the blending of the
+// colors of the genes are done in the vertex shader so changing a threshold
+// is only a uniform update. It is only used in the normal visual mode as the
+// pooled modes normalize the values with the min-max of all the visible spots
+// (computed in the CPU).
+// The features are uploaded once sorted by spot (CSR) in two textures (the
+// count and the gene id of each feature) and the state of the genes in a
+// third one (the color and the cut-off/selected of each gene). Each spot gets
+// its range of features and its total reads/genes as a vertex attribute.
+// OpenGL 2.0 has no integer or float textures so the integers are stored in
+// the RGB components of RGBA8 textures (24 bits) and the vertex shader reads
+// them with texture2DLod (vertex texture fetch, supported by Mesa llvmpipe)
+class GeneFilterData
+{
+
+public:
+    GeneFilterData();
+    ~GeneFilterData();
+
+    // clear data arrays
+    void clearData();
+
+    // sets the features (the look up indexes must be built) and the totals
+    // of the spots (indexed by spot id)
+    void setFeatures(const FeatureStore &features,
+                     const QVector<int> &totalReads,
+                     const QVector<int> &totalGenes);
+    // sets the states of the genes (indexed by gene id)
+    void setGeneStates(const QVector<DataRenderer::GeneState> &states);
+
+    // true if the OpenGL implementation can read the textures in the vertex
+    // shader and they fit in its maximum texture size (and there are fewer
+    // than 2^24 features so their offsets are exact in the shader)
+    bool isSupported(GraphicItemGL::QOpenGLFunctionsVersion &qopengl_functions) const;
+
+    // uploads the data modified since the last call, binds the textures to
+    // the samplers and the spots buffer to the attribute of the shader program
+    // a current OpenGL context is needed (after GeneData::bindBuffers())
+    void bind(QOpenGLShaderProgram &program,
+              GraphicItemGL::QOpenGLFunctionsVersion &qopengl_functions);
+    // releases the textures and the attribute bound with bind()
+    void release(QOpenGLShaderProgram &program,
+                 GraphicItemGL::QOpenGLFunctionsVersion &qopengl_functions);
+
+private:
+    // creates a texture of TEXTURE_WIDTH columns with the texels
+    // (4 bytes per texel)
+    static QOpenGLTexture *createTexture(const QVector<quint8> &texels);
+    // stores the value in the RGB components of the texel
+    static void setTexel(QVector<quint8> &texels, const int texel, const int value);
+    // the number of rows of a texture with the given number of texels
+    static int textureRows(const int texels);
+
+    // data arrays
+    QVector<QVector4D> m_spots;
+    QVector<quint8> m_countsTexels;
+    QVector<quint8> m_genesTexels;
+    QVector<quint8> m_statesTexels;
+
+    // OpenGL objects
+    QOpenGLBuffer m_spotsBuffer;
+    QScopedPointer<QOpenGLTexture> m_countsTexture;
+    QScopedPointer<QOpenGLTexture> m_genesTexture;
+    QScopedPointer<QOpenGLTexture> m_statesTexture;
+    // the data must be uploaded again
+    bool m_featuresDirty;
+    bool m_statesDirty;
+
+    Q_DISABLE_COPY(GeneFilterData)
+};
+
+#endif // GENEFILTERDATA_H
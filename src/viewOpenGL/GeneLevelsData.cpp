@@ -0,0 +1,223 @@
+#include "GeneLevelsData.h"
+
+#include <QHash>
+
+#include <algorithm>
+#include <cmath>
+
+// the minimum distance in pixels between the points drawn, the spots closer
+// than this are drawn aggregated in bins
+static const float MIN_BIN_PIXELS = 2.0f;
+// levels are added until a level has fewer bins than this
+static const int MIN_LEVEL_BINS = 64;
+static const int MAX_LEVELS = 12;
+
+// the bins of a level and their rendering data
+struct GeneLevelsData::Level {
+    // the bin of each spot and the spots of each bin (CSR), the spots of bin
+    // are the elements [offsets[bin], offsets[bin + 1]) of the spots
+    QVector<int> spotBins;
+    QVector<int> binOffsets;
+    QVector<int> binSpots;
+    // the bins to aggregate before the level is drawn
+    QBitArray dirtyBins;
+    bool hasDirty;
+    // a spot for each bin
+    GeneData data;
+};
+
+GeneLevelsData::GeneLevelsData()
+    : m_spacing(1.0f)
+{
+}
+
+GeneLevelsData::~GeneLevelsData()
+{
+}
+
+void GeneLevelsData::clearData()
+{
+    m_levels.clear();
+    m_spacing = 1.0f;
+}
+
+void GeneLevelsData::generateLevels(const GeneData &spots)
+{
+    clearData();
+    const QVector<QVector2D> &positions = spots.positions();
+    if (positions.size() <= MIN_LEVEL_BINS) {
+        return;
+    }
+
+    // the bounding box of the spots
+    float minX = positions.first().x();
+    float minY = positions.first().y();
+    float maxX = minX;
+    float maxY = minY;
+    for (const QVector2D &position : positions) {
+        minX = std::min(position.x(), minX);
+        minY = std::min(position.y(), minY);
+        maxX = std::max(position.x(), maxX);
+        maxY = std::max(position.y(), maxY);
+    }
+
+    // the spots are a grid so the average spacing is given by the area
+    const float width = maxX - minX;
+    const float height = maxY - minY;
+    if (width > 0.0f && height > 0.0f) {
+        m_spacing = std::sqrt((width * height) / positions.size());
+    } else if (width + height > 0.0f) {
+        m_spacing = (width + height) / positions.size();
+    } else {
+        // all the spots are in the same position
+        return;
+    }
+
+    // each level has bins twice as big as the previous one
+    int bins = positions.size();
+    for (int level = 0; level < MAX_LEVELS && bins > MIN_LEVEL_BINS; ++level) {
+        m_levels.push_back(createLevel(spots, m_spacing * levelScale(level), minX, minY));
+        bins = m_levels.last()->data.spotsCount();
+    }
+}
+
+void GeneLevelsData::setSpotsDirty(const QVector<int> &indexes)
+{
+    for (const QSharedPointer<Level> &level : m_levels) {
+        for (const int index : indexes) {
+            level->dirtyBins.setBit(level->spotBins.at(index));
+        }
+        level->hasDirty = level->hasDirty || !indexes.isEmpty();
+    }
+}
+
+void GeneLevelsData::setAllDirty()
+{
+    for (const QSharedPointer<Level> &level : m_levels) {
+        level->dirtyBins.fill(true);
+        level->hasDirty = true;
+    }
+}
+
+int GeneLevelsData::levelForScale(const float pixelsPerUnit) const
+{
+    const float spacingPixels = pixelsPerUnit * m_spacing;
+    if (m_levels.isEmpty() || spacingPixels >= MIN_BIN_PIXELS) {
+        return -1;
+    }
+    // the first level whose bins are far enough
+    for (int level = 0; level < m_levels.size(); ++level) {
+        if (spacingPixels * levelScale(level) >= MIN_BIN_PIXELS) {
+            return level;
+        }
+    }
+    return m_levels.size() - 1;
+}
+
+float GeneLevelsData::levelScale(const int level) const
+{
+    return static_cast<float>(2 << level);
+}
+
+GeneData &GeneLevelsData::levelData(const int level, const GeneData &spots)
+{
+    Level &data = *m_levels.at(level);
+    if (data.hasDirty) {
+        for (int bin = 0; bin < data.dirtyBins.size(); ++bin) {
+            if (data.dirtyBins.testBit(bin)) {
+                aggregateBin(data, bin, spots);
+            }
+        }
+        data.dirtyBins.fill(false);
+        data.hasDirty = false;
+    }
+    return data.data;
+}
+
+QSharedPointer<GeneLevelsData::Level> GeneLevelsData::createLevel(const GeneData &spots,
+                                                                  const float binSize,
+                                                                  const float minX,
+                                                                  const float minY) const
+{
+    QSharedPointer<Level> level(new Level);
+    const QVector<QVector2D> &positions = spots.positions();
+
+    // the bin of each spot is given by the cell of the grid of bins it is in
+    // (only the cells with spots get a bin)
+    QHash<quint64, int> cellBins;
+    QVector<QVector2D> centroids;
+    level->spotBins.resize(positions.size());
+    level->binOffsets.push_back(0);
+    for (int spot = 0; spot < positions.size(); ++spot) {
+        const QVector2D &position = positions.at(spot);
+        const quint64 column = static_cast<quint32>((position.x() - minX) / binSize);
+        const quint64 row = static_cast<quint32>((position.y() - minY) / binSize);
+        const quint64 cell = (column << 32) | row;
+        auto it = cellBins.find(cell);
+        if (it == cellBins.end()) {
+            it = cellBins.insert(cell, centroids.size());
+            centroids.push_back(QVector2D());
+            level->binOffsets.push_back(0);
+        }
+        const int bin = it.value();
+        level->spotBins[spot] = bin;
+        centroids[bin] += position;
+        ++level->binOffsets[bin + 1];
+    }
+
+    // counting sort of the spots by bin
+    const int bins = centroids.size();
+    for (int bin = 0; bin < bins; ++bin) {
+        // a bin is drawn in the centroid of its spots
+        const QVector2D centroid = centroids.at(bin) / level->binOffsets.at(bin + 1);
+        level->data.addSpot(centroid.x(), centroid.y());
+        level->binOffsets[bin + 1] += level->binOffsets.at(bin);
+    }
+    QVector<int> next(level->binOffsets);
+    level->binSpots.resize(positions.size());
+    for (int spot = 0; spot < positions.size(); ++spot) {
+        level->binSpots[next[level->spotBins.at(spot)]++] = spot;
+    }
+
+    level->dirtyBins.fill(true, bins);
+    level->hasDirty = true;
+    return level;
+}
+
+void GeneLevelsData::aggregateBin(Level &level, const int bin, const GeneData &spots)
+{
+    const QVector<GeneData::SpotAttributes> &attributes = spots.attributes();
+    float color[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float value = 0.0f;
+    int visible = 0;
+    bool selected = false;
+    for (int i = level.binOffsets.at(bin); i < level.binOffsets.at(bin + 1); ++i) {
+        const GeneData::SpotAttributes &spot = attributes.at(level.binSpots.at(i));
+        if ((spot.flags & GeneData::SpotAttributes::Visible) == 0) {
+            continue;
+        }
+        for (int c = 0; c < 4; ++c) {
+            color[c] += spot.color[c];
+        }
+        value += spot.value;
+        ++visible;
+        selected = selected || (spot.flags & GeneData::SpotAttributes::Selected) != 0;
+    }
+
+    // the bin is visible if any of its spots is
+    if (visible == 0) {
+        level.data.updateSpot(bin, 0, false, qRgba(0, 0, 0, 0));
+        return;
+    }
+    const auto average = [visible](const float sum) {
+        return static_cast<int>(sum / visible + 0.5f);
+    };
+    level.data.updateSpot(bin,
+                          average(value),
+                          true,
+                          qRgba(average(color[0]),
+                                average(color[1]),
+                                average(color[2]),
+                                average(color[3])));
+    level.data.updateSpotSelected(bin, selected);
+}
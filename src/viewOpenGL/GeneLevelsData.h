@@ -0,0 +1,65 @@
+#ifndef GENELEVELSDATA_H
+#define GENELEVELSDATA_H
+
+#include <QVector>
+#include <QBitArray>
+#include <QSharedPointer>
+
+#include "GeneData.h"
+
+// This class contains the levels of detail of the spots of the GeneRendererGL
+// Each level groups the spots in square bins (the bins of a level are twice
+// as big as the ones of the previous level) and every bin is drawn as a single
+// spot with the aggregated attributes of its spots (average color and value
+// of the visible spots, visible and selected if any of its spots is).
+// When the array is zoomed out and the spots are only a few pixels apart
+// the level whose bins are at least MIN_BIN_PIXELS apart is drawn instead of
+// the spots so the number of points drawn is bounded by the size of the view.
+// The levels are built once per dataset and only the bins of the spots marked
+// as modified are aggregated again (before the level is drawn)
+class GeneLevelsData
+{
+
+public:
+    GeneLevelsData();
+    ~GeneLevelsData();
+
+    // clear data arrays
+    void clearData();
+
+    // builds the levels from the positions of the spots
+    void generateLevels(const GeneData &spots);
+
+    // marks the bins of the spots to be aggregated again
+    void setSpotsDirty(const QVector<int> &indexes);
+    void setAllDirty();
+
+    // returns the level to draw given the size in pixels of a unit of the
+    // spots coordinates (-1 if the spots must be drawn)
+    int levelForScale(const float pixelsPerUnit) const;
+    // the scale of the bins of the level relative to the spacing of the spots
+    float levelScale(const int level) const;
+
+    // aggregates the modified bins of the level and returns its rendering data
+    GeneData &levelData(const int level, const GeneData &spots);
+
+private:
+    struct Level;
+
+    // builds the bins of the given size
+    QSharedPointer<Level> createLevel(const GeneData &spots,
+                                      const float binSize,
+                                      const float minX,
+                                      const float minY) const;
+    // computes the attributes of the bin from its spots
+    static void aggregateBin(Level &level, const int bin, const GeneData &spots);
+
+    QVector<QSharedPointer<Level>> m_levels;
+    // the average distance between the spots (the size of a bin of level 0
+    // is twice this distance)
+    float m_spacing;
+
+    Q_DISABLE_COPY(GeneLevelsData)
+};
+
+#endif // GENELEVELSDATA_H
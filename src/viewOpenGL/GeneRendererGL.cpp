@@ -5,52 +5,101 @@
 #include <QOpenGLShaderProgram>
 #include <QImageReader>
 #include <QApplication>
+#include <QMouseEvent>
+#include <QToolTip>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 
 #include "dataModel/UserSelection.h"
 #include "dataModel/Feature.h"
 #include "dataModel/Gene.h"
 #include "SettingsVisual.h"
 
-static const int INVALID_INDEX = -1;
 static const float GENE_SIZE_DEFAULT = 0.5;
 static const float GENE_INTENSITY_DEFAULT = 1.0;
 static const GeneRendererGL::GeneShape DEFAULT_SHAPE_GENE = GeneRendererGL::GeneShape::Circle;
+// the number of genes shown by the hover inspector
+static const int HOVER_TOP_GENES = 5;
+
+// an update of the rendering data, it has copies of the data (implicitly
+// shared) so it does not depend on the renderer while it is computed
+struct GeneRendererGL::UpdateJob {
+    FeatureStore features;
+    QVector<DataRenderer::GeneState> geneStates;
+    IndexTotalCount totalReads;
+    IndexTotalCount totalGenes;
+    DataRenderer::Settings settings;
+    // the spots to compute and their rendering data
+    IndexesList indexes;
+    QVector<DataRenderer::SpotData> spotsData;
+    int pooledMin;
+    int pooledMax;
+    // the generation of the last request included in the update
+    quint64 generation;
+};
 
 GeneRendererGL::GeneRendererGL(QSharedPointer<DataProxy> dataProxy, QObject *parent)
     : GraphicItemGL(parent)
+    , m_pendingAll(false)
+    , m_updateGeneration(0)
     , m_isInitialized(false)
     , m_dataProxy(dataProxy)
 {
     setVisualOption(GraphicItemGL::Transformable, true);
     setVisualOption(GraphicItemGL::Visible, true);
-    setVisualOption(GraphicItemGL::Selectable, false);
+    // selectable so it gets the mouse events (hover inspector)
+    setVisualOption(GraphicItemGL::Selectable, true);
     setVisualOption(GraphicItemGL::Yinverted, false);
     setVisualOption(GraphicItemGL::Xinverted, false);
     setVisualOption(GraphicItemGL::RubberBandable, true);
 
     // initialize variables
     clearData();
+
+    connect(&m_updateWatcher, SIGNAL(finished()), this, SLOT(slotUpdateFinished()));
 }
 
 GeneRendererGL::~GeneRendererGL()
 {
+    m_updateWatcher.waitForFinished();
 }
 
 void GeneRendererGL::clearData()
 {
+    // the update being computed is dropped
+    m_updateWatcher.waitForFinished();
+    m_updateJob.clear();
+    m_pendingAll = false;
+    m_pendingIndexes.clear();
+    m_pendingIndexesAdded.clear();
+
     // clear gene plot data
     m_geneData.clearData();
+    m_filterData.clearData();
+    m_levelsData.clearData();
 
     // clear selection
-    m_geneInfoSelectedFeatures.clear();
+    m_selectedFeatures.clear();
+    m_selectedFeaturesCount = 0;
 
     // lookup data
-    m_geneInfoByIndex.clear();
+    m_features.clear();
     m_geneInfoTotalReadsIndex.clear();
     m_geneInfoTotalGenesIndex.clear();
-    m_geneInfoByGene.clear();
-    m_geneInfoByGeneFeatures.clear();
+    m_genes.clear();
+    m_geneStates.clear();
     m_indexes.clear();
+    m_geneSpotsOffsets.clear();
+    m_geneSpots.clear();
+    m_spotsIndex.clear();
+    m_hoveredSpot = -1;
+    m_updateIndexes.clear();
+    m_updateIndexesAdded.clear();
+    m_spotsByTotalReads.clear();
+    m_spotsByTotalGenes.clear();
+    m_featuresByCount.clear();
 
     // variables
     m_intensity = GENE_INTENSITY_DEFAULT;
@@ -65,6 +114,7 @@ void GeneRendererGL::clearData()
     m_localPooledMin = std::numeric_limits<int>::max();
     m_localPooledMax = std::numeric_limits<int>::min();
     m_genes_cutoff = true;
+    m_gpuFiltering = false;
 
     // visual mode
     m_visualMode = NormalMode;
@@ -95,55 +145,82 @@ void GeneRendererGL::setSize(float size)
 {
     if (m_size != size) {
         m_size = size;
-        updateSize();
+        // the size of the spots is a uniform of the shaders
+        emit updated();
     }
 }
 
 void GeneRendererGL::setReadsUpperLimit(const int limit)
 {
     if (m_thresholdReadsUpper != limit) {
+        const int previous = m_thresholdReadsUpper;
         m_thresholdReadsUpper = limit;
-        updateVisual();
+        updateThreshold(m_featuresByCount, m_features.counts(), previous, limit, UpperBound, true);
     }
 }
 
 void GeneRendererGL::setReadsLowerLimit(const int limit)
 {
     if (m_thresholdReadsLower != limit) {
+        const int previous = m_thresholdReadsLower;
         m_thresholdReadsLower = limit;
-        updateVisual();
+        updateThreshold(m_featuresByCount, m_features.counts(), previous, limit, LowerBound, true);
     }
 }
 
 void GeneRendererGL::setGenesUpperLimit(const int limit)
 {
     if (m_thresholdGenesUpper != limit) {
+        const int previous = m_thresholdGenesUpper;
         m_thresholdGenesUpper = limit;
-        updateVisual();
+        updateThreshold(m_spotsByTotalGenes,
+                        m_geneInfoTotalGenesIndex,
+                        previous,
+                        limit,
+                        UpperBound,
+                        false);
     }
 }
 
 void GeneRendererGL::setGenesLowerLimit(const int limit)
 {
     if (m_thresholdGenesLower != limit) {
+        const int previous = m_thresholdGenesLower;
         m_thresholdGenesLower = limit;
-        updateVisual();
+        updateThreshold(m_spotsByTotalGenes,
+                        m_geneInfoTotalGenesIndex,
+                        previous,
+                        limit,
+                        LowerBound,
+                        false);
     }
 }
 
 void GeneRendererGL::setTotalReadsUpperLimit(const int limit)
 {
     if (m_thresholdTotalReadsUpper != limit) {
+        const int previous = m_thresholdTotalReadsUpper;
         m_thresholdTotalReadsUpper = limit;
-        updateVisual();
+        updateThreshold(m_spotsByTotalReads,
+                        m_geneInfoTotalReadsIndex,
+                        previous,
+                        limit,
+                        UpperBound,
+                        false);
     }
 }
 
 void GeneRendererGL::setTotalReadsLowerLimit(const int limit)
 {
     if (m_thresholdTotalReadsLower != limit) {
+        const int previous = m_thresholdTotalReadsLower;
         m_thresholdTotalReadsLower = limit;
-        updateVisual();
+        updateThreshold(m_spotsByTotalReads,
+                        m_geneInfoTotalReadsIndex,
+                        previous,
+                        limit,
+                        LowerBound,
+                        false);
     }
 }
 
@@ -155,44 +232,68 @@ void GeneRendererGL::generateData()
     setupShaders();
 
     QGuiApplication::setOverrideCursor(Qt::WaitCursor);
-    for (const auto &feature : m_dataProxy->getFeatureList()) {
-        Q_ASSERT(feature);
-        // Get the feature's gene
-        auto gene = m_dataProxy->geneGeneObject(feature->gene());
-        Q_ASSERT(gene);
+    // the features store has the look up indexes by spot and gene and
+    // the genes look up is indexed by gene id
+    m_features = m_dataProxy->getFeatureStore();
+    Q_ASSERT(m_features.hasIndexes());
+    m_genes = m_dataProxy->getGeneList();
+    Q_ASSERT(m_genes.size() == m_features.genesCount());
+    m_geneStates.reserve(m_genes.size());
+    for (const auto &gene : m_genes) {
+        m_geneStates.push_back(DataRenderer::geneState(*gene));
+    }
 
-        // feature cordinates
-        const QPointF point(feature->x(), feature->y());
-
-        // test if point already exists (quad tree)
-        GeneInfoQuadTree::PointItem item(point, INVALID_INDEX);
-        m_geneInfoQuadTree.select(point, item);
-
-        // index corresponds to the index in the array of vertices for the OpenGL data
-        int index = item.second;
-
-        // if it does not exists, create a quad and store the index
-        if (item.second == INVALID_INDEX) {
-            index = m_geneData.addQuad(feature->x(),
-                                       feature->y(),
-                                       m_size,
-                                       Visual::DEFAULT_COLOR_GENE);
-            // update look up container for the quad tree
-            m_geneInfoQuadTree.insert(point, index);
-            // add to list of indexes
-            m_indexes.insert(index);
+    // a vertex for each spot, the OpenGL index is the spot id
+    const QVector<float> &spotsX = m_features.spotsX();
+    const QVector<float> &spotsY = m_features.spotsY();
+    GeneInfoQuadTree::PointItemList spotItems;
+    spotItems.reserve(m_features.spotsCount());
+    m_indexes.reserve(m_features.spotsCount());
+    for (int spot = 0; spot < m_features.spotsCount(); ++spot) {
+        const int index
+            = m_geneData.addSpot(spotsX.at(spot), spotsY.at(spot), Visual::DEFAULT_COLOR_GENE);
+        Q_ASSERT(index == spot);
+        spotItems.push_back(qMakePair(QPointF(spotsX.at(spot), spotsY.at(spot)), index));
+        // add to list of indexes
+        m_indexes.push_back(index);
+    }
+    // the look up container for the quad tree is built in one pass
+    m_geneInfoQuadTree.build(spotItems);
+    m_spotsIndex.build(spotsX, spotsY);
+
+    // the spots of each gene (a spot is added once even if the gene has
+    // several features in it)
+    const QVector<int> &geneOffsets = m_features.geneOffsets();
+    const QVector<int> &geneFeatures = m_features.geneFeatures();
+    const QVector<quint32> &featureSpots = m_features.spotIds();
+    QVector<int> lastGeneSpot(m_features.spotsCount(), -1);
+    m_geneSpotsOffsets.reserve(m_features.genesCount() + 1);
+    m_geneSpots.reserve(m_features.size());
+    m_geneSpotsOffsets.push_back(0);
+    for (int geneId = 0; geneId < m_features.genesCount(); ++geneId) {
+        for (int i = geneOffsets.at(geneId); i < geneOffsets.at(geneId + 1); ++i) {
+            const int index = static_cast<int>(featureSpots.at(geneFeatures.at(i)));
+            if (lastGeneSpot.at(index) != geneId) {
+                lastGeneSpot[index] = geneId;
+                m_geneSpots.push_back(index);
+            }
         }
-
-        // update look up container for the features and indexes
-        // multiple features per index
-        m_geneInfoByIndex.insert(index, feature);
-        // multiple indexes per gene
-        m_geneInfoByGene.insert(gene, index);
-        // mutiple count per gene
-        m_geneInfoByGeneFeatures[gene].push_back(feature->count());
-
-        // updated total reads/genes per spot/index
-        const int feature_reads = feature->count();
+        m_geneSpotsOffsets.push_back(m_geneSpots.size());
+    }
+    m_updateIndexes.reserve(m_features.spotsCount());
+    m_updateIndexesAdded.fill(false, m_features.spotsCount());
+    m_pendingIndexes.reserve(m_features.spotsCount());
+    m_pendingIndexesAdded.fill(false, m_features.spotsCount());
+    m_selectedFeatures.fill(false, m_features.size());
+
+    // updated total reads/genes per spot/index (in features order)
+    m_geneInfoTotalReadsIndex.fill(0, m_features.spotsCount());
+    m_geneInfoTotalGenesIndex.fill(0, m_features.spotsCount());
+    const QVector<quint32> &spotIds = m_features.spotIds();
+    const QVector<int> &counts = m_features.counts();
+    for (int i = 0; i < m_features.size(); ++i) {
+        const int index = static_cast<int>(spotIds.at(i));
+        const int feature_reads = counts.at(i);
         const int num_genes_spot = ++m_geneInfoTotalGenesIndex[index];
         const int num_reads_spot = m_geneInfoTotalReadsIndex[index] += feature_reads;
 
@@ -203,76 +304,39 @@ void GeneRendererGL::generateData()
         m_thresholdReadsUpper = std::max(feature_reads, m_thresholdReadsUpper);
         m_thresholdTotalReadsLower = std::min(num_reads_spot, m_thresholdTotalReadsLower);
         m_thresholdTotalReadsUpper = std::max(num_reads_spot, m_thresholdTotalReadsUpper);
+    }
 
-    } // endforeach
+    // the spots sorted by total reads/genes and the features sorted by count
+    // to find the ones affected by a change of the thresholds
+    m_spotsByTotalReads = m_indexes;
+    std::sort(m_spotsByTotalReads.begin(),
+              m_spotsByTotalReads.end(),
+              [this](const int a, const int b) {
+                  return m_geneInfoTotalReadsIndex.at(a) < m_geneInfoTotalReadsIndex.at(b);
+              });
+    m_spotsByTotalGenes = m_indexes;
+    std::sort(m_spotsByTotalGenes.begin(),
+              m_spotsByTotalGenes.end(),
+              [this](const int a, const int b) {
+                  return m_geneInfoTotalGenesIndex.at(a) < m_geneInfoTotalGenesIndex.at(b);
+              });
+    m_featuresByCount.resize(m_features.size());
+    std::iota(m_featuresByCount.begin(), m_featuresByCount.end(), 0);
+    std::sort(m_featuresByCount.begin(),
+              m_featuresByCount.end(),
+              [&counts](const int a, const int b) { return counts.at(a) < counts.at(b); });
+
+    // the data of the GPU filtering mode is uploaded on the first draw
+    m_filterData.setFeatures(m_features, m_geneInfoTotalReadsIndex, m_geneInfoTotalGenesIndex);
+    m_filterData.setGeneStates(m_geneStates);
+
+    // the bins drawn when the array is zoomed out
+    m_levelsData.generateLevels(m_geneData);
 
-    // compute gene's cut off
-    compuateGenesCutoff();
     QGuiApplication::restoreOverrideCursor();
     m_isInitialized = true;
 }
 
-void GeneRendererGL::compuateGenesCutoff()
-{
-    const int minseglen = 2;
-    for (auto gene : m_dataProxy->getGeneList()) {
-        Q_ASSERT(gene);
-        // get all the counts of the spots that contain that gene
-        auto counts = m_geneInfoByGeneFeatures.value(gene);
-        const size_t num_features = counts.size();
-        // if too little counts or if all the counts are the same cut off is the min count present
-        if (num_features < minseglen + 1
-            || std::equal(counts.begin() + 1, counts.end(), counts.begin())) {
-            const int cutoff = *std::min_element(counts.begin(), counts.end());
-            gene->cut_off(cutoff);
-            continue;
-        }
-        // sort the counts and compute a list of their squared sum
-        std::sort(counts.begin(), counts.end());
-        std::vector<int> squared_summed_counts(counts);
-        std::transform(squared_summed_counts.begin(),
-                       squared_summed_counts.end(),
-                       squared_summed_counts.begin(),
-                       squared_summed_counts.begin(),
-                       std::multiplies<int>());
-        std::partial_sum(squared_summed_counts.begin(),
-                         squared_summed_counts.end(),
-                         squared_summed_counts.begin());
-        squared_summed_counts.insert(squared_summed_counts.begin(), 0);
-        // generate a vector taustar with indexes of the counts
-        std::vector<int> taustar;
-        int n = minseglen;
-        std::generate_n(std::back_inserter(taustar),
-                        num_features + minseglen - 2 - 2,
-                        [n]() mutable { return n++; });
-        std::vector<float> tmp1;
-        std::vector<float> tmp2;
-        std::vector<float> tmp3;
-        const float last_count = static_cast<float>(squared_summed_counts.back());
-        // perform tmp3 = (squared_summed_counts / last_count) - (taustar / num_counts)
-        std::transform(squared_summed_counts.begin() + 2,
-                       squared_summed_counts.end() - 1,
-                       std::back_inserter(tmp1),
-                       [=](int count) { return count / last_count; });
-        std::transform(taustar.begin(),
-                       taustar.end(),
-                       std::back_inserter(tmp2),
-                       [=](int tau_value)
-        { return tau_value / static_cast<float>(num_features); });
-        std::transform(tmp1.begin(),
-                       tmp1.end(),
-                       tmp2.begin(),
-                       std::back_inserter(tmp3),
-                       [](float a, float b) { return std::fabs(a - b); });
-        // tau is the distance to the max element in tmp3 which is an index
-        const auto tau = std::distance(tmp3.begin(), std::max_element(tmp3.begin(), tmp3.end()));
-        // get the read count of the tau index and that is the gene cut off
-        const int est_readcount
-            = *std::upper_bound(counts.begin(), counts.end(), counts.at(tau));
-        gene->cut_off(est_readcount);
-    }
-}
-
 int GeneRendererGL::getMinReadsThreshold() const
 {
     return m_thresholdReadsLower;
@@ -303,25 +367,6 @@ int GeneRendererGL::getMaxTotalReadsThreshold() const
     return m_thresholdTotalReadsUpper;
 }
 
-void GeneRendererGL::updateSize()
-{
-    if (!m_isInitialized) {
-        return;
-    }
-
-    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
-    for (const auto index : m_indexes) {
-        // update size of the quad for only one feature
-        // (all features of same index have same coordinates)
-        const auto feature = m_geneInfoByIndex.value(index);
-        Q_ASSERT(feature);
-        m_geneData.updateQuadSize(index, feature->x(), feature->y(), m_size);
-    }
-
-    QGuiApplication::restoreOverrideCursor();
-    emit updated();
-}
-
 void GeneRendererGL::updateColor(const DataProxy::GeneList &geneList)
 {
     if (geneList.empty()) {
@@ -345,9 +390,7 @@ void GeneRendererGL::updateGene(const DataProxy::GenePtr gene)
     if (!gene) {
         return;
     }
-    // get unique indexes from the gene
-    auto unique_indexes = m_geneInfoByGene.values(gene);
-    updateVisual(IndexesList::fromList(unique_indexes));
+    updateVisual(DataProxy::GeneList() << gene);
 }
 
 void GeneRendererGL::updateVisual()
@@ -358,164 +401,325 @@ void GeneRendererGL::updateVisual()
 
 void GeneRendererGL::updateVisual(const DataProxy::GeneList &geneList)
 {
-    // get unique indexes from the list of genes
-    IndexesList unique_indexes;
-    for (const auto &gene : geneList) {
-        auto indexes = m_geneInfoByGene.values(gene);
-        unique_indexes.unite(IndexesList::fromList(indexes));
+    // the genes could have been modified
+    updateGeneStates(geneList);
+    // compute the rendering information for the spots of the genes
+    updateVisual(genesIndexes(geneList));
+}
+
+void GeneRendererGL::updateGeneStates(const DataProxy::GeneList &genes)
+{
+    for (const auto &gene : genes) {
+        Q_ASSERT(gene);
+        const int geneId = static_cast<int>(gene->id());
+        if (geneId < m_geneStates.size()) {
+            m_geneStates[geneId] = DataRenderer::geneState(*gene);
+        }
+    }
+    if (!genes.empty()) {
+        m_filterData.setGeneStates(m_geneStates);
     }
+}
 
-    // compute the rendering information for the selected genes
-    updateVisual(unique_indexes);
+const GeneRendererGL::IndexesList &GeneRendererGL::genesIndexes(
+    const DataProxy::GeneList &genes)
+{
+    // resize() keeps the capacity so the list is not allocated again
+    m_updateIndexes.resize(0);
+    for (const auto &gene : genes) {
+        Q_ASSERT(gene);
+        const int geneId = static_cast<int>(gene->id());
+        if (geneId >= m_features.genesCount()) {
+            continue;
+        }
+        for (int i = m_geneSpotsOffsets.at(geneId); i < m_geneSpotsOffsets.at(geneId + 1); ++i) {
+            addUpdateIndex(m_geneSpots.at(i));
+        }
+    }
+    return finishUpdateIndexes();
 }
 
-void GeneRendererGL::updateVisual(const IndexesList &indexes)
+void GeneRendererGL::addUpdateIndex(const int index)
 {
-    if (!m_isInitialized) {
-        return;
+    if (!m_updateIndexesAdded.testBit(index)) {
+        m_updateIndexesAdded.setBit(index);
+        m_updateIndexes.push_back(index);
     }
+}
 
-    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+const GeneRendererGL::IndexesList &GeneRendererGL::finishUpdateIndexes()
+{
+    for (const int index : m_updateIndexes) {
+        m_updateIndexesAdded.clearBit(index);
+    }
+    return m_updateIndexes;
+}
 
-    // we want to get the max and min value of the reads that are going
-    // to be rendered to pass these values to the shaders to compute normalized colors
-    m_localPooledMin = std::numeric_limits<int>::max();
-    m_localPooledMax = std::numeric_limits<int>::min();
+void GeneRendererGL::updateThreshold(const QVector<int> &sortedIds,
+                                     const QVector<int> &values,
+                                     const int previous,
+                                     const int limit,
+                                     const ThresholdBound bound,
+                                     const bool features)
+{
+    if (!m_isInitialized) {
+        return;
+    }
 
-    // some visualization options
-    const bool pooling_genes = m_poolingMode == Visual::PoolNumberGenes;
-    const bool pooling_tpm = m_poolingMode == Visual::PoolTPMs;
-    const bool isPooled = m_visualMode == DynamicRangeMode || m_visualMode == HeatMapMode;
+    // the pooled min-max are computed over all the spots
+    if (m_visualMode != NormalMode) {
+        updateVisual();
+        return;
+    }
 
-    // iterate the indexes (spots) to compute the visual data by going trough all the
-    // features (gene counts) in each spot
-    foreach (const auto &index, indexes) {
+    int first = 0;
+    int last = 0;
+    thresholdChangedRange(sortedIds, values, previous, limit, bound, first, last);
 
-        // check if spot's total reads/genes are inside the total reads/genes thresholds
-        const int total_reads_feature = m_geneInfoTotalReadsIndex.value(index);
-        const int total_genes_feature = m_geneInfoTotalGenesIndex.value(index);
-        if (featureGenesOutsideRange(total_genes_feature)
-            || featureTotalReadsOutsideRange(total_reads_feature)) {
-            // set spot to not visible
-            m_geneData.updateQuadSelected(index, false);
-            m_geneData.updateQuadVisible(index, false);
-            continue;
-        }
+    m_updateIndexes.resize(0);
+    const QVector<quint32> &spotIds = m_features.spotIds();
+    for (int i = first; i < last; ++i) {
+        const int id = sortedIds.at(i);
+        addUpdateIndex(features ? static_cast<int>(spotIds.at(id)) : id);
+    }
+    updateVisual(finishUpdateIndexes());
+}
 
-        // temp local variables to store the color of the spot
-        QColor indexColor = Visual::DEFAULT_COLOR_GENE;
-        int indexValue = 0;
-        int indexValueGenes = 0;
+void GeneRendererGL::thresholdChangedRange(const QVector<int> &sortedIds,
+                                           const QVector<int> &values,
+                                           const int previous,
+                                           const int limit,
+                                           const ThresholdBound bound,
+                                           int &first,
+                                           int &last)
+{
+    // only the values between both limits change from inside to outside
+    // the threshold (or the other way around)
+    const int low = std::min(previous, limit);
+    const int high = std::max(previous, limit);
+    QVector<int>::const_iterator begin;
+    QVector<int>::const_iterator end;
+    if (bound == LowerBound) {
+        // the values in [low, high) (outside if value < limit)
+        const auto less
+            = [&values](const int id, const int value) { return values.at(id) < value; };
+        begin = std::lower_bound(sortedIds.begin(), sortedIds.end(), low, less);
+        end = std::lower_bound(begin, sortedIds.end(), high, less);
+    } else {
+        // the values in (low, high] (outside if value > limit)
+        const auto greater
+            = [&values](const int value, const int id) { return value < values.at(id); };
+        begin = std::upper_bound(sortedIds.begin(), sortedIds.end(), low, greater);
+        end = std::upper_bound(begin, sortedIds.end(), high, greater);
+    }
+    first = static_cast<int>(begin - sortedIds.begin());
+    last = static_cast<int>(end - sortedIds.begin());
+}
 
-        // iterate the genes in the spot to compute rendering data for an specific index (spot)
-        for (const auto feature : m_geneInfoByIndex.values(index)) {
-            Q_ASSERT(feature);
-            // get the feature's gene
-            auto gene = m_dataProxy->geneGeneObject(feature->gene());
-            Q_ASSERT(gene);
+void GeneRendererGL::updateVisual(const IndexesList &indexes)
+{
+    if (!m_isInitialized) {
+        return;
+    }
 
-            // get the gene status and the count
-            const bool isSelected = gene->selected();
-            const int geneCutOff = gene->cut_off();
-            const int currentHits = feature->count();
+    // the spots are added to the pending ones, they are computed with the
+    // settings at the time the computation starts
+    ++m_updateGeneration;
+    addPendingIndexes(indexes);
+    startUpdate();
 
-            // check if the reads count of the gene in this spot are outside the threshold
-            // or the gene is not selected
-            if (featureReadsOutsideRange(currentHits)
-                || (m_genes_cutoff && currentHits < geneCutOff) || !isSelected) {
-                continue;
-            }
+    // in the GPU filtering mode the new settings are rendered right away, the
+    // computation is still needed for the selections
+    if (m_gpuFiltering && m_visualMode == NormalMode) {
+        emit updated();
+    }
+}
 
-            // update local variables for number of reads and genes
-            indexValue += currentHits;
-            ++indexValueGenes;
-
-            // when the color of the new feature is different than the color
-            // in the feature's index we do linear interpolation adjusted
-            // by the number of genes in the feature to obtain the new color
-            const QColor &featureColor = gene->color();
-            if (indexColor != featureColor) {
-                const float adjustment = 1.0 / indexValueGenes;
-                indexColor = Math::lerp(adjustment, indexColor, featureColor);
+void GeneRendererGL::addPendingIndexes(const IndexesList &indexes)
+{
+    // the indexes are unique so a list with all the spots is the full update
+    if (indexes.size() == m_indexes.size()) {
+        m_pendingAll = true;
+    } else if (!m_pendingAll) {
+        for (const int index : indexes) {
+            if (!m_pendingIndexesAdded.testBit(index)) {
+                m_pendingIndexesAdded.setBit(index);
+                m_pendingIndexes.push_back(index);
             }
         }
+    }
+}
 
-        // we only show indexes where there is at least one gene-feature activated
-        const bool visible = indexValueGenes > 0;
+void GeneRendererGL::startUpdate()
+{
+    if (m_updateJob || (!m_pendingAll && m_pendingIndexes.isEmpty())) {
+        return;
+    }
 
-        // update pooled min-max to compute colors if applies
-        if (isPooled && visible) {
-            if (pooling_genes) {
-                indexValue = indexValueGenes;
-            } else if (pooling_tpm) {
-                indexValue = Math::tpmNormalization<int>(indexValue, total_reads_feature);
-            }
-            // only update the boundaries for color computation in pooled mode
-            m_localPooledMin = std::min(indexValue, m_localPooledMin);
-            m_localPooledMax = std::max(indexValue, m_localPooledMax);
+    QSharedPointer<UpdateJob> job(new UpdateJob);
+    job->features = m_features;
+    job->geneStates = m_geneStates;
+    job->totalReads = m_geneInfoTotalReadsIndex;
+    job->totalGenes = m_geneInfoTotalGenesIndex;
+    job->settings.readsLower = m_thresholdReadsLower;
+    job->settings.readsUpper = m_thresholdReadsUpper;
+    job->settings.genesLower = m_thresholdGenesLower;
+    job->settings.genesUpper = m_thresholdGenesUpper;
+    job->settings.totalReadsLower = m_thresholdTotalReadsLower;
+    job->settings.totalReadsUpper = m_thresholdTotalReadsUpper;
+    job->settings.genesCutoff = m_genes_cutoff;
+    job->settings.pooled = m_visualMode == DynamicRangeMode || m_visualMode == HeatMapMode;
+    job->settings.poolingMode = m_poolingMode;
+    job->generation = m_updateGeneration;
+    if (m_pendingAll) {
+        job->indexes = m_indexes;
+    } else {
+        job->indexes = m_pendingIndexes;
+        for (const int index : m_pendingIndexes) {
+            m_pendingIndexesAdded.clearBit(index);
         }
+    }
+    m_pendingAll = false;
+    m_pendingIndexes.resize(0);
+
+    m_updateJob = job;
+    m_updateWatcher.setFuture(QtConcurrent::run(&GeneRendererGL::computeUpdate, job.data()));
+}
+
+void GeneRendererGL::computeUpdate(UpdateJob *job)
+{
+    DataRenderer::Input input;
+    input.features = &job->features;
+    input.geneStates = &job->geneStates;
+    input.totalReads = &job->totalReads;
+    input.totalGenes = &job->totalGenes;
+    input.settings = job->settings;
+    DataRenderer::render(input, job->indexes, job->spotsData, job->pooledMin, job->pooledMax);
+}
+
+void GeneRendererGL::slotUpdateFinished()
+{
+    // the update could have been finished already by finishUpdates()
+    if (!m_updateJob || !m_updateWatcher.future().isFinished()) {
+        return;
+    }
+    const QSharedPointer<UpdateJob> job = m_updateJob;
+    m_updateJob.clear();
+
+    if (job->generation != m_updateGeneration) {
+        // the settings changed while it was computed, the spots are computed
+        // again together with the pending ones. The stale data is still shown
+        // so the view follows the settings while they change (a slider drag)
+        // and the newer update overwrites it
+        addPendingIndexes(job->indexes);
+    }
 
-        // update rendering data arrays
-        m_geneData.updateQuadReads(index, indexValue);
-        m_geneData.updateQuadVisible(index, visible);
-        if (!visible) {
-            m_geneData.updateQuadSelected(index, false);
+    // we want to get the max and min value of the reads that are going
+    // to be rendered to pass these values to the shaders to compute normalized colors
+    m_localPooledMin = job->pooledMin;
+    m_localPooledMax = job->pooledMax;
+    // update rendering data arrays
+    for (int i = 0; i < job->indexes.size(); ++i) {
+        const int index = job->indexes.at(i);
+        const DataRenderer::SpotData &spotData = job->spotsData.at(i);
+        if (spotData.outside) {
+            // set spot to not visible
+            m_geneData.updateSpotSelected(index, false);
+            m_geneData.updateSpotVisible(index, false);
+        } else {
+            // the spot is unselected if it is not visible
+            m_geneData.updateSpot(index, spotData.value, spotData.visible, spotData.color);
         }
-        m_geneData.updateQuadColor(index, indexColor);
     }
-    QGuiApplication::restoreOverrideCursor();
+    m_levelsData.setSpotsDirty(job->indexes);
     emit updated();
+
+    startUpdate();
+}
+
+void GeneRendererGL::finishUpdates()
+{
+    if (!m_updateJob && !m_pendingAll && m_pendingIndexes.isEmpty()) {
+        return;
+    }
+    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+    startUpdate();
+    while (m_updateJob) {
+        m_updateWatcher.waitForFinished();
+        slotUpdateFinished();
+    }
+    QGuiApplication::restoreOverrideCursor();
 }
 
 void GeneRendererGL::clearSelection()
 {
     m_geneData.clearSelectionArray();
-    m_geneInfoSelectedFeatures.clear();
+    m_levelsData.setAllDirty();
+    m_selectedFeatures.fill(false);
+    m_selectedFeaturesCount = 0;
     emit selectionUpdated();
     emit updated();
 }
 
 void GeneRendererGL::selectGenes(const DataProxy::GeneList &genes)
 {
-    // Well, we have some duplicated code here but the problem
-    // is that this function is invoked from the reg-exp selection tool.
+    // this function is invoked from the reg-exp selection tool.
     // We want to make the spots visible that contain genes present in the
     // search and we also want to select those spots
-    IndexesList unique_indexes;
-    for (const auto &gene : genes) {
-        unique_indexes.unite(IndexesList::fromList(m_geneInfoByGene.values(gene)));
-    }
-    // we update the rendering data
     updateVisual(genes);
     // we select the spots that contain the genes
-    selectSpots(unique_indexes, SelectionEvent::NewSelection);
+    selectSpots(genesIndexes(genes), SelectionEvent::NewSelection);
 }
 
 void GeneRendererGL::setSelectionArea(const SelectionEvent *event)
 {
-    // get selection area
-    const QuadTreeAABB aabb(event->path());
+    // get selection area (only the spots inside the shape are selected)
+    const QuadTreePolygon polygon(event->path());
 
     // get selection mode
     const SelectionEvent::SelectionMode mode = event->mode();
 
     // get selected points from selection shape
     GeneInfoQuadTree::PointItemList pointList;
-    m_geneInfoQuadTree.select(aabb, pointList);
+    m_geneInfoQuadTree.select(polygon, pointList);
 
     // create a list of indexes from the quadtree' points.
     IndexesList indexes;
+    indexes.reserve(pointList.size());
     for (const auto point : pointList) {
-        indexes.insert(point.second);
+        indexes.push_back(point.second);
+    }
+
+    // a click (an area smaller than a spot) selects the spot drawn under it
+    const QRectF area = event->path().boundingRect();
+    if (indexes.isEmpty() && !event->path().isEmpty() && area.width() < m_size
+        && area.height() < m_size) {
+        // only the visible spots can be selected
+        finishUpdates();
+        const int spot = visibleSpotAt(area.center());
+        if (spot != -1) {
+            indexes.push_back(spot);
+        }
     }
 
     // make the selection
     selectSpots(indexes, mode);
 }
 
-const DataProxy::FeatureList &GeneRendererGL::getSelectedFeatures() const
+FeatureStore GeneRendererGL::getSelectedFeatures() const
 {
-    return m_geneInfoSelectedFeatures;
+    if (m_selectedFeaturesCount == 0) {
+        return FeatureStore();
+    }
+    // the list of features is only created when it is requested
+    FeatureIndexes selected;
+    selected.reserve(m_selectedFeaturesCount);
+    for (int feature = 0; feature < m_selectedFeatures.size(); ++feature) {
+        if (m_selectedFeatures.testBit(feature)) {
+            selected.push_back(feature);
+        }
+    }
+    return m_features.subset(selected);
 }
 
 void GeneRendererGL::selectSpots(const IndexesList &indexes,
@@ -525,41 +729,49 @@ void GeneRendererGL::selectSpots(const IndexesList &indexes,
         return;
     }
 
+    // the selection depends on the visibility of the spots
+    finishUpdates();
+
     QGuiApplication::setOverrideCursor(Qt::WaitCursor);
     // if new selection clear the current selection
     if (mode == SelectionEvent::NewSelection) {
         // unselect previous selection
         m_geneData.clearSelectionArray();
-        m_geneInfoSelectedFeatures.clear();
+        m_levelsData.setAllDirty();
+        m_selectedFeatures.fill(false);
+        m_selectedFeaturesCount = 0;
     }
 
     // type of selection (add or remove)
     const bool remove_selection = (mode == SelectionEvent::ExcludeSelection);
 
+    // the features columns and the features of each spot
+    const QVector<int> &spotOffsets = m_features.spotOffsets();
+    const QVector<int> &spotFeatures = m_features.spotFeatures();
+    const QVector<quint32> &geneIds = m_features.geneIds();
+    const QVector<int> &counts = m_features.counts();
+
     // iterate the points to get the features of each point and make
     // the selection
     for (const auto &index : indexes) {
 
         // do not select non-visible spots or spots that are already selected in ADD mode
-        if (!m_geneData.quadVisible(index)
-            || (m_geneData.quadSelected(index) && !remove_selection)) {
+        if (!m_geneData.spotVisible(index)
+            || (m_geneData.spotSelected(index) && !remove_selection)) {
             continue;
         }
 
         // iterate all the features in the position to select when possible
         bool no_feature_selected = true;
-        auto features = m_geneInfoByIndex.values(index);
-        for (const auto feature : features) {
+        for (int i = spotOffsets.at(index); i < spotOffsets.at(index + 1); ++i) {
             // not filtering if the feature's gene is selected
             // as we want to include in the selection all the genes
             // of the feature regardless if they are selected or not
             // we just filter features outside the threshold
-            Q_ASSERT(feature);
+            const int feature = spotFeatures.at(i);
             // get the feature's gene
-            auto gene = m_dataProxy->geneGeneObject(feature->gene());
-            Q_ASSERT(gene);
-            const int geneCutOff = gene->cut_off();
-            const int currentHits = feature->count();
+            const int geneCutOff = m_geneStates.at(static_cast<int>(geneIds.at(feature))).cutoff;
+            const int currentHits = counts.at(feature);
             if (featureReadsOutsideRange(currentHits)
                 || (m_genes_cutoff && currentHits < geneCutOff)) {
                 continue;
@@ -568,17 +780,17 @@ void GeneRendererGL::selectSpots(const IndexesList &indexes,
             // this means that at least one feature was selected
             no_feature_selected = false;
 
-            // update the container with selected features
-            if (!remove_selection) {
-                m_geneInfoSelectedFeatures.push_back(feature);
-            } else {
-                m_geneInfoSelectedFeatures.removeOne(feature);
+            // update the bits of the selected features
+            if (m_selectedFeatures.testBit(feature) == remove_selection) {
+                m_selectedFeatures.setBit(feature, !remove_selection);
+                m_selectedFeaturesCount += remove_selection ? -1 : 1;
             }
         }
 
         // update gene data to selected or not selected (spot)
-        m_geneData.updateQuadSelected(index, !no_feature_selected && !remove_selection);
+        m_geneData.updateSpotSelected(index, !no_feature_selected && !remove_selection);
     }
+    m_levelsData.setSpotsDirty(indexes);
     QGuiApplication::restoreOverrideCursor();
     emit selectionUpdated();
     emit updated();
@@ -623,6 +835,14 @@ void GeneRendererGL::slotSetGenesCutOff(bool enable)
     }
 }
 
+void GeneRendererGL::slotSetGpuFiltering(bool enable)
+{
+    if (m_gpuFiltering != enable) {
+        m_gpuFiltering = enable;
+        emit updated();
+    }
+}
+
 void GeneRendererGL::draw(QOpenGLFunctionsVersion &qopengl_functions)
 {
     if (!m_isInitialized) {
@@ -640,12 +860,25 @@ void GeneRendererGL::draw(QOpenGLFunctionsVersion &qopengl_functions)
     int intensity = m_shader_program.uniformLocation("in_intensity");
     int shape = m_shader_program.uniformLocation("in_shape");
     int projMatrix = m_shader_program.uniformLocation("in_ModelViewProjectionMatrix");
-    int counts = m_shader_program.attributeLocation("countAttr");
-    int selected = m_shader_program.attributeLocation("selectedAttr");
-    int visible = m_shader_program.attributeLocation("visibleAttr");
-    int vertex = m_shader_program.attributeLocation("vertexAttr");
-    int color = m_shader_program.attributeLocation("colorAttr");
-    int texture = m_shader_program.attributeLocation("textureAttr");
+    int pointSize = m_shader_program.uniformLocation("in_pointSize");
+
+    // the spots are drawn as points whose size is given in pixels, a unit of
+    // the spots coordinates is mapped to the viewport to get it
+    GLint viewport[4];
+    qopengl_functions.glGetIntegerv(GL_VIEWPORT, viewport);
+    const QPointF origin = projectionModelViewMatrix.map(QPointF(0.0, 0.0));
+    const QPointF corner = projectionModelViewMatrix.map(QPointF(1.0, 1.0));
+    const float pixelsPerUnit = std::max(std::fabs(corner.x() - origin.x()) * viewport[2] / 2.0,
+                                         std::fabs(corner.y() - origin.y()) * viewport[3] / 2.0);
+    float pointSizePixels = pixelsPerUnit * m_size;
+
+    // when the array is zoomed out the spots are drawn aggregated in bins
+    // (the level depends on the zoom of the view)
+    const int level = m_levelsData.levelForScale(pixelsPerUnit);
+    GeneData &geneData = level == -1 ? m_geneData : m_levelsData.levelData(level, m_geneData);
+    if (level != -1) {
+        pointSizePixels *= m_levelsData.levelScale(level);
+    }
 
     // add UNIFORM values to shader program
     m_shader_program.setUniformValue(visualMode, static_cast<GLint>(m_visualMode));
@@ -656,40 +889,46 @@ void GeneRendererGL::draw(QOpenGLFunctionsVersion &qopengl_functions)
     m_shader_program.setUniformValue(intensity, static_cast<GLfloat>(m_intensity));
     m_shader_program.setUniformValue(shape, static_cast<GLint>(m_shape));
     m_shader_program.setUniformValue(projMatrix, projectionModelViewMatrix);
+    m_shader_program.setUniformValue(pointSize, static_cast<GLfloat>(pointSizePixels));
+
+    // the thresholds are applied in the vertex shader if it can read textures
+    // (the bins are drawn with the data computed in the CPU). The pooled
+    // modes need the min-max of all the visible spots so they are always
+    // computed in the CPU
+    const bool gpuFiltering = level == -1 && m_gpuFiltering && m_visualMode == NormalMode
+                              && m_filterData.isSupported(qopengl_functions);
+    m_shader_program.setUniformValue("in_gpuFiltering", static_cast<GLint>(gpuFiltering));
+    if (gpuFiltering) {
+        m_shader_program.setUniformValue("in_readsThreshold",
+                                         static_cast<GLfloat>(m_thresholdReadsLower),
+                                         static_cast<GLfloat>(m_thresholdReadsUpper));
+        m_shader_program.setUniformValue("in_genesThreshold",
+                                         static_cast<GLfloat>(m_thresholdGenesLower),
+                                         static_cast<GLfloat>(m_thresholdGenesUpper));
+        m_shader_program.setUniformValue("in_totalReadsThreshold",
+                                         static_cast<GLfloat>(m_thresholdTotalReadsLower),
+                                         static_cast<GLfloat>(m_thresholdTotalReadsUpper));
+        m_shader_program.setUniformValue("in_genesCutoff", static_cast<GLint>(m_genes_cutoff));
+        m_shader_program.setUniformValue("in_defaultColor", Visual::DEFAULT_COLOR_GENE);
+    }
 
-    // Add arrays to the shader program
-    m_shader_program.setAttributeArray(counts,
-                                       reinterpret_cast<const GLfloat*>(m_geneData.m_reads.constData()),
-                                       1);
-    m_shader_program.setAttributeArray(selected,
-                                       reinterpret_cast<const GLfloat*>(m_geneData.m_selected.constData()),
-                                       1);
-    m_shader_program.setAttributeArray(visible,
-                                       reinterpret_cast<const GLfloat*>(m_geneData.m_visible.constData()),
-                                       1);
-    m_shader_program.setAttributeArray(vertex,
-                                       m_geneData.m_vertices.constData());
-    m_shader_program.setAttributeArray(color,
-                                       m_geneData.m_colors.constData());
-    m_shader_program.setAttributeArray(texture, m_geneData.m_textures.constData());
-
-    m_shader_program.enableAttributeArray(vertex);
-    m_shader_program.enableAttributeArray(color);
-    m_shader_program.enableAttributeArray(texture);
-    m_shader_program.enableAttributeArray(counts);
-    m_shader_program.enableAttributeArray(selected);
-    m_shader_program.enableAttributeArray(visible);
-
-    qopengl_functions.glDrawElements(GL_TRIANGLES, m_geneData.m_indexes.size(),
-                                     GL_UNSIGNED_INT,
-                                     reinterpret_cast<const GLuint*>(m_geneData.m_indexes.constData()));
-
-    m_shader_program.disableAttributeArray(vertex);
-    m_shader_program.disableAttributeArray(color);
-    m_shader_program.disableAttributeArray(texture);
-    m_shader_program.disableAttributeArray(counts);
-    m_shader_program.disableAttributeArray(selected);
-    m_shader_program.disableAttributeArray(visible);
+    // the attribute arrays are stored in OpenGL buffers, only the data
+    // modified since the last draw is uploaded
+    // the size of the points is set in the vertex shader and the point
+    // sprites give the fragment shader the coordinates inside the point
+    qopengl_functions.glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+    qopengl_functions.glEnable(GL_POINT_SPRITE);
+    geneData.bindBuffers(m_shader_program);
+    if (gpuFiltering) {
+        m_filterData.bind(m_shader_program, qopengl_functions);
+    }
+    qopengl_functions.glDrawArrays(GL_POINTS, 0, geneData.spotsCount());
+    if (gpuFiltering) {
+        m_filterData.release(m_shader_program, qopengl_functions);
+    }
+    geneData.releaseBuffers(m_shader_program);
+    qopengl_functions.glDisable(GL_POINT_SPRITE);
+    qopengl_functions.glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
     m_shader_program.release();
 }
 
@@ -714,6 +953,67 @@ void GeneRendererGL::setupShaders()
     }
 }
 
+void GeneRendererGL::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!m_isInitialized) {
+        return;
+    }
+
+    const int spot = visibleSpotAt(event->localPos());
+    if (spot == m_hoveredSpot) {
+        return;
+    }
+    m_hoveredSpot = spot;
+    if (spot == -1) {
+        QToolTip::hideText();
+    } else {
+        QToolTip::showText(event->screenPos().toPoint(), spotToolTip(spot));
+    }
+}
+
+void GeneRendererGL::mouseLeaveEvent()
+{
+    if (m_hoveredSpot != -1) {
+        m_hoveredSpot = -1;
+        QToolTip::hideText();
+    }
+}
+
+int GeneRendererGL::visibleSpotAt(const QPointF &point) const
+{
+    // the nearest visible spot within the size of the spots drawn (the hidden
+    // spots are skipped so they do not hide a visible spot next to them)
+    return m_spotsIndex.nearest(point, m_size * 0.5f, [this](int spot) {
+        return m_geneData.spotVisible(spot);
+    });
+}
+
+QString GeneRendererGL::spotToolTip(const int spot) const
+{
+    // the features of the spot with the highest counts
+    const QVector<int> &spotOffsets = m_features.spotOffsets();
+    const QVector<int> &spotFeatures = m_features.spotFeatures();
+    const QVector<int> &counts = m_features.counts();
+    FeatureIndexes features(spotFeatures.mid(spotOffsets.at(spot),
+                                             spotOffsets.at(spot + 1) - spotOffsets.at(spot)));
+    const auto top = features.begin() + std::min(HOVER_TOP_GENES, features.size());
+    std::partial_sort(features.begin(), top, features.end(), [&counts](int f0, int f1) {
+        return counts.at(f0) > counts.at(f1);
+    });
+
+    QString text = tr("Spot (%1, %2)\nReads: %3 Genes: %4")
+                       .arg(m_features.spotsX().at(spot))
+                       .arg(m_features.spotsY().at(spot))
+                       .arg(m_geneInfoTotalReadsIndex.at(spot))
+                       .arg(m_geneInfoTotalGenesIndex.at(spot));
+    for (auto it = features.begin(); it != top; ++it) {
+        text += QString("\n%1: %2")
+                    .arg(m_features.geneName(m_features.geneIds().at(*it)))
+                    .arg(counts.at(*it));
+    }
+    return text;
+}
+
 void GeneRendererGL::setDimensions(const QRectF &border)
 {
     m_border = border;
@@ -738,13 +1038,3 @@ bool GeneRendererGL::featureReadsOutsideRange(const int value)
 {
     return (value < m_thresholdReadsLower || value > m_thresholdReadsUpper);
 }
-
-bool GeneRendererGL::featureGenesOutsideRange(const int value)
-{
-    return (value < m_thresholdGenesLower || value > m_thresholdGenesUpper);
-}
-
-bool GeneRendererGL::featureTotalReadsOutsideRange(const int value)
-{
-    return (value < m_thresholdTotalReadsLower || value > m_thresholdTotalReadsUpper);
-}
@@ -2,13 +2,19 @@
 #define GENERENDERERGL_H
 
 #include <QOpenGLVertexArrayObject>
+#include <QBitArray>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLBuffer>
+#include <QFutureWatcher>
 
 #include "math/QuadTree.h"
+#include "math/LatticeIndex.h"
 #include "SelectionEvent.h"
 #include "GeneData.h"
+#include "GeneFilterData.h"
+#include "GeneLevelsData.h"
 #include "data/DataProxy.h"
+#include "concurrent/DataRenderer.h"
 #include "SettingsVisual.h"
 
 #include <unordered_set>
@@ -51,32 +57,24 @@ public:
     // visualization data.
 
     // list of unique spot indexes
-    // Qt containers are faster than STL containers
-    typedef QSet<int> IndexesList;
-    // Spot index to list of features (gene-spot)
-    typedef QMultiHash<int, DataProxy::FeaturePtr> FeaturesByIndexMap;
-    // Gene object to list of features (accross all spots)
-    typedef QHash<DataProxy::GenePtr, std::vector<int> > FeaturesByGeneMap;
-    // gene object to list of spot indexes
-    typedef QMultiHash<DataProxy::GenePtr, int> IndexesByGeneMap;
+    typedef QVector<int> IndexesList;
     // spot index to total reads/genes
-    typedef QHash<int, int> IndexTotalCount;
+    typedef QVector<int> IndexTotalCount;
+    // list of features (indexes in the feature store)
+    typedef QVector<int> FeatureIndexes;
     // lookup quadtree type (spot indexes)
     typedef QuadTree<int, 8> GeneInfoQuadTree;
+    // the bound of a threshold
+    enum ThresholdBound { LowerBound, UpperBound };
 
     GeneRendererGL(QSharedPointer<DataProxy> dataProxy, QObject *parent = 0);
     virtual ~GeneRendererGL();
 
     // data builder (create visualization data from the ST data present in dataProxy)
+    // the genes cut-offs are the ones computed when the features were loaded
+    // (see FeatureStore::computeGeneCutoffs())
     void generateData();
 
-    // This function computes a individual counts cutoff for each gene.
-    // Spots whose gene's count is below the cut off will not be included.
-    // The computation is performed for each gene by looking at the distribution
-    // of reads and taking the point where the is a drastic change in the
-    // distribution
-    void compuateGenesCutoff();
-
     // clears data containers and reset variables to default
     void clearData();
 
@@ -87,7 +85,8 @@ public:
     void selectGenes(const DataProxy::GeneList &genes);
 
     // returns the currently selected features (counts on each selected spot)
-    const DataProxy::FeatureList &getSelectedFeatures() const;
+    // the features are in the order of the features store
+    FeatureStore getSelectedFeatures() const;
 
     // some getters for the thresholds
     int getMinReadsThreshold() const;
@@ -97,6 +96,17 @@ public:
     int getMinTotalReadsThreshold() const;
     int getMaxTotalReadsThreshold() const;
 
+    // the bound of a threshold changed from previous to limit, returns in
+    // [first, last) the elements of sortedIds (ids sorted by their value) whose
+    // value changes from inside to outside the threshold (or the other way around)
+    static void thresholdChangedRange(const QVector<int> &sortedIds,
+                                      const QVector<int> &values,
+                                      const int previous,
+                                      const int limit,
+                                      const ThresholdBound bound,
+                                      int &first,
+                                      int &last);
+
 public slots:
 
     // TODO slots should have the prefix "slot"
@@ -136,6 +146,11 @@ public slots:
     // to disable/enable the individual genes cut-off
     void slotSetGenesCutOff(bool enable);
 
+    // to enable/disable the thresholds in the vertex shader in the normal
+    // visual mode (if the OpenGL implementation does not support it they
+    // are applied in the CPU)
+    void slotSetGpuFiltering(bool enable);
+
     // clear all the selected features and send a signal to notify
     void clearSelection();
 
@@ -143,32 +158,70 @@ signals:
     // to notify the gene selections model that a selection has been made
     void selectionUpdated();
 
+private slots:
+    // the background computation of the rendering data has finished, the data
+    // is written to the rendering arrays (if it is stale its spots are
+    // computed again with the current settings)
+    void slotUpdateFinished();
+
 protected:
     // Make a selections based on an area (box)
     void setSelectionArea(const SelectionEvent *event) override;
     // override method that returns the drawing size of this element
     const QRectF boundingRect() const override;
     void draw(QOpenGLFunctionsVersion &qopengl_functions) override;
+    // shows the top genes of the spot under the mouse (hover inspector)
+    void mouseMoveEvent(QMouseEvent *event) override;
+    // hides the hover inspector
+    void mouseLeaveEvent() override;
 
 private:
 
-    // helper functions to test whether a feature is outside the threshold
-    // area or not by reads/genes or TPM
+    // helper function to test whether a feature is outside the reads threshold
     bool featureReadsOutsideRange(const int value);
-    bool featureGenesOutsideRange(const int value);
-    bool featureTotalReadsOutsideRange(const int value);
 
-    // will iterate all the features to change size
-    void updateSize();
     // will call updateVisual over all the unique genes present in all the
     // features
     void updateVisual();
     // will call updateVisual with the indexes that contain genes present in the
     // input
     void updateVisual(const DataProxy::GeneList &geneList);
+    // returns the indexes that contain the genes (each index once)
+    // the list is reused by every call so it is only valid until the next one
+    const IndexesList &genesIndexes(const DataProxy::GeneList &genes);
+    // adds the index to the reused list of indexes (if it is not present)
+    // and returns the list once all the indexes are added
+    void addUpdateIndex(const int index);
+    const IndexesList &finishUpdateIndexes();
+    // the threshold bound changed from previous to limit, the spots whose
+    // value (or the value of one of their features) is between both are
+    // updated. sortedIds are the ids (spots or features) sorted by value
+    void updateThreshold(const QVector<int> &sortedIds,
+                         const QVector<int> &values,
+                         const int previous,
+                         const int limit,
+                         const ThresholdBound bound,
+                         const bool features);
     // goes trough each index(spot) and computes its rendering values by
     // iterating over all its features. Thresholds are applied too.
+    // the spots are computed in the background (see DataRenderer), the
+    // requests made while a computation is running are collapsed into one
     void updateVisual(const IndexesList &indexes);
+    // copies the attributes of the genes to their rows of the genes states
+    void updateGeneStates(const DataProxy::GeneList &genes);
+    // adds the spots to the ones waiting to be computed
+    void addPendingIndexes(const IndexesList &indexes);
+    // starts the computation of the pending spots (if none is running)
+    void startUpdate();
+    // blocks until the pending spots are computed and written
+    void finishUpdates();
+    // returns the visible spot drawn under the point or -1 if there is none
+    int visibleSpotAt(const QPointF &point) const;
+    // the text of the hover inspector (totals and top genes of the spot)
+    QString spotToolTip(const int spot) const;
+    // computes the rendering data of the spots of the update (worker thread)
+    struct UpdateJob;
+    static void computeUpdate(UpdateJob *job);
     // iterates the spots given and selects them to update the list of selected
     // features (spot-gene)
     // only features that are inside threshold will be counted
@@ -184,23 +237,52 @@ private:
     void setupShaders();
 
     // lookup data (features respesent counts, a feature = (gene,spot) count
-    // index is the OpenGL index
-    // just the set of indexes for convenience
+    // index is the OpenGL index which is the spot id in the features store
+    // just the list of indexes for convenience
     IndexesList m_indexes;
-    // lookup data (index -> features)
-    FeaturesByIndexMap m_geneInfoByIndex;
-    // lookup data (gene -> indexes)
-    IndexesByGeneMap m_geneInfoByGene;
-    // look up data (gene -> counts)
-    FeaturesByGeneMap m_geneInfoByGeneFeatures;
-    // list of selected features
-    DataProxy::FeatureList m_geneInfoSelectedFeatures;
+    // the spots of each gene (CSR), the indexes of the spots of gene id are
+    // the elements [offsets[id], offsets[id + 1]) of the spots
+    QVector<int> m_geneSpotsOffsets;
+    QVector<int> m_geneSpots;
+    // the list of indexes to update and the indexes added to it
+    // (they are kept to not allocate them on every update)
+    IndexesList m_updateIndexes;
+    QBitArray m_updateIndexesAdded;
+    // the spots sorted by total reads/genes and the features sorted by count
+    // (only the ones between the old and new bound of a threshold are updated)
+    IndexesList m_spotsByTotalReads;
+    IndexesList m_spotsByTotalGenes;
+    FeatureIndexes m_featuresByCount;
+    // the spots waiting to be computed (all of them or the ones in the list)
+    bool m_pendingAll;
+    IndexesList m_pendingIndexes;
+    QBitArray m_pendingIndexesAdded;
+    // the update being computed in the background (the back buffer) and
+    // the generation of the last update request (to detect stale updates)
+    QSharedPointer<UpdateJob> m_updateJob;
+    QFutureWatcher<void> m_updateWatcher;
+    quint64 m_updateGeneration;
+    // the features (with look up indexes index -> features and gene id -> features)
+    FeatureStore m_features;
+    // lookup data (gene id -> gene)
+    DataProxy::GeneList m_genes;
+    // the state of the genes used to render (gene id -> state), the rows are
+    // updated when the genes are modified (see updateGeneStates())
+    QVector<DataRenderer::GeneState> m_geneStates;
+    // the selected features (one bit per feature, the selected spots are
+    // flagged in the rendering data) and the number of them
+    QBitArray m_selectedFeatures;
+    int m_selectedFeaturesCount;
     // gene look up (index -> total reads)
     IndexTotalCount m_geneInfoTotalReadsIndex;
     // gene look up (index -> total genes)
     IndexTotalCount m_geneInfoTotalGenesIndex;
-    // quad tree container (used to find by coordinates)
+    // quad tree container (used to find by area)
     GeneInfoQuadTree m_geneInfoQuadTree;
+    // lattice of the spots (used to find the spot nearest to a point)
+    LatticeIndex m_spotsIndex;
+    // the spot shown by the hover inspector (-1 if none)
+    int m_hoveredSpot;
 
     // visual attributes
     float m_intensity;
@@ -218,6 +300,9 @@ private:
     // enable/disable genes cutoff
     bool m_genes_cutoff;
 
+    // enable/disable the thresholds and pooling in the vertex shader
+    bool m_gpuFiltering;
+
     // local pooled min-max for rendering (Adjusted according to what is being
     // rendered)
     int m_localPooledMin;
@@ -243,6 +328,8 @@ private:
 
     // OpenGL rendering variables
     GeneData m_geneData;
+    GeneFilterData m_filterData;
+    GeneLevelsData m_levelsData;
     QOpenGLShaderProgram m_shader_program;
 
     Q_DISABLE_COPY(GeneRendererGL)
@@ -167,6 +167,10 @@ void GraphicItemGL::mouseReleaseEvent(QMouseEvent *event)
     Q_UNUSED(event);
 }
 
+void GraphicItemGL::mouseLeaveEvent()
+{
+}
+
 // TODO perhaps the QOpenGLFunctions_2_0 should be a member variable
 void GraphicItemGL::drawBorderRect(const QRectF &rect,
                                    const QColor &color,
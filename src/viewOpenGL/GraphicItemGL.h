@@ -78,6 +78,8 @@ public:
     virtual void mouseMoveEvent(QMouseEvent *event);
     virtual void mousePressEvent(QMouseEvent *event);
     virtual void mouseReleaseEvent(QMouseEvent *event);
+    // the mouse has moved out of the node (or out of the view)
+    virtual void mouseLeaveEvent();
 
     // drawing functions
     // we pass the QOpenGLFunctions_2_0 functions
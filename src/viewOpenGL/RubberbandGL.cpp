@@ -30,9 +30,29 @@ void RubberbandGL::setRubberbandRect(const QRectF &rect)
     }
 }
 
+void RubberbandGL::setRubberbandPath(const QPolygonF &path)
+{
+    m_rubberbandPath = path;
+}
+
 void RubberbandGL::draw(QOpenGLFunctionsVersion &qopengl_functions)
 {
-    if (!m_rubberbandRect.isNull() && m_rubberbandRect.isValid()) {
+    if (m_rubberbandPath.size() > 1) {
+        const QColor color(Qt::blue);
+        qopengl_functions.glBegin(GL_LINE_LOOP);
+        {
+            qopengl_functions.glColor4f(static_cast<GLfloat>(color.redF()),
+                                        static_cast<GLfloat>(color.greenF()),
+                                        static_cast<GLfloat>(color.blueF()),
+                                        0.8f);
+            for (const QPointF &point : m_rubberbandPath) {
+                qopengl_functions.glVertex2f(point.x(), point.y());
+            }
+        }
+        qopengl_functions.glEnd();
+        // set the color back to white to not over-draw the textures
+        qopengl_functions.glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+    } else if (!m_rubberbandRect.isNull() && m_rubberbandRect.isValid()) {
         drawBorderRect(m_rubberbandRect, Qt::blue, qopengl_functions);
     }
 }
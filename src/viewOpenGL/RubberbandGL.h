@@ -3,6 +3,8 @@
 
 #include "GraphicItemGL.h"
 
+#include <QPolygonF>
+
 class QGLPainter;
 class QImage;
 class QVector2DArray;
@@ -22,6 +24,8 @@ public:
     virtual ~RubberbandGL();
 
     void setRubberbandRect(const QRectF &rect);
+    // the lasso (drawn if it has at least two vertices)
+    void setRubberbandPath(const QPolygonF &path);
     void draw(QOpenGLFunctionsVersion &qopengl_functions) override;
 
 protected:
@@ -31,6 +35,7 @@ protected:
 private:
 
     QRectF m_rubberbandRect;
+    QPolygonF m_rubberbandPath;
 
     Q_DISABLE_COPY(RubberbandGL)
 };
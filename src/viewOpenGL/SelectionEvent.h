@@ -2,11 +2,12 @@
 #define SELECTIONEVENT_H
 
 #include <QEvent>
-#include <QPainterPath>
+#include <QPolygonF>
 
 // Selection event used to propagate selection data to view items.
+// The selected area is a polygon (a rectangle for the rubberband selections
+// and any closed shape for the lasso selections)
 // TODO move definition to CPP
-// TODO extend to allow other type of selections
 class SelectionEvent : public QEvent
 {
 
@@ -27,7 +28,14 @@ public:
     {
     }
 
-    QRectF path() const { return m_path; }
+    SelectionEvent(const QPolygonF &polygon, const SelectionMode mode = NewSelection)
+        : QEvent(TYPE)
+        , m_path(polygon)
+        , m_mode(mode)
+    {
+    }
+
+    const QPolygonF &path() const { return m_path; }
     SelectionMode mode() const { return m_mode; }
 
     static SelectionMode modeFromKeyboardModifiers(Qt::KeyboardModifiers modifiers)
@@ -41,7 +49,7 @@ public:
 private:
     static const QEvent::Type TYPE = static_cast<QEvent::Type>(QEvent::User + 42);
 
-    const QRectF m_path;
+    const QPolygonF m_path;
     const SelectionMode m_mode;
 };
 
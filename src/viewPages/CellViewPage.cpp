@@ -383,6 +383,8 @@ void CellViewPage::createMenusAndConnections()
 
     // Individual gene cut-off
     menu_genePlotter->addAction(m_ui->actionIndividual_gene_cut_off);
+    // thresholds applied in the GPU
+    menu_genePlotter->addAction(m_ui->actionGPU_filtering);
     menu_genePlotter->addSeparator();
 
     // transcripts intensity and size sliders
@@ -578,6 +580,12 @@ void CellViewPage::createMenusAndConnections()
             m_gene_plotter.data(),
             SLOT(slotSetGenesCutOff(bool)));
 
+    // enable/disable the thresholds in the GPU
+    connect(m_ui->actionGPU_filtering,
+            SIGNAL(triggered(bool)),
+            m_gene_plotter.data(),
+            SLOT(slotSetGpuFiltering(bool)));
+
     // visual mode signal
     connect(actionGroup_toggleVisualMode,
             SIGNAL(triggered(QAction *)),
@@ -647,6 +655,9 @@ void CellViewPage::resetActionStates()
     // reset genes cut off
     m_ui->actionIndividual_gene_cut_off->setChecked(true);
 
+    // reset GPU filtering
+    m_ui->actionGPU_filtering->setChecked(false);
+
     // gene controls
     m_geneIntensitySlider->setValue(GENE_INTENSITY_MAX);
     m_geneSizeSlider->setValue(GENE_SIZE_MIN);
@@ -810,8 +821,8 @@ void CellViewPage::slotCreateSelection()
     const auto dataset = m_dataProxy->getDatasetById(m_openedDatasetId);
     Q_ASSERT(dataset);
     // get selected features and create the selection object
-    const auto &selectedFeatures = m_gene_plotter->getSelectedFeatures();
-    if (selectedFeatures.empty()) {
+    const FeatureStore selectedFeatures = m_gene_plotter->getSelectedFeatures();
+    if (selectedFeatures.isEmpty()) {
         // the user has probably clear the selections
         return;
     }
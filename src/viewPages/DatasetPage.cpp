@@ -6,6 +6,9 @@
 #include <QMessageBox>
 #include <QUuid>
 #include <QDateTime>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QGuiApplication>
 
 #include "QtWaitingSpinner/waitingspinnerwidget.h"
 
@@ -13,6 +16,7 @@
 #include "model/DatasetItemModel.h"
 #include "dialogs/EditDatasetDialog.h"
 #include "data/DatasetImporter.h"
+#include "data/BinaryDataset.h"
 #include "dataModel/Dataset.h"
 #include "dataModel/Chip.h"
 #include "dataModel/ImageAlignment.h"
@@ -203,6 +207,9 @@ void DatasetPage::slotOpenDataset()
     }
     const auto dataset = currentDatasets.front();
 
+    // opening a dataset cancels the features still being loaded
+    m_dataProxy->cancelFeaturesLoading();
+
     m_waiting_spinner->start();
     if (dataset->downloaded()) {
         if (m_dataProxy->loadDatasetContent(dataset)) {
@@ -217,9 +224,18 @@ void DatasetPage::slotOpenDataset()
         Q_ASSERT(importer);
         bool parsedOk = true;
 
+        // features stored in binary format are mapped from the file, the
+        // chip and the alignment are stored in the file as well
+        BinaryDataset binaryDataset;
+        const bool isBinary = BinaryDataset::isBinaryFile(importer->featuresFileName());
+        if (isBinary) {
+            parsedOk &= binaryDataset.open(importer->featuresFileName());
+        }
+
         // Create a chip with the dimensions given
         Chip chip;
-        const QRect chip_rect = importer->chipDimensions();
+        const QRect chip_rect
+            = isBinary ? binaryDataset.chipDimensions() : importer->chipDimensions();
         const int x1 = chip_rect.topLeft().x();
         const int y1 = chip_rect.topLeft().y();
         const int x2 = chip_rect.bottomRight().x();
@@ -241,9 +257,13 @@ void DatasetPage::slotOpenDataset()
         m_dataProxy->loadChip(chip);
 
         // add the features
-        const QByteArray &featuresFile = importer->featuresFile();
-        Q_ASSERT(!featuresFile.isNull() && !featuresFile.isEmpty());
-        parsedOk &= m_dataProxy->loadFeatures(featuresFile);
+        if (isBinary) {
+            parsedOk &= m_dataProxy->loadFeatures(binaryDataset);
+        } else {
+            const QByteArray &featuresFile = importer->featuresFile();
+            Q_ASSERT(!featuresFile.isNull() && !featuresFile.isEmpty());
+            parsedOk &= m_dataProxy->loadFeatures(featuresFile);
+        }
 
         // creates an image alignment with the previous chip and the images
         ImageAlignment alignment;
@@ -254,7 +274,8 @@ void DatasetPage::slotOpenDataset()
         const QString secondImageName = QUuid::createUuid().toString();
         alignment.figureBlue(mainImageName);
         alignment.figureRed(secondImageName);
-        alignment.alignment(importer->alignmentMatrix());
+        alignment.alignment(isBinary ? binaryDataset.alignmentMatrix()
+                                     : importer->alignmentMatrix());
         m_dataProxy->loadImageAlignment(alignment);
 
         // add the images
@@ -323,6 +344,10 @@ void DatasetPage::slotImportDataset()
         dataset.statComments(importer->comments());
         dataset.statSpecies(importer->species());
         dataset.statTissue(importer->tissue());
+        // offer to convert JSON features to binary format (faster to open)
+        if (!BinaryDataset::isBinaryFile(importer->featuresFileName())) {
+            convertFeaturesFile(importer);
+        }
         // store locally the imported dataset
         m_importedDatasets.insert(dataset.id(), importer);
         // add the dataset to dataProxy and update the model
@@ -331,6 +356,44 @@ void DatasetPage::slotImportDataset()
     }
 }
 
+void DatasetPage::convertFeaturesFile(QPointer<DatasetImporter> importer)
+{
+    const int answer
+        = QMessageBox::question(this,
+                                tr("Import dataset"),
+                                tr("Do you want to store the features in binary format?\n"
+                                   "Binary datasets are much faster to open."),
+                                QMessageBox::Yes | QMessageBox::No,
+                                QMessageBox::No);
+    if (answer != QMessageBox::Yes) {
+        return;
+    }
+
+    const QFileInfo info(importer->featuresFileName());
+    const QString filename
+        = QFileDialog::getSaveFileName(this,
+                                       tr("Save Binary Features File"),
+                                       info.absolutePath() + "/" + info.completeBaseName()
+                                           + ".stb",
+                                       QString("%1").arg(tr("ST Binary Files (*.stb)")));
+    // early out
+    if (filename.isEmpty()) {
+        return;
+    }
+
+    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+    const bool convertedOk = BinaryDataset::convert(importer->featuresFile(),
+                                                    filename,
+                                                    importer->chipDimensions(),
+                                                    importer->alignmentMatrix());
+    QGuiApplication::restoreOverrideCursor();
+    if (convertedOk) {
+        importer->featuresFileName(filename);
+    } else {
+        QMessageBox::critical(this, tr("Import dataset"), tr("Error converting the features"));
+    }
+}
+
 void DatasetPage::slotDatasetsUpdated()
 {
     // update model
@@ -73,6 +73,10 @@ private:
     // clear focus and resets to default all buttons status
     void clearControls();
 
+    // asks the user to convert the JSON features of an imported dataset
+    // to binary format, the importer will use the binary file if converted
+    void convertFeaturesFile(QPointer<DatasetImporter> importer);
+
     // to get the data model from the table
     QSortFilterProxyModel *datasetsProxyModel();
     DatasetItemModel *datasetsModel();